@@ -43,7 +43,7 @@
 
 #define configUSE_PREEMPTION              1
 #define configUSE_IDLE_HOOK               0
-#define configUSE_TICK_HOOK               0
+#define configUSE_TICK_HOOK               1
 /* Timers' clock frequency is 1 MHz: */
 #define configCPU_CLOCK_HZ                ( ( UBaseType_t) 1000000 )
 #define configTICK_RATE_HZ                ( ( TickType_t ) 1000 )
@@ -51,12 +51,96 @@
 #define configMINIMAL_STACK_SIZE          ( ( StackType_t ) 128 )
 #define configTOTAL_HEAP_SIZE             ( ( size_t ) ( 20480 ) )
 #define configMAX_TASK_NAME_LEN           ( 16 )
-#define configUSE_TRACE_FACILITY          0
+#define configUSE_TRACE_FACILITY          1
 #define configUSE_16_BIT_TICKS            0
 #define configIDLE_SHOULD_YIELD           1
 #define configUSE_APPLICATION_TASK_TAG    1
 
-#define configUSE_MUTEXES                 0
+/*
+ * All kernel objects are allocated statically (see Demo/objects.h),
+ * memory of the idle task is supplied by the port (see port.c)
+ */
+#define configSUPPORT_STATIC_ALLOCATION   1
+#define configSUPPORT_DYNAMIC_ALLOCATION  0
+
+/*
+ * Mutexes with priority inheritance, e.g. to protect resources shared by
+ * tasks of different priorities (see also Demo/bench_mutex.c)
+ */
+#define configUSE_MUTEXES                 1
+#define configUSE_RECURSIVE_MUTEXES       1
+
+/*
+ * Set to 1 to measure durations of sections with disabled interrupts
+ * and with the suspended scheduler (see critical_stats.h)
+ */
+#define configUSE_CRITICAL_STATS          0
+
+/*
+ * Set to 1 to measure execution and response times of registered tasks
+ * (see task_stats.h). Requires configUSE_APPLICATION_TASK_TAG.
+ */
+#define configUSE_TASK_STATS              1
+
+/*
+ * Set to 1 to measure stack usage of operating modes (see stack_stats.h).
+ * Together with configUSE_TRACE_FACILITY, the diagnostic command "stacks"
+ * reports high water marks of all tasks and mode stacks.
+ */
+#define configUSE_STACK_STATS             1
+
+/* Set to 1 to enable hardware backed timers and vTaskDelayUs() (see hrtimer.h) */
+#define configUSE_HR_TIMER                1
+#define configHR_TIMER_TASK_PRIORITY      ( configMAX_PRIORITIES - 1 )
+
+/*
+ * Set to 1 to enable event flags, set by ISRs in bounded time
+ * without the timer daemon task (see event_flags.h)
+ */
+#define configUSE_EVENT_FLAGS             1
+
+/*
+ * Set to 1 to enable synchronous send/receive/reply IPC channels
+ * with priority donation to the server (see ipc_channel.h)
+ */
+#define configUSE_IPC_CHANNELS            1
+
+/*
+ * Set to 1 to enable sequence locks for data, shared with ISRs,
+ * that readers access without disabling IRQs (see seqlock.h)
+ */
+#define configUSE_SEQLOCKS                1
+
+/*
+ * Direct notifications of each task: the first one is left to the application,
+ * the second one is reserved for event flags, the third one for IPC channels
+ * and the last one for vTaskDelayUs()
+ */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES    4
+#define portEVENT_FLAGS_NOTIFY_INDEX             1
+#define portIPC_NOTIFY_INDEX                     2
+
+/*
+ * Set to 1 to keep delayed tasks and active software timers in
+ * hierarchical timing wheels instead of sorted lists (see timing_wheel.h)
+ */
+#define configUSE_TIMING_WHEEL            0
+
+/*
+ * Set to 1 to schedule the ready tasks of configEDF_PRIORITY by
+ * their absolute deadlines (see vTaskSetDeadline() in task.h)
+ */
+#define configUSE_EDF_SCHEDULER           0
+#define configEDF_PRIORITY                ( 3 )
+
+/* Set to 1 to enable preemption thresholds (see vTaskSetPreemptionThreshold() in task.h) */
+#define configUSE_PREEMPTION_THRESHOLD    1
+
+/* Set to 1 to enable processor time budgets of tasks (see vTaskSetBudget() in task.h) */
+#define configUSE_TASK_BUDGET             1
+
+/* Set to 1 to enable time slices of different lengths (see vTaskSetTimeSlice() in task.h) */
+#define configUSE_TASK_TIME_SLICES        0
 
 /* Co-routine definitions. */
 #define configUSE_CO_ROUTINES             0
@@ -72,6 +156,9 @@ to exclude the API function. */
 #define INCLUDE_vTaskSuspend                  1
 #define INCLUDE_vTaskDelayUntil               1
 #define INCLUDE_vTaskDelay                    1
+#define INCLUDE_uxTaskGetStackHighWaterMark   1
+/* Required by vTaskDelayUs() (see hrtimer.h) and stream buffers (uart_rx.c) */
+#define INCLUDE_xTaskGetCurrentTaskHandle     1
 
 /* This is the raw value as per the Cortex-M3 NVIC.  Values can be 255
 (lowest) to 0 (1?) (highest). */
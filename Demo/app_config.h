@@ -52,21 +52,64 @@
 #define PRIOR_FIX_FREQ_PERIODIC          ( 3 )
 #define PRIOR_PRINT_GATEKEEPR            ( 1 )
 #define PRIOR_RECEIVER                   ( 1 )
+#define PRIOR_IRQ_GUARD                  ( 2 )
+
+/*
+ * Preemption threshold of the print gate keeper (requires
+ * configUSE_PREEMPTION_THRESHOLD). While it prints a message, tasks
+ * of priorities up to this value cannot preempt it.
+ */
+#define PRIOR_PRINT_GATEKEEPR_THRESHOLD  ( PRIOR_PERIODIC )
+
+/*
+ * Priority of the receiver task when it has exhausted its budget
+ * (requires configUSE_TASK_BUDGET, see RECV_BUDGET)
+ */
+#define PRIOR_RECEIVER_BACKGROUND        ( 0 )
 
 
 /* Settings for print.c */
 
-/* Size of the queue with pointers to strings that will be printed */
-#define PRINT_QUEUE_SIZE                 ( 10 )
+/*
+ * Sizes of queues with pointers to strings that will be printed,
+ * one queue per class of messages (see print.h)
+ */
+#define PRINT_QUEUE_SIZE_URGENT          ( 4 )
+#define PRINT_QUEUE_SIZE_NORMAL          ( 10 )
+#define PRINT_QUEUE_SIZE_BACKGROUND      ( 4 )
 
-/* Number of string buffers to print individual characters */
-#define PRINT_CHR_BUF_SIZE               ( 5 )
+/*
+ * What happens to a message when the queue of its class is full
+ * (see printPolicy in print.h)
+ */
+#define PRINT_POLICY_URGENT              ( PRINT_POLICY_BLOCK )
+#define PRINT_POLICY_NORMAL              ( PRINT_POLICY_DROP )
+#define PRINT_POLICY_BACKGROUND          ( PRINT_POLICY_OVERWRITE )
+
+/* Maximum number of ticks to wait for space in a queue with PRINT_POLICY_BLOCK */
+#define PRINT_BLOCK_TICKS                ( 10 )
+
+/*
+ * Number of slots for formatted messages and individual characters (at most 32)
+ * and the binary logarithm of a slot's length, including the terminating '\0'
+ */
+#define PRINT_SLOTS                      ( 8 )
+#define PRINT_SLOT_SHIFT                 ( 6 )
 
 
 /* Settings for receive.c */
 
-/* Size of the queue holding received characters, that have not been processed yet. */
-#define RECV_QUEUE_SIZE                  ( 10 )
+/* Size of the stream buffer holding received characters, that have not been processed yet. */
+#define RECV_STREAM_SIZE                 ( 64 )
+
+/*
+ * Number of received characters that wake up the receiver task
+ * (see uart_rx.c). It is also woken up when Enter is pressed.
+ */
+#define RECV_TRIGGER_LEVEL               ( 16 )
+
+/* Priority of the UART's IRQ */
+#define RECV_IRQ_PRIORITY                ( 50 )
 
 /* Number of string buffers necessary to print received strings */
 #define RECV_BUFFER_SIZE                 ( 3 )
@@ -78,4 +121,113 @@
  */
 #define RECV_BUFFER_LEN                  ( 50 )
 
+/*
+ * Maximum number of receive interrupts per tick. When exceeded, the UART's
+ * IRQ is disabled and received characters are polled (see irqguard.c)
+ * until the rate drops. PIC_NO_BUDGET disables this protection.
+ */
+#define RECV_IRQ_BUDGET                  ( 8 )
+
+/*
+ * The receiver task may run for RECV_BUDGET ticks (at PRIOR_RECEIVER)
+ * within each period of RECV_BUDGET_PERIOD ticks (requires configUSE_TASK_BUDGET).
+ */
+#define RECV_BUDGET                      ( 20 )
+#define RECV_BUDGET_PERIOD               ( 100 )
+
+
+/*
+ * Timer and its counter that are used as a free running counter
+ * (and the time base, see timebase.h) by benchmarks and diagnostics.
+ * It must be equal to portFREE_RUNNING_TIMER and portFREE_RUNNING_COUNTER
+ * in tick_timer_settings.h as the time base is shared with the kernel.
+ */
+#define APP_FREE_RUNNING_TIMER           ( 0 )
+#define APP_FREE_RUNNING_COUNTER         ( 1 )
+
+/*
+ * Timer and its counter that generate ticks. Must be equal to
+ * portTICK_TIMER and portTICK_TIMER_COUNTER in tick_timer_settings.h.
+ * The counter is only read to obtain the tick's phase (see periodic.c).
+ */
+#define APP_TICK_TIMER                   ( 0 )
+#define APP_TICK_COUNTER                 ( 0 )
+
+
+/* Settings for periodic.c */
+
+/* Number of bins of histograms of release latencies */
+#define PERIODIC_HIST_BINS               ( 16 )
+
+/* Each bin is 2^PERIODIC_BIN_SHIFT us wide, the last bin also counts all longer latencies */
+#define PERIODIC_BIN_SHIFT               ( 4 )
+
+
+/* Settings for pbuf.c */
+
+/* Number of packet buffers in the pool */
+#define PBUF_POOL_SIZE                   ( 16 )
+
+/* Capacity of a packet buffer in bytes, including space reserved for headers */
+#define PBUF_SIZE                        ( 64 )
+
+
+/* Settings for diag.c */
+
+/*
+ * Commands "irq" and "irq probe" are only available if PIC_IRQ_STATS
+ * (see interrupt.h) is enabled in the Makefile.
+ */
+
+/* Priority of the software generated interrupt, used to probe IRQ entry latency */
+#define DIAG_PROBE_IRQ_PRIORITY          ( 20 )
+
+/* Number of software generated interrupts, triggered by a probe */
+#define DIAG_PROBE_COUNT                 ( 100 )
+
+
+/* Settings for benchmarks (bench_*.c) */
+
+/*
+ * Set to a nonzero value to run the critical section benchmark
+ * as soon as the scheduler starts.
+ */
+#define APP_BENCH_CRITICAL               ( 0 )
+
+/*
+ * Set to a nonzero value to compare the EDF scheduler against rate monotonic
+ * priorities as soon as the scheduler starts. Requires configUSE_EDF_SCHEDULER
+ * and configUSE_TASK_STATS.
+ */
+#define APP_BENCH_EDF                    ( 0 )
+
+/* Duration of each run of the EDF benchmark in ticks */
+#define BENCH_EDF_DURATION               ( 1000 )
+
+/* The task set is scaled by k/32 for each k between this value and 32 */
+#define BENCH_EDF_SCALE_MIN              ( 22 )
+
+/*
+ * Set to a nonzero value to compare request/response round trips over
+ * a pair of queues and over an IPC channel as soon as the scheduler starts.
+ * Requires configUSE_IPC_CHANNELS.
+ */
+#define APP_BENCH_IPC                    ( 0 )
+
+/* Length of requests and replies of the IPC benchmark in bytes */
+#define BENCH_IPC_MSG_LEN                ( 16 )
+
+/*
+ * Set to a nonzero value to measure the cost of mutexes and the blocking
+ * of a high priority task in a priority inversion scenario, with and
+ * without priority inheritance, as soon as the scheduler starts.
+ * Requires configUSE_MUTEXES and configUSE_RECURSIVE_MUTEXES.
+ */
+#define APP_BENCH_MUTEX                  ( 0 )
+
+/* Execution times (in us) of the lock holder and the medium priority task */
+#define BENCH_MUTEX_HOLD_US              ( 3000 )
+#define BENCH_MUTEX_MEDIUM_US            ( 5000 )
+
+
 #endif  /* _APP_CONFIG_H_ */
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Helpers, shared by all benchmarks:
+ * - direct access to the free running counter of the time base,
+ * - busy loops that emulate a given execution time,
+ * - repeated measurements, of which the shortest one is reported.
+ *
+ * Measurements are performed by a function that executes the measured
+ * operation (typically BENCH_ITERATIONS times). The counter ticks once
+ * per microsecond, so with 1000 iterations the total number of ticks
+ * equals the number of nanoseconds per operation.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+
+#include "app_config.h"
+#include "timer.h"
+#include "timebase.h"
+
+#include "bench.h"
+
+
+#if BENCH_HELPERS != 0
+
+/* Number of empty iterations between two checks of the counter during the calibration */
+#define BENCH_BLOCK             ( 64 )
+
+/* The calibration measures the number of blocks per 2^BENCH_CAL_SHIFT microseconds */
+#define BENCH_CAL_SHIFT         ( 10 )
+
+
+/* Address of the counter's Value Register */
+static const volatile uint32_t* pBenchCounter = NULL;
+
+/* Number of busy loop blocks per 2^BENCH_CAL_SHIFT microseconds */
+static uint32_t blocksPerCal = 0;
+
+
+/*
+ * Executes 'blocks' blocks of empty iterations.
+ */
+static void benchBurn(uint32_t blocks)
+{
+    uint32_t i;
+    uint32_t j;
+
+    for ( i=0; i<blocks; ++i )
+    {
+        for ( j=0; j<BENCH_BLOCK; ++j )
+        {
+            __asm volatile ( "" : : : "memory" );
+        }
+    }
+}
+
+
+/*
+ * Measures the number of blocks that are executed
+ * in 2^BENCH_CAL_SHIFT microseconds.
+ */
+static uint32_t benchCalibrate(void)
+{
+    uint32_t start;
+    uint32_t blocks = 0;
+
+    start = timebase_getCounter();
+    while ( ( timebase_getCounter() - start ) < ( 1UL << BENCH_CAL_SHIFT ) )
+    {
+        benchBurn(1);
+        ++blocks;
+    }
+
+    return blocks;
+}
+
+
+/**
+ * Starts the free running counter (unless already started) and
+ * calibrates busy loops. It must be called by each benchmark before
+ * any other helper.
+ *
+ * @return pdPASS if initialization is successful, pdFAIL otherwise
+ */
+int16_t benchInit(void)
+{
+    if ( timebase_init(APP_FREE_RUNNING_TIMER, APP_FREE_RUNNING_COUNTER) < 0 )
+    {
+        return pdFAIL;
+    }
+
+    /*
+     * The free running counter is shared with the time base, its Value Register
+     * is read directly to keep the measurement overhead minimal.
+     */
+    pBenchCounter = timer_getValueAddr(APP_FREE_RUNNING_TIMER, APP_FREE_RUNNING_COUNTER);
+    blocksPerCal = benchCalibrate();
+
+    return pdPASS;
+}
+
+
+/**
+ * Executes busy loops for approximately 'us' microseconds of processor time.
+ *
+ * @param us - execution time in microseconds
+ */
+void benchExecute(uint32_t us)
+{
+    benchBurn( ( us * blocksPerCal ) >> BENCH_CAL_SHIFT );
+}
+
+
+/**
+ * Repeats a measurement 'rounds' times and returns the shortest time
+ * without the overhead, e.g. of an empty loop (but at least 0).
+ *
+ * @param measure - function that executes the measured operation
+ * @param op - operation, passed to 'measure'
+ * @param arg - argument, passed to 'measure'
+ * @param rounds - number of measurements
+ * @param overhead - number of counter ticks to be subtracted
+ *
+ * @return the shortest time in counter ticks (microseconds)
+ */
+uint32_t benchBestOf(benchMeasure measure, uint32_t op, void* arg, uint8_t rounds, uint32_t overhead)
+{
+    uint8_t round;
+    uint32_t best = (uint32_t) -1;
+    uint32_t start;
+    uint32_t t;
+
+    for ( round=0; round<rounds; ++round )
+    {
+        /* The counter counts down, hence 'start - end' */
+        start = *pBenchCounter;
+        measure(op, arg);
+        t = start - *pBenchCounter;
+
+        if ( t < best )
+        {
+            best = t;
+        }
+    }
+
+    /* Subtract the overhead (but prevent underflows) */
+    return best - ( best > overhead ? overhead : best );
+}
+
+#endif  /* BENCH_HELPERS != 0 */
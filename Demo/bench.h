@@ -0,0 +1,73 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file
+ * Declaration of tasks that perform optional benchmarks and of helpers,
+ * shared by them. Each benchmark is enabled by its own setting in "app_config.h".
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+
+#include "app_config.h"
+
+
+/* Helpers (see bench.c) are only built when any benchmark is enabled */
+#define BENCH_HELPERS           ( APP_BENCH_CRITICAL != 0 || APP_BENCH_EDF != 0 || \
+                                  APP_BENCH_IPC != 0 || APP_BENCH_MUTEX != 0 )
+
+#if BENCH_HELPERS != 0
+/* Executes the operation 'op' that is measured by benchBestOf() */
+typedef void (*benchMeasure)(uint32_t op, void* arg);
+
+int16_t benchInit(void);
+
+void benchExecute(uint32_t us);
+
+uint32_t benchBestOf(benchMeasure measure, uint32_t op, void* arg, uint8_t rounds, uint32_t overhead);
+#endif
+
+
+#if APP_BENCH_CRITICAL != 0
+void benchCriticalTask(void* params);
+#endif
+
+#if APP_BENCH_EDF != 0
+void benchEdfTask(void* params);
+#endif
+
+#if APP_BENCH_IPC != 0
+void benchIpcTask(void* params);
+#endif
+
+#if APP_BENCH_MUTEX != 0
+void benchMutexTask(void* params);
+#endif
+
+
+#endif  /* _BENCH_H_ */
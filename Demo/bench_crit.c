@@ -0,0 +1,231 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file
+ * A benchmark that measures the time spent with interrupts disabled
+ * by critical sections of the kernel.
+ *
+ * The inlined portENTER_CRITICAL()/portEXIT_CRITICAL() pair is compared
+ * against the former implementation (out-of-line functions that push and pop
+ * R0 around the CPSR modification), which is reproduced below for reference.
+ * Additionally a typical kernel call (a queue send, followed by a receive) is
+ * timed, each of them executes one critical section.
+ *
+ * The benchmark is performed by a task with the highest priority that
+ * prints its results directly to the UART and deletes itself.
+ *
+ * All times are measured by a free running counter of a timer. As each
+ * measurement is repeated BENCH_ITERATIONS (1000) times, the total number
+ * of counter's ticks (microseconds) also equals the number of nanoseconds
+ * per operation. Each measurement is repeated several times and the
+ * shortest one is reported, so occasional tick interrupts do not distort
+ * the results.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+#include "app_config.h"
+
+#include "print.h"
+#include "bench.h"
+#include "objects.h"
+
+
+#if APP_BENCH_CRITICAL != 0
+
+/* Number of repetitions of each measured operation */
+#define BENCH_ITERATIONS        ( 1000 )
+
+/* Number of measurements of each operation, only the shortest one is reported */
+#define BENCH_ROUNDS            ( 8 )
+
+
+/*
+ * Former implementation of vPortEnterCritical(), moved out of line
+ * and with R0 saved on the stack.
+ */
+static void prvLegacyEnterCritical( void ) __attribute__ ((noinline));
+static void prvLegacyEnterCritical( void )
+{
+    __asm volatile (
+        "STMDB  SP!, {R0}           \n\t"   /* Push R0.                             */
+        "MRS    R0, CPSR            \n\t"   /* Get CPSR.                            */
+        "ORR    R0, R0, #0xC0       \n\t"   /* Disable IRQ, FIQ.                    */
+        "MSR    CPSR, R0            \n\t"   /* Write back modified value.           */
+        "LDMIA  SP!, {R0}" );               /* Pop R0.                              */
+
+    ulCriticalNesting++;
+}
+
+
+/*
+ * Former implementation of vPortExitCritical(), moved out of line
+ * and with R0 saved on the stack.
+ */
+static void prvLegacyExitCritical( void ) __attribute__ ((noinline));
+static void prvLegacyExitCritical( void )
+{
+    if( ulCriticalNesting > 0 )
+    {
+        ulCriticalNesting--;
+
+        if( 0 == ulCriticalNesting )
+        {
+            __asm volatile (
+                "STMDB  SP!, {R0}       \n\t"   /* Push R0.                     */
+                "MRS    R0, CPSR        \n\t"   /* Get CPSR.                    */
+                "BIC    R0, R0, #0x80   \n\t"   /* Enable IRQ.                  */
+                "MSR    CPSR, R0        \n\t"   /* Write back modified value.   */
+                "LDMIA  SP!, {R0}" );           /* Pop R0.                      */
+        }
+    }
+}
+
+
+/*
+ * Types of measured operations.
+ */
+typedef enum _benchOperation
+{
+    BENCH_EMPTY_LOOP,                 /* loop overhead only */
+    BENCH_LEGACY_CRITICAL,            /* former enter/exit pair */
+    BENCH_INLINE_CRITICAL,            /* inlined enter/exit pair */
+    BENCH_QUEUE_SEND_RECEIVE          /* xQueueSend + xQueueReceive */
+} benchOperation;
+
+
+/*
+ * Performs BENCH_ITERATIONS repetitions of the selected operation
+ * on 'queue', timed by benchBestOf().
+ */
+static void prvMeasure( uint32_t op, void* queue )
+{
+    uint32_t i;
+    uint32_t item = 0;
+
+    switch ( (benchOperation) op )
+    {
+        case BENCH_EMPTY_LOOP :
+            for ( i=0; i<BENCH_ITERATIONS; ++i )
+            {
+                __asm volatile ( "" : : : "memory" );
+            }
+            break;
+
+        case BENCH_LEGACY_CRITICAL :
+            for ( i=0; i<BENCH_ITERATIONS; ++i )
+            {
+                prvLegacyEnterCritical();
+                prvLegacyExitCritical();
+            }
+            break;
+
+        case BENCH_INLINE_CRITICAL :
+            for ( i=0; i<BENCH_ITERATIONS; ++i )
+            {
+                portENTER_CRITICAL();
+                portEXIT_CRITICAL();
+            }
+            break;
+
+        case BENCH_QUEUE_SEND_RECEIVE :
+            for ( i=0; i<BENCH_ITERATIONS; ++i )
+            {
+                xQueueSendToBack(queue, (void*) &item, 0);
+                xQueueReceive(queue, (void*) &item, 0);
+            }
+            break;
+    }
+}
+
+
+/*
+ * Prints a result line.
+ */
+static void prvReport( const portCHAR* label, uint32_t ns )
+{
+    vDirectPrintMsg(label);
+    vDirectPrintNum(ns);
+    vDirectPrintMsg(" ns\r\n");
+}
+
+
+/**
+ * A task that performs the critical section benchmark, prints its results
+ * and deletes itself.
+ *
+ * It should be created with the highest priority, so it is executed
+ * as soon as the scheduler starts.
+ *
+ * @param params - ignored
+ */
+void benchCriticalTask( void* params )
+{
+    QueueHandle_t queue;
+    uint32_t tLoop;
+    uint32_t tLegacy;
+    uint32_t tInline;
+    uint32_t tQueue;
+
+    queue = objectsCreateQueue(OBJ_QUEUE_BENCHCRIT);
+
+    if ( pdPASS == benchInit() && NULL != queue )
+    {
+        /* The loop overhead is subtracted from other measurements */
+        tLoop = benchBestOf(prvMeasure, BENCH_EMPTY_LOOP, queue, BENCH_ROUNDS, 0);
+        tLegacy = benchBestOf(prvMeasure, BENCH_LEGACY_CRITICAL, queue, BENCH_ROUNDS, tLoop);
+        tInline = benchBestOf(prvMeasure, BENCH_INLINE_CRITICAL, queue, BENCH_ROUNDS, tLoop);
+        tQueue = benchBestOf(prvMeasure, BENCH_QUEUE_SEND_RECEIVE, queue, BENCH_ROUNDS, tLoop);
+
+        vDirectPrintMsg("\r\nCritical section benchmark:\r\n");
+        prvReport("  former enter/exit pair:  ", tLegacy);
+        prvReport("  inlined enter/exit pair: ", tInline);
+        prvReport("  saved per kernel call:   ",
+                  ( tLegacy > tInline ? tLegacy - tInline : 0 ) );
+        prvReport("  queue send + receive:    ", tQueue);
+        vDirectPrintMsg("\r\n");
+    }
+    else
+    {
+        vDirectPrintMsg("Critical section benchmark could not be started\r\n");
+    }
+
+    /*
+     * The queue's storage is reserved statically (see objects.h),
+     * so there is nothing to be freed.
+     */
+
+    vTaskDelete(NULL);
+
+    /* suppress a warning since 'params' is ignored */
+    (void) params;
+}
+
+#endif  /* APP_BENCH_CRITICAL != 0 */
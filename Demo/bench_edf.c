@@ -0,0 +1,312 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * A benchmark that compares the Earliest Deadline First scheduler
+ * (see vTaskSetDeadline() in task.h) against rate monotonic priorities.
+ *
+ * The same set of three periodic tasks (deadlines equal to periods) is run
+ * twice for each load: once with rate monotonic priorities (the shorter the
+ * period, the higher the priority) and once with all tasks at
+ * configEDF_PRIORITY. The nominal task set fully utilizes the processor and
+ * it is scaled down by a factor k/32 (k from BENCH_EDF_SCALE_MIN to 32).
+ *
+ * For each run the number of missed deadlines and the number of context
+ * switches to the tasks (activations plus preemptions, as counted by
+ * task_stats.c) are reported. The highest utilization without any missed
+ * deadlines (i.e. the schedulable utilization of the task set) is reported
+ * for each policy at the end.
+ *
+ * Execution times are emulated by busy loops that are calibrated at the
+ * beginning. Other tasks of the application and interrupts also consume
+ * some processor time, so the task set is never schedulable at the full
+ * load.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "app_config.h"
+#include "task_stats.h"
+
+#include "print.h"
+#include "bench.h"
+#include "objects.h"
+
+
+#if APP_BENCH_EDF != 0
+
+#if configUSE_EDF_SCHEDULER != 1 || configUSE_TASK_STATS != 1
+#error The EDF benchmark requires configUSE_EDF_SCHEDULER and configUSE_TASK_STATS
+#endif
+
+/* Rate monotonic priorities are assigned downwards from configEDF_PRIORITY */
+#if configEDF_PRIORITY < 3 || configEDF_PRIORITY >= configMAX_PRIORITIES - 1
+#error The EDF benchmark requires configEDF_PRIORITY between 3 and configMAX_PRIORITIES-2
+#endif
+
+/* Number of tasks in the task set */
+#define BENCH_TASKS             ( 3 )
+
+/* Scaling factors are expressed in 1/2^BENCH_SCALE_SHIFT */
+#define BENCH_SCALE_SHIFT       ( 5 )
+
+
+/*
+ * A task of the task set.
+ */
+typedef struct _benchEdfWorker
+{
+    TickType_t period;          /* period (and relative deadline) in ticks */
+    uint32_t wcet;              /* nominal execution time in microseconds */
+    uint32_t us;                /* execution time of the current run in microseconds */
+    uint32_t jobs;              /* completed jobs in the current run */
+    uint32_t misses;            /* jobs of the current run that missed their deadlines */
+    TaskHandle_t handle;
+    TaskStats_t stats;          /* activations and preemptions, see task_stats.h */
+} benchEdfWorker;
+
+
+/* The task set, sorted by periods. Its utilization is 2/5 + 2.8/7 + 2/10 = 1 */
+static benchEdfWorker workers[BENCH_TASKS] =
+{
+    { .period = 5,  .wcet = 2000 },
+    { .period = 7,  .wcet = 2800 },
+    { .period = 10, .wcet = 2000 }
+};
+
+/* Handle of the controlling task, notified by workers when a run is completed */
+static TaskHandle_t benchController = NULL;
+
+/* First release of the current run */
+static TickType_t benchStart = 0;
+
+
+/*
+ * Returns a utilization (in permille) of a task.
+ * As the library division is not available, it is computed
+ * by repeated subtraction (at most a thousand of them).
+ */
+static uint32_t prvPermille( uint32_t us, TickType_t period )
+{
+    uint32_t tickUs = ( 1000000UL / configTICK_RATE_HZ ) * period;
+    uint32_t rem = us * 1000;
+    uint32_t q = 0;
+
+    while ( rem >= tickUs )
+    {
+        rem -= tickUs;
+        ++q;
+    }
+
+    return q;
+}
+
+
+/*
+ * A periodic task of the task set. Each run starts when the controller
+ * notifies it and ends after BENCH_EDF_DURATION ticks.
+ */
+static void prvWorkerTask( void* params )
+{
+    benchEdfWorker* const w = (benchEdfWorker*) params;
+    TickType_t release;
+
+    for ( ; ; )
+    {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        /* The first call of vTaskDelayUntil releases the task at benchStart */
+        release = benchStart - w->period;
+
+        for ( ; ; )
+        {
+            /* Each release also sets the next absolute deadline */
+            vTaskDelayUntil(&release, w->period);
+
+            if ( (TickType_t) ( release - benchStart ) >= BENCH_EDF_DURATION )
+            {
+                break;
+            }
+
+            benchExecute(w->us);
+
+            if ( (TickType_t) ( xTaskGetTickCount() - release ) >= w->period )
+            {
+                ++w->misses;
+            }
+            ++w->jobs;
+        }
+
+        xTaskNotifyGive(benchController);
+    }
+}
+
+
+/*
+ * Runs the task set with the selected policy and scale, prints the
+ * results and returns the number of missed deadlines. 'util' is the
+ * nominal utilization of the task set in permille.
+ */
+static uint32_t prvRun( BaseType_t edf, uint32_t scale, uint32_t util )
+{
+    uint32_t i;
+    uint32_t done;
+    uint32_t switches = 0;
+    uint32_t jobs = 0;
+    uint32_t misses = 0;
+
+    for ( i=0; i<BENCH_TASKS; ++i )
+    {
+        vTaskPrioritySet(workers[i].handle,
+                         ( pdFALSE != edf ? configEDF_PRIORITY : configEDF_PRIORITY - i ) );
+        workers[i].us = ( workers[i].wcet * scale ) >> BENCH_SCALE_SHIFT;
+        workers[i].jobs = 0;
+        workers[i].misses = 0;
+
+        /* The counters are updated by the kernel hooks */
+        taskENTER_CRITICAL();
+        switches -= workers[i].stats.ulActivations + workers[i].stats.ulPreemptions;
+        taskEXIT_CRITICAL();
+    }
+
+    /* Leave enough time to all workers to wait for the first release */
+    benchStart = xTaskGetTickCount() + 2;
+
+    for ( i=0; i<BENCH_TASKS; ++i )
+    {
+        xTaskNotifyGive(workers[i].handle);
+    }
+
+    for ( done=0; done<BENCH_TASKS; )
+    {
+        done += ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    for ( i=0; i<BENCH_TASKS; ++i )
+    {
+        taskENTER_CRITICAL();
+        switches += workers[i].stats.ulActivations + workers[i].stats.ulPreemptions;
+        taskEXIT_CRITICAL();
+
+        jobs += workers[i].jobs;
+        misses += workers[i].misses;
+    }
+
+    vDirectPrintMsg( pdFALSE != edf ? "  EDF  " : "  RM   " );
+    vDirectPrintNum( ( util * scale ) >> BENCH_SCALE_SHIFT );
+    vDirectPrintMsg(" permille: missed ");
+    vDirectPrintNum(misses);
+    vDirectPrintMsg(" of ");
+    vDirectPrintNum(jobs);
+    vDirectPrintMsg(" deadlines, ");
+    vDirectPrintNum(switches);
+    vDirectPrintMsg(" context switches\r\n");
+
+    return misses;
+}
+
+
+/**
+ * A task that performs the EDF benchmark, prints its results, suspends
+ * the task set and deletes itself.
+ *
+ * It should be created with the highest priority, so it is executed
+ * as soon as the scheduler starts.
+ *
+ * @param params - ignored
+ */
+void benchEdfTask( void* params )
+{
+    uint32_t i;
+    uint32_t scale;
+    BaseType_t edf;
+    uint32_t util = 0;
+    uint32_t schedulable[2] = { 0, 0 };
+
+    benchController = xTaskGetCurrentTaskHandle();
+
+    if ( pdPASS != benchInit() )
+    {
+        vDirectPrintMsg("EDF benchmark could not be started\r\n");
+        vTaskDelete(NULL);
+    }
+
+    for ( i=0; i<BENCH_TASKS; ++i )
+    {
+        workers[i].handle = objectsCreateTask(OBJ_TASK_EDFWORK0 + i, prvWorkerTask,
+                                              (void*) &workers[i], configEDF_PRIORITY - i);
+        if ( NULL == workers[i].handle )
+        {
+            vDirectPrintMsg("EDF benchmark could not be started\r\n");
+            vTaskDelete(NULL);
+        }
+
+        vTaskSetDeadline(workers[i].handle, workers[i].period);
+        vPortTaskStatsRegister(workers[i].handle, &workers[i].stats);
+        util += prvPermille(workers[i].wcet, workers[i].period);
+    }
+
+    vDirectPrintMsg("\r\nEDF vs. rate monotonic benchmark, nominal utilization ");
+    vDirectPrintNum(util);
+    vDirectPrintMsg(" permille:\r\n");
+
+    for ( scale=BENCH_EDF_SCALE_MIN; scale<=(1UL<<BENCH_SCALE_SHIFT); ++scale )
+    {
+        for ( edf=pdFALSE; edf<=pdTRUE; ++edf )
+        {
+            if ( 0 == prvRun(edf, scale, util) )
+            {
+                schedulable[edf] = ( util * scale ) >> BENCH_SCALE_SHIFT;
+            }
+        }
+    }
+
+    vDirectPrintMsg("  schedulable utilization (permille), RM: ");
+    vDirectPrintNum(schedulable[pdFALSE]);
+    vDirectPrintMsg(", EDF: ");
+    vDirectPrintNum(schedulable[pdTRUE]);
+    vDirectPrintMsg("\r\n\r\n");
+
+    /*
+     * The workers remain registered for measurement (see task_stats.h),
+     * so they are suspended instead of deleted.
+     */
+    for ( i=0; i<BENCH_TASKS; ++i )
+    {
+        vTaskSuspend(workers[i].handle);
+    }
+
+    vTaskDelete(NULL);
+
+    /* suppress a warning since 'params' is ignored */
+    (void) params;
+}
+
+#endif  /* APP_BENCH_EDF != 0 */
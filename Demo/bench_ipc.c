@@ -0,0 +1,226 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * A benchmark that compares the round trip time of a request/response
+ * exchange over a pair of queues against a synchronous IPC channel
+ * (see ipc_channel.h).
+ *
+ * A client with a high priority sends BENCH_IPC_MSG_LEN bytes long
+ * requests to a server with a low priority and waits for equally long
+ * replies. Over queues each message is copied into a queue and out of
+ * it again, while the IPC channel copies it once, directly between
+ * the buffers of both tasks.
+ *
+ * The benchmark is performed by a task that prints its results directly
+ * to the UART, deletes both servers and itself. The time is measured as
+ * in bench_crit.c: BENCH_ITERATIONS (1000) round trips are timed by the
+ * free running counter (in microseconds), so the total equals the number
+ * of nanoseconds per round trip. The shortest of BENCH_ROUNDS
+ * measurements is reported.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+#include "app_config.h"
+
+#include "print.h"
+#include "bench.h"
+#include "objects.h"
+
+
+#if APP_BENCH_IPC != 0
+
+#if configUSE_IPC_CHANNELS != 1
+#error The IPC benchmark requires configUSE_IPC_CHANNELS
+#endif
+
+#include "ipc_channel.h"
+
+
+/* Number of round trips per measurement */
+#define BENCH_ITERATIONS        ( 1000 )
+
+/* Number of measurements of each method, only the shortest one is reported */
+#define BENCH_ROUNDS            ( 4 )
+
+/* Priority of both servers, lower than the client's one */
+#define BENCH_SERVER_PRIORITY   ( 1 )
+
+
+/* Queues of requests and replies */
+static QueueHandle_t benchRequestQueue;
+static QueueHandle_t benchReplyQueue;
+
+/* The IPC channel */
+static IpcChannel_t benchChannel;
+
+
+/*
+ * Server that replies to requests, received via the request queue,
+ * via the reply queue. The reply is the request with its first byte
+ * incremented.
+ */
+static void prvQueueServerTask( void* params )
+{
+    uint8_t msg[BENCH_IPC_MSG_LEN];
+
+    for ( ; ; )
+    {
+        if ( pdPASS == xQueueReceive(benchRequestQueue, (void*) msg, portMAX_DELAY) )
+        {
+            ++msg[0];
+            xQueueSendToBack(benchReplyQueue, (void*) msg, portMAX_DELAY);
+        }
+    }
+
+    /* suppress a warning since 'params' is ignored */
+    (void) params;
+}
+
+
+/*
+ * Server that replies to requests, received via the IPC channel.
+ * The reply is the request with its first byte incremented.
+ */
+static void prvIpcServerTask( void* params )
+{
+    uint8_t msg[BENCH_IPC_MSG_LEN];
+    IpcReceiveId_t rcvId;
+
+    for ( ; ; )
+    {
+        rcvId = xIpcReceive(&benchChannel, msg, sizeof(msg), NULL, portMAX_DELAY);
+        if ( NULL != rcvId )
+        {
+            ++msg[0];
+            vIpcReply(&benchChannel, rcvId, pdPASS, msg, sizeof(msg));
+        }
+    }
+
+    /* suppress a warning since 'params' is ignored */
+    (void) params;
+}
+
+
+/*
+ * Performs BENCH_ITERATIONS round trips via queues (if 'useIpc' equals
+ * pdFALSE) or the IPC channel, timed by benchBestOf().
+ */
+static void prvMeasure( uint32_t useIpc, void* arg )
+{
+    uint8_t request[BENCH_IPC_MSG_LEN] = { 0 };
+    uint8_t reply[BENCH_IPC_MSG_LEN];
+    size_t replyLen;
+    uint32_t i;
+
+    if ( pdFALSE == useIpc )
+    {
+        for ( i=0; i<BENCH_ITERATIONS; ++i )
+        {
+            xQueueSendToBack(benchRequestQueue, (void*) request, portMAX_DELAY);
+            xQueueReceive(benchReplyQueue, (void*) reply, portMAX_DELAY);
+        }
+    }
+    else
+    {
+        for ( i=0; i<BENCH_ITERATIONS; ++i )
+        {
+            replyLen = sizeof(reply);
+            lIpcSend(&benchChannel, request, sizeof(request), reply, &replyLen);
+        }
+    }
+
+    /* suppress a warning since 'arg' is ignored */
+    (void) arg;
+}
+
+
+/**
+ * A task that performs the IPC benchmark, prints its results
+ * and deletes both servers and itself.
+ *
+ * It should be created with a priority, higher than BENCH_SERVER_PRIORITY.
+ *
+ * @param params - ignored
+ */
+void benchIpcTask( void* params )
+{
+    TaskHandle_t queueServer;
+    TaskHandle_t ipcServer;
+    uint32_t tQueue;
+    uint32_t tIpc;
+
+    benchRequestQueue = objectsCreateQueue(OBJ_QUEUE_BENCHIPC_REQUEST);
+    benchReplyQueue = objectsCreateQueue(OBJ_QUEUE_BENCHIPC_REPLY);
+    vIpcChannelInit(&benchChannel);
+
+    queueServer = objectsCreateTask(OBJ_TASK_IPCQSRV, prvQueueServerTask, NULL, BENCH_SERVER_PRIORITY);
+    ipcServer = objectsCreateTask(OBJ_TASK_IPCSRV, prvIpcServerTask, NULL, BENCH_SERVER_PRIORITY);
+
+    if ( pdPASS == benchInit() && NULL != benchRequestQueue && NULL != benchReplyQueue &&
+         NULL != queueServer && NULL != ipcServer )
+    {
+        tQueue = benchBestOf(prvMeasure, pdFALSE, NULL, BENCH_ROUNDS, 0);
+        tIpc = benchBestOf(prvMeasure, pdTRUE, NULL, BENCH_ROUNDS, 0);
+
+        vDirectPrintMsg("\r\nIPC benchmark (round trip of ");
+        vDirectPrintNum(BENCH_IPC_MSG_LEN);
+        vDirectPrintMsg(" byte messages):\r\n");
+        vDirectPrintMsg("  pair of queues: ");
+        vDirectPrintNum(tQueue);
+        vDirectPrintMsg(" ns\r\n  IPC channel:    ");
+        vDirectPrintNum(tIpc);
+        vDirectPrintMsg(" ns\r\n\r\n");
+    }
+    else
+    {
+        vDirectPrintMsg("IPC benchmark could not be started\r\n");
+    }
+
+    /* Storage of all objects is reserved statically (see objects.h) */
+    if ( NULL != queueServer )
+    {
+        vTaskDelete(queueServer);
+    }
+
+    if ( NULL != ipcServer )
+    {
+        vTaskDelete(ipcServer);
+    }
+
+    vTaskDelete(NULL);
+
+    /* suppress a warning since 'params' is ignored */
+    (void) params;
+}
+
+#endif  /* APP_BENCH_IPC != 0 */
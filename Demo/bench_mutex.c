@@ -0,0 +1,346 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * A benchmark of mutexes with priority inheritance.
+ *
+ * First, the cost of a take/give pair of a binary semaphore, a mutex,
+ * a recursive mutex and a direct task notification (give/take) is
+ * measured as in bench_crit.c: BENCH_ITERATIONS (1000) pairs are timed by
+ * the free running counter (in microseconds), so the total equals the
+ * number of nanoseconds per pair. The shortest of BENCH_ROUNDS
+ * measurements is reported.
+ *
+ * Then the classic priority inversion scenario is run BENCH_ROUNDS times,
+ * once with a binary semaphore (no inheritance) and once with a mutex
+ * as the lock:
+ * - a low priority task takes the lock and executes for
+ *   BENCH_MUTEX_HOLD_US microseconds before it gives it,
+ * - a tick later, the high priority task (the benchmark task itself)
+ *   attempts to take the lock and at the same time releases
+ * - a medium priority task that executes for BENCH_MUTEX_MEDIUM_US
+ *   microseconds without touching the lock.
+ * Without inheritance, the medium priority task preempts the lock holder,
+ * so the high priority task is blocked for the rest of the hold time
+ * plus the medium task's entire execution time. With inheritance, the
+ * holder runs at the high priority until it gives the lock, so the
+ * blocking is bounded by the hold time. The worst observed blocking
+ * time of the high priority task is reported for both locks.
+ *
+ * Execution times are emulated by busy loops that are calibrated at the
+ * beginning (see bench.c), so they do not include the time a task
+ * was preempted.
+ *
+ * The benchmark task prints its results directly to the UART,
+ * deletes the other two tasks and itself.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include "app_config.h"
+#include "timebase.h"
+
+#include "print.h"
+#include "bench.h"
+#include "objects.h"
+
+
+#if APP_BENCH_MUTEX != 0
+
+#if configUSE_MUTEXES != 1 || configUSE_RECURSIVE_MUTEXES != 1
+#error The mutex benchmark requires configUSE_MUTEXES and configUSE_RECURSIVE_MUTEXES
+#endif
+
+/* The benchmark task is the high priority task */
+#if configMAX_PRIORITIES < 4
+#error The mutex benchmark requires configMAX_PRIORITIES of at least 4
+#endif
+
+/* Number of take/give pairs per measurement */
+#define BENCH_ITERATIONS        ( 1000 )
+
+/* Number of measurements of each primitive and runs of the inversion scenario */
+#define BENCH_ROUNDS            ( 8 )
+
+/* Priorities of the lock holder and the medium priority task */
+#define BENCH_LOW_PRIORITY      ( 1 )
+#define BENCH_MEDIUM_PRIORITY   ( 2 )
+
+
+/* The lock of the current run of the inversion scenario */
+static SemaphoreHandle_t benchLock = NULL;
+
+/* Handle of the benchmark task, notified when a task of the scenario has finished */
+static TaskHandle_t benchController = NULL;
+
+
+/*
+ * Types of measured operations.
+ */
+typedef enum _benchOperation
+{
+    BENCH_EMPTY_LOOP,                 /* loop overhead only */
+    BENCH_BINARY_SEMAPHORE,           /* xSemaphoreGive + xSemaphoreTake */
+    BENCH_MUTEX,                      /* xSemaphoreTake + xSemaphoreGive */
+    BENCH_RECURSIVE_MUTEX,            /* xSemaphoreTakeRecursive + xSemaphoreGiveRecursive */
+    BENCH_NOTIFICATION                /* xTaskNotifyGive + ulTaskNotifyTake */
+} benchOperation;
+
+
+/*
+ * The low priority task. On each notification by the benchmark task
+ * it takes the current lock, holds it for BENCH_MUTEX_HOLD_US and
+ * notifies the benchmark task after it has given the lock.
+ */
+static void prvLowTask( void* params )
+{
+    for ( ; ; )
+    {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if ( pdPASS == xSemaphoreTake(benchLock, portMAX_DELAY) )
+        {
+            benchExecute(BENCH_MUTEX_HOLD_US);
+            xSemaphoreGive(benchLock);
+        }
+
+        xTaskNotifyGive(benchController);
+    }
+
+    /* suppress a warning since 'params' is ignored */
+    (void) params;
+}
+
+
+/*
+ * The medium priority task. On each notification by the benchmark task
+ * it executes for BENCH_MUTEX_MEDIUM_US and notifies the benchmark task.
+ */
+static void prvMediumTask( void* params )
+{
+    for ( ; ; )
+    {
+        (void) ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        benchExecute(BENCH_MUTEX_MEDIUM_US);
+
+        xTaskNotifyGive(benchController);
+    }
+
+    /* suppress a warning since 'params' is ignored */
+    (void) params;
+}
+
+
+/*
+ * Performs BENCH_ITERATIONS repetitions of the selected operation
+ * on 'sem', timed by benchBestOf().
+ */
+static void prvMeasure( uint32_t op, void* sem )
+{
+    uint32_t i;
+
+    switch ( (benchOperation) op )
+    {
+        case BENCH_EMPTY_LOOP :
+            for ( i=0; i<BENCH_ITERATIONS; ++i )
+            {
+                __asm volatile ( "" : : : "memory" );
+            }
+            break;
+
+        case BENCH_BINARY_SEMAPHORE :
+            for ( i=0; i<BENCH_ITERATIONS; ++i )
+            {
+                xSemaphoreGive(sem);
+                xSemaphoreTake(sem, 0);
+            }
+            break;
+
+        case BENCH_MUTEX :
+            for ( i=0; i<BENCH_ITERATIONS; ++i )
+            {
+                xSemaphoreTake(sem, 0);
+                xSemaphoreGive(sem);
+            }
+            break;
+
+        case BENCH_RECURSIVE_MUTEX :
+            for ( i=0; i<BENCH_ITERATIONS; ++i )
+            {
+                xSemaphoreTakeRecursive(sem, 0);
+                xSemaphoreGiveRecursive(sem);
+            }
+            break;
+
+        case BENCH_NOTIFICATION :
+            for ( i=0; i<BENCH_ITERATIONS; ++i )
+            {
+                xTaskNotifyGive(benchController);
+                (void) ulTaskNotifyTake(pdTRUE, 0);
+            }
+            break;
+    }
+}
+
+
+/*
+ * Runs the inversion scenario BENCH_ROUNDS times with 'lock' and
+ * returns the longest time (in microseconds) the benchmark task
+ * was blocked when attempting to take the lock.
+ */
+static uint32_t prvInversion( SemaphoreHandle_t lock, TaskHandle_t low, TaskHandle_t medium )
+{
+    uint32_t worst = 0;
+    uint32_t start;
+    uint32_t blocked;
+    uint32_t finished;
+    uint8_t round;
+
+    benchLock = lock;
+
+    for ( round=0; round<BENCH_ROUNDS; ++round )
+    {
+        /* Let the low priority task take the lock */
+        xTaskNotifyGive(low);
+        vTaskDelay(1);
+
+        /* The medium priority task is released when the lock is requested */
+        xTaskNotifyGive(medium);
+
+        start = timebase_getCounter();
+        if ( pdPASS == xSemaphoreTake(lock, portMAX_DELAY) )
+        {
+            blocked = timebase_getCounter() - start;
+            xSemaphoreGive(lock);
+
+            if ( blocked > worst )
+            {
+                worst = blocked;
+            }
+        }
+
+        /* Wait until both tasks have finished */
+        for ( finished=0; finished<2; )
+        {
+            finished += ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+    }
+
+    return worst;
+}
+
+
+/*
+ * Prints a result line.
+ */
+static void prvReport( const portCHAR* label, uint32_t value, const portCHAR* unit )
+{
+    vDirectPrintMsg(label);
+    vDirectPrintNum(value);
+    vDirectPrintMsg(unit);
+}
+
+
+/**
+ * A task that performs the mutex benchmark, prints its results
+ * and deletes its helper tasks and itself.
+ *
+ * It should be created with a priority, higher than BENCH_MEDIUM_PRIORITY.
+ *
+ * @param params - ignored
+ */
+void benchMutexTask( void* params )
+{
+    SemaphoreHandle_t binary;
+    SemaphoreHandle_t mutex;
+    SemaphoreHandle_t recursive;
+    TaskHandle_t low;
+    TaskHandle_t medium;
+    uint32_t tLoop;
+
+    benchController = xTaskGetCurrentTaskHandle();
+
+    binary = objectsCreateSemaphore(OBJ_SEMAPHORE_BENCHBIN);
+    mutex = objectsCreateSemaphore(OBJ_SEMAPHORE_BENCHMTX);
+    recursive = objectsCreateSemaphore(OBJ_SEMAPHORE_BENCHRMTX);
+
+    low = objectsCreateTask(OBJ_TASK_MTXLOW, prvLowTask, NULL, BENCH_LOW_PRIORITY);
+    medium = objectsCreateTask(OBJ_TASK_MTXMED, prvMediumTask, NULL, BENCH_MEDIUM_PRIORITY);
+
+    if ( pdPASS == benchInit() && NULL != binary && NULL != mutex &&
+         NULL != recursive && NULL != low && NULL != medium )
+    {
+        /* The loop overhead is subtracted from other measurements */
+        tLoop = benchBestOf(prvMeasure, BENCH_EMPTY_LOOP, NULL, BENCH_ROUNDS, 0);
+
+        vDirectPrintMsg("\r\nMutex benchmark:\r\n");
+        prvReport("  binary semaphore give + take:  ",
+                  benchBestOf(prvMeasure, BENCH_BINARY_SEMAPHORE, binary, BENCH_ROUNDS, tLoop), " ns\r\n");
+        prvReport("  mutex take + give:             ",
+                  benchBestOf(prvMeasure, BENCH_MUTEX, mutex, BENCH_ROUNDS, tLoop), " ns\r\n");
+        prvReport("  recursive mutex take + give:   ",
+                  benchBestOf(prvMeasure, BENCH_RECURSIVE_MUTEX, recursive, BENCH_ROUNDS, tLoop), " ns\r\n");
+        prvReport("  notification give + take:      ",
+                  benchBestOf(prvMeasure, BENCH_NOTIFICATION, NULL, BENCH_ROUNDS, tLoop), " ns\r\n");
+
+        /* The binary semaphore serves as a lock without inheritance */
+        xSemaphoreGive(binary);
+
+        prvReport("  worst blocking, no inheritance: ",
+                  prvInversion(binary, low, medium), " us\r\n");
+        prvReport("  worst blocking, inheritance:    ",
+                  prvInversion(mutex, low, medium), " us\r\n");
+        vDirectPrintMsg("\r\n");
+    }
+    else
+    {
+        vDirectPrintMsg("Mutex benchmark could not be started\r\n");
+    }
+
+    /* Storage of all objects is reserved statically (see objects.h) */
+    if ( NULL != low )
+    {
+        vTaskDelete(low);
+    }
+
+    if ( NULL != medium )
+    {
+        vTaskDelete(medium);
+    }
+
+    vTaskDelete(NULL);
+
+    /* suppress a warning since 'params' is ignored */
+    (void) params;
+}
+
+#endif  /* APP_BENCH_MUTEX != 0 */
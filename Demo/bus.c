@@ -0,0 +1,428 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * Implementation of a topic based publish/subscribe bus.
+ *
+ * Topics are declared statically in bus.h. A producer publishes a
+ * payload (a packet buffer, see pbuf.h) to a topic without knowing
+ * its consumers, so consumers may be added without modifying producers.
+ * A consumer subscribes either
+ * - a queue (items of size sizeof(pbuf*)): each published payload is
+ *   passed to the queue with its own reference, which the consumer must
+ *   free. If the queue is full, the payload is dropped for this
+ *   subscriber, so a slow consumer never delays the producer.
+ * - a task: the bit of the topic (1 << topic) is set in the task's
+ *   direct notification at the given index, the task then obtains the
+ *   payload by busGetLatest().
+ *
+ * Payloads are never copied and nothing is allocated, hence publishing
+ * takes time proportional to the number of subscribers. The latest
+ * payload of each topic is kept (with its own reference), so a late
+ * subscriber may obtain the current value immediately.
+ *
+ * Subscriptions are never removed.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+#include "hrtimer.h"
+#include "event_flags.h"
+#include "ipc_channel.h"
+
+#include "pbuf.h"
+#include "bus.h"
+
+
+#if configUSE_TASK_NOTIFICATIONS != 1
+#error bus.c requires configUSE_TASK_NOTIFICATIONS
+#endif
+
+
+/* A subscriber is either a queue or a task */
+typedef struct _busSubscriber
+{
+    QueueHandle_t queue;         /* subscribed queue or NULL */
+    TaskHandle_t task;           /* subscribed task or NULL */
+    UBaseType_t notifyIndex;     /* index of the task's notification */
+} busSubscriber;
+
+/* Description and state of a topic */
+typedef struct _busTopic
+{
+    const char* name;
+    busSubscriber* subs;         /* array of subscribers */
+    uint8_t maxSubs;             /* size of 'subs' */
+    volatile uint8_t nrSubs;     /* number of valid entries of 'subs' */
+    pbuf* latest;                /* the last published payload or NULL */
+    volatile uint32_t published;
+    volatile uint32_t dropped;
+} busTopic;
+
+
+#if BUS_NR_TOPICS > 32
+#error At most 32 topics may be declared
+#endif
+
+/* Subscribers of each topic, reserved in .bss */
+#define BUS_TOPIC_STORAGE(id, name, subscribers) \
+    static busSubscriber busSubs_##id[subscribers];
+
+BUS_TOPICS(BUS_TOPIC_STORAGE)
+
+#define BUS_TOPIC_INIT(id, name, subscribers) \
+    { name, busSubs_##id, subscribers, 0, NULL, 0, 0 },
+
+static busTopic busTopics[BUS_NR_TOPICS] =
+{
+    BUS_TOPICS(BUS_TOPIC_INIT)
+};
+
+
+
+/*
+ * Appends a subscriber to a topic.
+ *
+ * @return pdPASS on success, pdFAIL if 'topic' is invalid or has no room for more subscribers
+ */
+static int16_t busSubscribe(busTopicId topic, QueueHandle_t queue,
+                            TaskHandle_t task, UBaseType_t notifyIndex)
+{
+    busTopic* t;
+    busSubscriber* s;
+    int16_t retVal = pdFAIL;
+
+    if ( topic >= BUS_NR_TOPICS )
+    {
+        return pdFAIL;
+    }
+
+    t = &busTopics[topic];
+
+    taskENTER_CRITICAL();
+    {
+        if ( t->nrSubs < t->maxSubs )
+        {
+            /* The entry must be complete before publishers see it */
+            s = &t->subs[t->nrSubs];
+            s->queue = queue;
+            s->task = task;
+            s->notifyIndex = notifyIndex;
+            ++t->nrSubs;
+            retVal = pdPASS;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return retVal;
+}
+
+
+/**
+ * Subscribes a queue to a topic. Each payload, published to the topic,
+ * is passed to the queue with its own reference, which must be freed
+ * by the consumer (see pbufFree()).
+ *
+ * @param topic - topic to subscribe to
+ * @param queue - queue with items of size sizeof(pbuf*)
+ *
+ * @return pdPASS on success, pdFAIL if the topic cannot accept more subscribers
+ */
+int16_t busSubscribeQueue(busTopicId topic, QueueHandle_t queue)
+{
+    if ( NULL == queue )
+    {
+        return pdFAIL;
+    }
+
+    return busSubscribe(topic, queue, NULL, 0);
+}
+
+
+/**
+ * Subscribes a task to a topic. Whenever a payload is published to
+ * the topic, the bit (1 << topic) is set in the task's notification
+ * value at 'notifyIndex' (see xTaskNotifyWaitIndexed()).
+ * The payload may then be obtained by busGetLatest().
+ *
+ * @param topic - topic to subscribe to
+ * @param task - task to be notified
+ * @param notifyIndex - index of the task's notification, must not be reserved
+ *                      for vTaskDelayUs(), event flags or IPC channels
+ *
+ * @return pdPASS on success, pdFAIL if the topic cannot accept more subscribers
+ *         or 'notifyIndex' is invalid
+ */
+int16_t busSubscribeTask(busTopicId topic, TaskHandle_t task, UBaseType_t notifyIndex)
+{
+    if ( NULL == task || notifyIndex >= configTASK_NOTIFICATION_ARRAY_ENTRIES )
+    {
+        return pdFAIL;
+    }
+
+    /*
+     * Each of these services consumes and clears any notification,
+     * given to its index, so the subscriber would miss publications.
+     */
+#if configUSE_HR_TIMER == 1
+    if ( portHR_TIMER_NOTIFY_INDEX == notifyIndex )
+    {
+        return pdFAIL;
+    }
+#endif
+
+#if configUSE_EVENT_FLAGS == 1
+    if ( portEVENT_FLAGS_NOTIFY_INDEX == notifyIndex )
+    {
+        return pdFAIL;
+    }
+#endif
+
+#if configUSE_IPC_CHANNELS == 1
+    if ( portIPC_NOTIFY_INDEX == notifyIndex )
+    {
+        return pdFAIL;
+    }
+#endif
+
+    return busSubscribe(topic, NULL, task, notifyIndex);
+}
+
+
+/*
+ * Replaces the topic's latest payload by 'p'.
+ *
+ * @note IRQs are expected to be disabled, as it is the case in ISRs.
+ */
+static void busSetLatestFromISR(busTopic* t, pbuf* p)
+{
+    pbufRefFromISR(p);
+    pbufFreeFromISR(t->latest);
+    t->latest = p;
+    ++t->published;
+}
+
+
+/**
+ * Publishes a payload to all subscribers of a topic. The payload is
+ * not copied, each subscribed queue obtains its own reference.
+ * The caller keeps its reference in any case and must free it.
+ *
+ * The function never blocks. If a subscribed queue is full,
+ * the payload is not delivered to it and is counted as dropped.
+ *
+ * @param topic - topic to publish to
+ * @param p - payload (first buffer of a packet)
+ *
+ * @return number of subscribers the payload has been delivered to
+ */
+uint8_t busPublish(busTopicId topic, pbuf* p)
+{
+    busTopic* t;
+    const busSubscriber* s;
+    uint8_t nrSubs;
+    uint8_t delivered = 0;
+    uint8_t i;
+
+    if ( topic >= BUS_NR_TOPICS || NULL == p )
+    {
+        return 0;
+    }
+
+    t = &busTopics[topic];
+
+    taskENTER_CRITICAL();
+    {
+        busSetLatestFromISR(t, p);
+    }
+    taskEXIT_CRITICAL();
+
+    nrSubs = t->nrSubs;
+
+    for ( i=0; i<nrSubs; ++i )
+    {
+        s = &t->subs[i];
+
+        if ( NULL != s->queue )
+        {
+            if ( 1 == pbufFanOut(&s->queue, 1, p, 0) )
+            {
+                ++delivered;
+            }
+            else
+            {
+                /* busPublishFromISR() may update the counter as well */
+                taskENTER_CRITICAL();
+                {
+                    ++t->dropped;
+                }
+                taskEXIT_CRITICAL();
+            }
+        }
+        else
+        {
+            xTaskNotifyIndexed(s->task, s->notifyIndex, 1UL << topic, eSetBits);
+            ++delivered;
+        }
+    }
+
+    return delivered;
+}
+
+
+/**
+ * Publishes a payload to all subscribers of a topic from an ISR,
+ * see busPublish() for details.
+ *
+ * @note IRQs are expected to be disabled, as it is the case in ISRs.
+ *
+ * @param topic - topic to publish to
+ * @param p - payload (first buffer of a packet)
+ * @param pxHigherPriorityTaskWoken - set to pdTRUE if a subscriber has been unblocked
+ *
+ * @return number of subscribers the payload has been delivered to
+ */
+uint8_t busPublishFromISR(busTopicId topic, pbuf* p, BaseType_t* pxHigherPriorityTaskWoken)
+{
+    busTopic* t;
+    const busSubscriber* s;
+    uint8_t delivered = 0;
+    uint8_t i;
+
+    if ( topic >= BUS_NR_TOPICS || NULL == p )
+    {
+        return 0;
+    }
+
+    t = &busTopics[topic];
+
+    busSetLatestFromISR(t, p);
+
+    for ( i=0; i<t->nrSubs; ++i )
+    {
+        s = &t->subs[i];
+
+        if ( NULL != s->queue )
+        {
+            pbufRefFromISR(p);
+
+            if ( pdPASS == xQueueSendToBackFromISR(s->queue, (void*) &p, pxHigherPriorityTaskWoken) )
+            {
+                ++delivered;
+            }
+            else
+            {
+                pbufFreeFromISR(p);
+                ++t->dropped;
+            }
+        }
+        else
+        {
+            xTaskNotifyIndexedFromISR(s->task, s->notifyIndex, 1UL << topic,
+                                      eSetBits, pxHigherPriorityTaskWoken);
+            ++delivered;
+        }
+    }
+
+    return delivered;
+}
+
+
+/**
+ * Returns the last payload, published to a topic, with a new reference
+ * that must be freed by the caller (see pbufFree()).
+ *
+ * @param topic - topic of the payload
+ *
+ * @return the last payload or NULL if nothing has been published yet or 'topic' is invalid
+ */
+pbuf* busGetLatest(busTopicId topic)
+{
+    pbuf* p;
+
+    if ( topic >= BUS_NR_TOPICS )
+    {
+        return NULL;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        p = busTopics[topic].latest;
+        pbufRefFromISR(p);
+    }
+    taskEXIT_CRITICAL();
+
+    return p;
+}
+
+
+/**
+ * Copies statistics of a topic.
+ *
+ * @param topic - topic
+ * @param stats - statistics are written here
+ *
+ * @return pdPASS on success, pdFAIL if 'topic' is invalid
+ */
+int16_t busGetStats(busTopicId topic, busTopicStats* stats)
+{
+    const busTopic* t;
+
+    if ( topic >= BUS_NR_TOPICS || NULL == stats )
+    {
+        return pdFAIL;
+    }
+
+    t = &busTopics[topic];
+
+    stats->name = t->name;
+    stats->subscribers = t->nrSubs;
+    stats->published = t->published;
+    stats->dropped = t->dropped;
+
+    return pdPASS;
+}
+
+
+/**
+ * Clears counters of published and dropped payloads of all topics.
+ */
+void busResetStats(void)
+{
+    uint8_t i;
+
+    for ( i=0; i<BUS_NR_TOPICS; ++i )
+    {
+        busTopics[i].published = 0;
+        busTopics[i].dropped = 0;
+    }
+}
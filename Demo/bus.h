@@ -0,0 +1,86 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * Declaration of a topic based publish/subscribe bus.
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _BUS_H_
+#define _BUS_H_
+
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+#include "pbuf.h"
+
+
+/*
+ * Topics: X( id, name, maximum number of subscribers )
+ * At most 32 topics may be declared.
+ */
+#define BUS_TOPICS(X) \
+    X( RECV_LINE,  "recv",       2 )
+
+
+/* Identifiers of topics, e.g. BUS_TOPIC_RECV_LINE */
+#define BUS_TOPIC_ID(id, name, subscribers)     BUS_TOPIC_##id,
+
+typedef enum _busTopicId
+{
+    BUS_TOPICS(BUS_TOPIC_ID)
+    BUS_NR_TOPICS
+} busTopicId;
+
+/* Statistics of a topic */
+typedef struct _busTopicStats
+{
+    const char* name;            /* name of the topic */
+    uint8_t subscribers;         /* number of subscribers */
+    uint32_t published;          /* number of published payloads */
+    uint32_t dropped;            /* number of payloads not delivered due to full queues */
+} busTopicStats;
+
+
+int16_t busSubscribeQueue(busTopicId topic, QueueHandle_t queue);
+
+int16_t busSubscribeTask(busTopicId topic, TaskHandle_t task, UBaseType_t notifyIndex);
+
+uint8_t busPublish(busTopicId topic, pbuf* p);
+
+uint8_t busPublishFromISR(busTopicId topic, pbuf* p, BaseType_t* pxHigherPriorityTaskWoken);
+
+pbuf* busGetLatest(busTopicId topic);
+
+int16_t busGetStats(busTopicId topic, busTopicStats* stats);
+
+void busResetStats(void);
+
+
+#endif  /* _BUS_H_ */
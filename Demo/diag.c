@@ -0,0 +1,574 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file
+ * Diagnostic commands that can be entered via the receiving UART.
+ *
+ * When a line, entered by a user, matches any diagnostic command,
+ * the corresponding diagnostic information is printed instead of
+ * echoing the line. The following commands are supported (if the
+ * corresponding statistics are enabled):
+ * - "crit", "crit reset": sections with disabled IRQs and suspended scheduler
+ * - "irq", "irq reset": execution times and entry latencies of IRQs
+ * - "irq probe": triggers software generated interrupts to measure the entry latency
+ * - "tasks", "tasks reset": execution and response times of registered tasks
+ * - "periodic", "periodic reset": release latencies of periodic tasks
+ * - "pbuf", "pbuf reset": usage of the pool of packet buffers
+ * - "bus", "bus reset": published and dropped payloads of each topic
+ * - "stacks": high water marks of stacks of all tasks and operating modes
+ *
+ * Diagnostic information is printed directly to the UART (see vDirectPrintMsg()),
+ * so it may get interleaved with messages, printed by the gate keeper task.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stddef.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "app_config.h"
+#include "bsp.h"
+#include "interrupt.h"
+#include "timer.h"
+#include "timebase.h"
+
+#include "print.h"
+#include "periodic.h"
+#include "pbuf.h"
+#include "bus.h"
+#include "diag.h"
+
+#if configUSE_CRITICAL_STATS == 1
+#include "critical_stats.h"
+#endif
+
+#if configUSE_TASK_STATS == 1
+#include "task_stats.h"
+#endif
+
+#if configUSE_STACK_STATS == 1
+#include "stack_stats.h"
+#endif
+
+
+/* Prototype of a function that executes a diagnostic command */
+typedef void (*diagCommandFunction)(void);
+
+/* A diagnostic command and its function */
+typedef struct _diagCommand
+{
+    const portCHAR* name;            /* command as entered by a user */
+    diagCommandFunction func;        /* function that executes the command */
+} diagCommand;
+
+
+#if configUSE_CRITICAL_STATS == 1
+
+/*
+ * Prints statistics of one kind of sections.
+ */
+static void prvPrintCriticalStats(const portCHAR* title, const CriticalStats_t* stats)
+{
+    uint8_t i;
+
+    vDirectPrintMsg(title);
+    vDirectPrintMsg(": ");
+    vDirectPrintNum(stats->ulCount);
+    vDirectPrintMsg(" sections, total ");
+    vDirectPrintNum(stats->ulTotal);
+    vDirectPrintMsg(" us, max ");
+    vDirectPrintNum(stats->ulMax);
+    vDirectPrintMsg(" us\r\n");
+
+    /* Upper limits of bins are powers of 2, the last bin is unlimited */
+    vDirectPrintMsg("  histogram [< us: count]:");
+    for ( i=0; i<portCRITICAL_STATS_BINS; ++i )
+    {
+        vDirectPrintMsg(" ");
+        if ( i < portCRITICAL_STATS_BINS - 1 )
+        {
+            vDirectPrintNum(1UL << i);
+        }
+        else
+        {
+            vDirectPrintMsg("inf");
+        }
+        vDirectPrintMsg(":");
+        vDirectPrintNum(stats->ulHistogram[i]);
+    }
+    vDirectPrintMsg("\r\n");
+
+    for ( i=0; i<portCRITICAL_STATS_LONGEST; ++i )
+    {
+        if ( NULL != stats->xLongest[i].pvCaller )
+        {
+            vDirectPrintMsg("  ");
+            vDirectPrintHex((uint32_t) stats->xLongest[i].pvCaller);
+            vDirectPrintMsg(": ");
+            vDirectPrintNum(stats->xLongest[i].ulDuration);
+            vDirectPrintMsg(" us\r\n");
+        }
+    }
+}
+
+
+/*
+ * Prints statistics of sections with disabled interrupts
+ * and with the suspended scheduler.
+ */
+static void prvCritStats(void)
+{
+    CriticalStats_t irqStats;
+    CriticalStats_t schedStats;
+
+    vPortGetCriticalStats(&irqStats, &schedStats);
+
+    prvPrintCriticalStats("IRQs disabled", &irqStats);
+    prvPrintCriticalStats("Scheduler suspended", &schedStats);
+}
+
+
+/*
+ * Clears statistics of sections with disabled interrupts
+ * and with the suspended scheduler.
+ */
+static void prvCritReset(void)
+{
+    vPortResetCriticalStats();
+    vDirectPrintMsg("Critical section statistics cleared\r\n");
+}
+
+#endif  /* configUSE_CRITICAL_STATS == 1 */
+
+
+#if PIC_IRQ_STATS != 0
+
+/* Number of serviced probing interrupts */
+static volatile uint32_t probeCount = 0;
+
+
+/*
+ * ISR of the software generated interrupt, triggered by prvIrqProbe().
+ */
+static void prvProbeIsr(void)
+{
+    pic_clearSoftwareInterrupt();
+    ++probeCount;
+}
+
+
+/*
+ * Prints statistics of all IRQs that have been serviced at least once.
+ */
+static void prvIrqStats(void)
+{
+    uint8_t irq;
+    picIrqStats stats;
+
+    vDirectPrintMsg("IRQ: count, total/max ISR time [us], latency count, total/max latency [us]\r\n");
+
+    for ( irq=0; irq<32; ++irq )
+    {
+        if ( pic_getIrqStats(irq, &stats) < 0 || 0 == stats.count )
+        {
+            continue;  /* to the next IRQ */
+        }
+
+        vDirectPrintNum(irq);
+        vDirectPrintMsg(": ");
+        vDirectPrintNum(stats.count);
+        vDirectPrintMsg(", ");
+        vDirectPrintNum(stats.totalTime);
+        vDirectPrintMsg("/");
+        vDirectPrintNum(stats.maxTime);
+        vDirectPrintMsg(", ");
+        vDirectPrintNum(stats.latencyCount);
+        vDirectPrintMsg(", ");
+        vDirectPrintNum(stats.totalLatency);
+        vDirectPrintMsg("/");
+        vDirectPrintNum(stats.maxLatency);
+        vDirectPrintMsg("\r\n");
+    }
+}
+
+
+/*
+ * Clears statistics of all IRQs.
+ */
+static void prvIrqReset(void)
+{
+    pic_resetStats();
+    vDirectPrintMsg("IRQ statistics cleared\r\n");
+}
+
+
+/*
+ * Triggers DIAG_PROBE_COUNT software generated interrupts. Their triggers are
+ * timestamped, so the entry latency of the IRQ handler is measured.
+ */
+static void prvIrqProbe(void)
+{
+    uint32_t i;
+    uint32_t expected;
+
+    for ( i=0; i<DIAG_PROBE_COUNT; ++i )
+    {
+        expected = probeCount + 1;
+        pic_setSoftwareInterrupt();
+
+        /* IRQs are enabled, the interrupt is serviced immediately */
+        while ( probeCount != expected );
+    }
+
+    vDirectPrintMsg("IRQ probe completed\r\n");
+}
+
+#endif  /* PIC_IRQ_STATS != 0 */
+
+
+#if configUSE_TASK_STATS == 1
+
+/* Maximum number of registered tasks that are reported */
+#define DIAG_MAX_TASKS          ( 8 )
+
+/*
+ * Prints minimum, mean and maximum value, separated by slashes.
+ */
+static void prvPrintMinMeanMax(uint32_t min, uint32_t mean, uint32_t max)
+{
+    vDirectPrintNum(min);
+    vDirectPrintMsg("/");
+    vDirectPrintNum(mean);
+    vDirectPrintMsg("/");
+    vDirectPrintNum(max);
+}
+
+
+/*
+ * Prints execution and response times of all registered tasks.
+ */
+static void prvTaskStats(void)
+{
+    static TaskStatsReport_t report[DIAG_MAX_TASKS];
+    UBaseType_t count;
+    UBaseType_t i;
+
+    count = uxPortGetTaskStats(report, DIAG_MAX_TASKS);
+
+    vDirectPrintMsg("Task: activations, min/mean/max exec [us], min/mean/max response [us], preemptions (max)\r\n");
+
+    for ( i=0; i<count; ++i )
+    {
+        vDirectPrintMsg(pcTaskGetName(report[i].xTask));
+        vDirectPrintMsg(": ");
+        vDirectPrintNum(report[i].ulActivations);
+        vDirectPrintMsg(", ");
+        prvPrintMinMeanMax(report[i].ulExecMin, report[i].ulExecMean, report[i].ulExecMax);
+        vDirectPrintMsg(", ");
+        prvPrintMinMeanMax(report[i].ulResponseMin, report[i].ulResponseMean, report[i].ulResponseMax);
+        vDirectPrintMsg(", ");
+        vDirectPrintNum(report[i].ulPreemptions);
+        vDirectPrintMsg(" (");
+        vDirectPrintNum(report[i].ulMaxPreemptions);
+        vDirectPrintMsg(")\r\n");
+    }
+}
+
+
+/*
+ * Clears statistics of all registered tasks.
+ */
+static void prvTaskReset(void)
+{
+    vPortResetTaskStats();
+    vDirectPrintMsg("Task statistics cleared\r\n");
+}
+
+#endif  /* configUSE_TASK_STATS == 1 */
+
+
+/*
+ * Clears release statistics of all periodic tasks.
+ */
+static void prvPeriodicReset(void)
+{
+    periodicReset();
+    vDirectPrintMsg("Periodic task statistics cleared\r\n");
+}
+
+
+#if configUSE_STACK_STATS == 1
+
+/* Maximum number of tasks whose stacks are reported */
+#define DIAG_MAX_STACK_TASKS    ( 16 )
+
+/*
+ * Prints high water marks (i.e. the number of words that have never
+ * been used) of stacks of all tasks and of all operating modes.
+ */
+static void prvStackStats(void)
+{
+    ModeStackStats_t modeStats[eNumberOfModeStacks];
+    UBaseType_t i;
+#if configUSE_TRACE_FACILITY == 1
+    static TaskStatus_t status[DIAG_MAX_STACK_TASKS];
+    UBaseType_t count;
+
+    count = uxTaskGetSystemState(status, DIAG_MAX_STACK_TASKS, NULL);
+
+    vDirectPrintMsg("Task: unused stack [words]\r\n");
+
+    for ( i=0; i<count; ++i )
+    {
+        vDirectPrintMsg(status[i].pcTaskName);
+        vDirectPrintMsg(": ");
+        vDirectPrintNum(status[i].usStackHighWaterMark);
+        vDirectPrintMsg("\r\n");
+    }
+#endif
+
+    vPortGetModeStackStats(modeStats);
+
+    vDirectPrintMsg("Mode: unused/total stack [words]\r\n");
+
+    for ( i=0; i<eNumberOfModeStacks; ++i )
+    {
+        vDirectPrintMsg(modeStats[i].pcName);
+        vDirectPrintMsg(": ");
+        vDirectPrintNum(modeStats[i].ulHighWaterMark);
+        vDirectPrintMsg("/");
+        vDirectPrintNum(modeStats[i].ulSize);
+        vDirectPrintMsg("\r\n");
+    }
+}
+
+#endif  /* configUSE_STACK_STATS == 1 */
+
+
+/*
+ * Prints the number of dropped messages of each class.
+ */
+static void prvPrintStats(void)
+{
+    static const portCHAR* const classNames[PRINT_NR_CLASSES] =
+        { "urgent", "normal", "background" };
+    uint16_t cls;
+
+    vDirectPrintMsg("Print class: dropped messages\r\n");
+
+    for ( cls=0; cls<PRINT_NR_CLASSES; ++cls )
+    {
+        vDirectPrintMsg(classNames[cls]);
+        vDirectPrintMsg(": ");
+        vDirectPrintNum(printGetDropCount((printClass) cls));
+        vDirectPrintMsg("\r\n");
+    }
+}
+
+
+/*
+ * Clears counters of dropped messages.
+ */
+static void prvPrintReset(void)
+{
+    printResetDropCounts();
+    vDirectPrintMsg("Print statistics cleared\r\n");
+}
+
+
+/*
+ * Prints usage of the pool of packet buffers.
+ */
+static void prvPbufStats(void)
+{
+    pbufStats stats;
+
+    pbufGetStats(&stats);
+
+    vDirectPrintMsg("Packet buffers: available ");
+    vDirectPrintNum(stats.available);
+    vDirectPrintMsg(", min. available ");
+    vDirectPrintNum(stats.minAvailable);
+    vDirectPrintMsg(", total ");
+    vDirectPrintNum(PBUF_POOL_SIZE);
+    vDirectPrintMsg(", failed allocations ");
+    vDirectPrintNum(stats.failures);
+    vDirectPrintMsg("\r\n");
+}
+
+
+/*
+ * Clears statistics of the pool of packet buffers.
+ */
+static void prvPbufReset(void)
+{
+    pbufResetStats();
+    vDirectPrintMsg("Packet buffer statistics cleared\r\n");
+}
+
+
+/*
+ * Prints subscribers, published and dropped payloads of each topic of the bus.
+ */
+static void prvBusStats(void)
+{
+    busTopicStats stats;
+    uint8_t topic;
+
+    vDirectPrintMsg("Topic: subscribers, published, dropped\r\n");
+
+    for ( topic=0; topic<BUS_NR_TOPICS; ++topic )
+    {
+        busGetStats((busTopicId) topic, &stats);
+
+        vDirectPrintMsg(stats.name);
+        vDirectPrintMsg(": ");
+        vDirectPrintNum(stats.subscribers);
+        vDirectPrintMsg(", ");
+        vDirectPrintNum(stats.published);
+        vDirectPrintMsg(", ");
+        vDirectPrintNum(stats.dropped);
+        vDirectPrintMsg("\r\n");
+    }
+}
+
+
+/*
+ * Clears counters of published and dropped payloads.
+ */
+static void prvBusReset(void)
+{
+    busResetStats();
+    vDirectPrintMsg("Bus statistics cleared\r\n");
+}
+
+
+/* Table of all supported diagnostic commands */
+static const diagCommand commands[] =
+{
+#if configUSE_CRITICAL_STATS == 1
+    { "crit",           prvCritStats },
+    { "crit reset",     prvCritReset },
+#endif
+#if PIC_IRQ_STATS != 0
+    { "irq",            prvIrqStats },
+    { "irq reset",      prvIrqReset },
+    { "irq probe",      prvIrqProbe },
+#endif
+#if configUSE_TASK_STATS == 1
+    { "tasks",          prvTaskStats },
+    { "tasks reset",    prvTaskReset },
+#endif
+    { "periodic",       periodicPrint },
+    { "periodic reset", prvPeriodicReset },
+    { "print",          prvPrintStats },
+    { "print reset",    prvPrintReset },
+    { "pbuf",           prvPbufStats },
+    { "pbuf reset",     prvPbufReset },
+    { "bus",            prvBusStats },
+    { "bus reset",      prvBusReset },
+#if configUSE_STACK_STATS == 1
+    { "stacks",         prvStackStats },
+#endif
+    { NULL,             NULL }
+};
+
+
+/**
+ * Initializes diagnostics. Must be called before the scheduler is started.
+ *
+ * @return pdPASS if initialization is successful, pdFAIL otherwise
+ */
+int16_t diagInit(void)
+{
+#if PIC_IRQ_STATS != 0
+    /* Start the free running counter unless it is already running */
+    if ( timebase_init(APP_FREE_RUNNING_TIMER, APP_FREE_RUNNING_COUNTER) < 0 )
+    {
+        return pdFAIL;
+    }
+
+    pic_enableStats(timer_getValueAddr(APP_FREE_RUNNING_TIMER, APP_FREE_RUNNING_COUNTER));
+
+    /* The software generated interrupt is used to probe the entry latency */
+    if ( pic_registerIrq(BSP_SOFTWARE_IRQ, &prvProbeIsr,
+                          DIAG_PROBE_IRQ_PRIORITY, PIC_NO_BUDGET) < 0 )
+    {
+        return pdFAIL;
+    }
+
+    pic_enableInterrupt(BSP_SOFTWARE_IRQ);
+#endif
+
+    return pdPASS;
+}
+
+
+/*
+ * @param str1 - first string
+ * @param str2 - second string
+ *
+ * @return pdTRUE if both strings are equal, pdFALSE otherwise
+ */
+static int16_t prvStrEqual(const portCHAR* str1, const portCHAR* str2)
+{
+    while ( '\0' != *str1 && *str1 == *str2 )
+    {
+        ++str1;
+        ++str2;
+    }
+
+    return ( *str1 == *str2 ? pdTRUE : pdFALSE );
+}
+
+
+/**
+ * Executes a diagnostic command if 'line' matches any of them.
+ *
+ * @param line - a line of text as entered by a user
+ *
+ * @return pdTRUE if 'line' has been recognized as a diagnostic command, pdFALSE otherwise
+ */
+int16_t diagExecCommand(const portCHAR* line)
+{
+    uint16_t i;
+
+    if ( NULL == line )
+    {
+        return pdFALSE;
+    }
+
+    for ( i=0; NULL!=commands[i].name; ++i )
+    {
+        if ( pdTRUE == prvStrEqual(line, commands[i].name) )
+        {
+            ( *commands[i].func )();
+            return pdTRUE;
+        }
+    }
+
+    return pdFALSE;
+}
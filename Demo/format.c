@@ -0,0 +1,390 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * Implementation of a small subset of snprintf().
+ *
+ * Supported conversions are %d, %i, %u, %x, %X, %p, %c, %s and %%,
+ * optionally preceded by flags '-' (left justification) and/or '0'
+ * (padding with zeros), a field width and a length modifier 'l',
+ * that is ignored as all integers are 32-bit.
+ *
+ * Nothing is allocated and all state is kept on the caller's stack,
+ * so the functions are reentrant and may also be called from ISRs.
+ * The ARM926EJ-S has no division instruction, hence decimal digits
+ * are obtained by shifts and additions only, without any call to
+ * a division routine.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#include "format.h"
+
+
+/* Enough characters for any 32-bit integer in decimal notation */
+#define FORMAT_DIGITS_LEN       ( 10 )
+
+/* Flags of a conversion specification */
+#define FORMAT_FLAG_LEFT        ( 0x01 )
+#define FORMAT_FLAG_ZERO        ( 0x02 )
+
+
+/* Destination of formatted characters */
+typedef struct _formatOut
+{
+    char* buf;           /* caller's buffer */
+    size_t size;         /* size of 'buf' including the terminating '\0' */
+    size_t len;          /* number of characters written so far */
+} formatOut;
+
+
+/*
+ * Appends a character unless the buffer is full
+ * (the last position is reserved for '\0').
+ */
+static void formatPut(formatOut* out, char ch)
+{
+    if ( out->len + 1 < out->size )
+    {
+        out->buf[out->len++] = ch;
+    }
+}
+
+
+/*
+ * Divides 'num' by 10 by shifts and additions.
+ * The quotient is approximated from below as num * 0.8 / 8
+ * and corrected by the remainder.
+ *
+ * @param num - dividend
+ * @param rem - the remainder is written here
+ *
+ * @return quotient
+ */
+static uint32_t formatDiv10(uint32_t num, uint32_t* rem)
+{
+    uint32_t q;
+    uint32_t r;
+
+    q = (num >> 1) + (num >> 2);
+    q += (q >> 4);
+    q += (q >> 8);
+    q += (q >> 16);
+    q >>= 3;
+
+    r = num - ( (q << 3) + (q << 1) );
+    if ( r > 9 )
+    {
+        ++q;
+        r -= 10;
+    }
+
+    *rem = r;
+    return q;
+}
+
+
+/*
+ * Appends a field, i.e. an optional sign or prefix and 'len' characters
+ * of 'str', justified within 'width' characters as requested by 'flags'.
+ */
+static void formatField(formatOut* out, const char* prefix, const char* str,
+                        size_t len, size_t width, uint8_t flags)
+{
+    size_t prefixLen = 0;
+    size_t pad;
+
+    while ( NULL != prefix && '\0' != prefix[prefixLen] )
+    {
+        ++prefixLen;
+    }
+
+    pad = ( width > len + prefixLen ? width - len - prefixLen : 0 );
+
+    if ( 0 == (flags & (FORMAT_FLAG_LEFT | FORMAT_FLAG_ZERO)) )
+    {
+        for ( ; pad > 0; --pad )
+        {
+            formatPut(out, ' ');
+        }
+    }
+
+    for ( ; prefixLen > 0; --prefixLen )
+    {
+        formatPut(out, *prefix++);
+    }
+
+    if ( 0 == (flags & FORMAT_FLAG_LEFT) )
+    {
+        /* Zeros are inserted between the sign (or prefix) and digits */
+        for ( ; pad > 0; --pad )
+        {
+            formatPut(out, '0');
+        }
+    }
+
+    for ( ; len > 0; --len )
+    {
+        formatPut(out, *str++);
+    }
+
+    for ( ; pad > 0; --pad )
+    {
+        formatPut(out, ' ');
+    }
+}
+
+
+/*
+ * Converts 'num' to decimal digits, stored at the end of 'digits'.
+ *
+ * @return pointer to the first digit
+ */
+static char* formatDecimal(char digits[FORMAT_DIGITS_LEN], uint32_t num)
+{
+    char* pos = digits + FORMAT_DIGITS_LEN;
+    uint32_t rem;
+
+    do
+    {
+        num = formatDiv10(num, &rem);
+        *--pos = (char) ( '0' + rem );
+    }
+    while ( 0 != num );
+
+    return pos;
+}
+
+
+/*
+ * Converts 'num' to hexadecimal digits, stored at the end of 'digits'.
+ *
+ * @return pointer to the first digit
+ */
+static char* formatHex(char digits[FORMAT_DIGITS_LEN], uint32_t num, char letterA)
+{
+    char* pos = digits + FORMAT_DIGITS_LEN;
+    uint8_t nibble;
+
+    do
+    {
+        nibble = (uint8_t) ( num & 0x0F );
+        *--pos = (char) ( nibble<10 ? '0' + nibble : letterA + nibble - 10 );
+        num >>= 4;
+    }
+    while ( 0 != num );
+
+    return pos;
+}
+
+
+/**
+ * Formats a string like vsnprintf(), see the description of this file
+ * for supported conversions. The output is truncated to 'size'-1 characters
+ * and always terminated by '\0' (unless 'size' equals 0).
+ *
+ * @param buf - buffer to store the formatted string to
+ * @param size - size of 'buf' in characters, including the terminating '\0'
+ * @param fmt - format string
+ * @param args - arguments of conversions
+ *
+ * @return number of characters stored to 'buf', excluding the terminating '\0'
+ */
+size_t formatStringV(char* buf, size_t size, const char* fmt, va_list args)
+{
+    formatOut out;
+    char digits[FORMAT_DIGITS_LEN];
+    const char* str;
+    const char* prefix;
+    size_t width;
+    size_t len;
+    uint8_t flags;
+    int32_t value;
+    char ch;
+
+    out.buf = buf;
+    out.size = size;
+    out.len = 0;
+
+    if ( NULL == buf || 0 == size )
+    {
+        return 0;
+    }
+
+    if ( NULL == fmt )
+    {
+        fmt = "";
+    }
+
+    while ( '\0' != (ch = *fmt++) )
+    {
+        if ( '%' != ch )
+        {
+            formatPut(&out, ch);
+            continue;  /* with the next character */
+        }
+
+        /* Flags */
+        flags = 0;
+        for ( ; ; ++fmt )
+        {
+            if ( '-' == *fmt )
+            {
+                flags |= FORMAT_FLAG_LEFT;
+            }
+            else if ( '0' == *fmt )
+            {
+                flags |= FORMAT_FLAG_ZERO;
+            }
+            else
+            {
+                break;  /* out of for */
+            }
+        }
+
+        /* Field width, multiplied by 10 as (8 + 2) */
+        width = 0;
+        while ( *fmt >= '0' && *fmt <= '9' )
+        {
+            width = (width << 3) + (width << 1) + (size_t) (*fmt++ - '0');
+        }
+
+        /* All integers are 32-bit */
+        if ( 'l' == *fmt )
+        {
+            ++fmt;
+        }
+
+        prefix = NULL;
+
+        switch ( (ch = *fmt++) )
+        {
+            case 'd' :
+            case 'i' :
+            {
+                value = va_arg(args, int32_t);
+                if ( value < 0 )
+                {
+                    prefix = "-";
+                    str = formatDecimal(digits, 0UL - (uint32_t) value);
+                }
+                else
+                {
+                    str = formatDecimal(digits, (uint32_t) value);
+                }
+                break;
+            }
+
+            case 'u' :
+            {
+                str = formatDecimal(digits, va_arg(args, uint32_t));
+                break;
+            }
+
+            case 'x' :
+            case 'X' :
+            {
+                str = formatHex(digits, va_arg(args, uint32_t), ( 'x'==ch ? 'a' : 'A' ));
+                break;
+            }
+
+            case 'p' :
+            {
+                /* Pointers are printed with all 8 digits */
+                prefix = "0x";
+                str = formatHex(digits, (uint32_t) (uintptr_t) va_arg(args, void*), 'A');
+                flags = (flags & FORMAT_FLAG_LEFT) | FORMAT_FLAG_ZERO;
+                width = 10;
+                break;
+            }
+
+            case 'c' :
+            {
+                digits[0] = (char) va_arg(args, int);
+                formatField(&out, NULL, digits, 1, width, flags & FORMAT_FLAG_LEFT);
+                continue;  /* with the next character */
+            }
+
+            case 's' :
+            {
+                str = va_arg(args, const char*);
+                if ( NULL == str )
+                {
+                    str = "(null)";
+                }
+
+                for ( len=0; '\0' != str[len]; ++len );
+
+                formatField(&out, NULL, str, len, width, flags & FORMAT_FLAG_LEFT);
+                continue;  /* with the next character */
+            }
+
+            case '%' :
+            {
+                formatPut(&out, '%');
+                continue;  /* with the next character */
+            }
+
+            default :
+            {
+                /* Invalid specification or end of the format string */
+                out.buf[out.len] = '\0';
+                return out.len;
+            }
+        }
+
+        formatField(&out, prefix, str, (size_t) (digits + FORMAT_DIGITS_LEN - str), width, flags);
+    }
+
+    out.buf[out.len] = '\0';
+
+    return out.len;
+}
+
+
+/**
+ * Formats a string like snprintf(), see formatStringV() for details.
+ *
+ * @param buf - buffer to store the formatted string to
+ * @param size - size of 'buf' in characters, including the terminating '\0'
+ * @param fmt - format string, followed by arguments of conversions
+ *
+ * @return number of characters stored to 'buf', excluding the terminating '\0'
+ */
+size_t formatString(char* buf, size_t size, const char* fmt, ...)
+{
+    va_list args;
+    size_t len;
+
+    va_start(args, fmt);
+    len = formatStringV(buf, size, fmt, args);
+    va_end(args);
+
+    return len;
+}
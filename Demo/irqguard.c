@@ -0,0 +1,156 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ * Implementation of a task that services throttled IRQs.
+ *
+ * When an IRQ exhausts its rate budget (see pic_registerIrq()), the PIC
+ * driver disables its line and wakes up this task. The task polls all throttled
+ * IRQs once per tick until the PIC driver reenables their lines. As polled
+ * invocations are charged against the same budgets, the CPU time, spent
+ * by an interrupt flood, remains bounded.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stddef.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "interrupt.h"
+#include "event_flags.h"
+
+#include "irqguard.h"
+#include "objects.h"
+
+
+/* Event flag, set by the throttle handler to wake up the polling task */
+#define GUARD_FLAG_THROTTLED       ( 0x00000001UL )
+
+
+/* Handle of the polling task, NULL until it has been created */
+static TaskHandle_t guardTaskHandle = NULL;
+
+/* Event flags of the polling task */
+static EventFlags_t guardFlags;
+
+
+/*
+ * Called by the PIC driver (from the IRQ context) when an IRQ is throttled.
+ * It wakes up the polling task.
+ */
+static void guardThrottleHandler(uint8_t irq)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    ( void ) irq;
+
+    if ( NULL != guardTaskHandle )
+    {
+        ulEventFlagsSetFromISR(&guardFlags, GUARD_FLAG_THROTTLED, &higherPriorityTaskWoken);
+    }
+
+    /* The whole context is saved on IRQ entry, so a switch is possible here */
+    if ( pdFALSE != higherPriorityTaskWoken )
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+
+/**
+ * Initializes the IRQ guard. This function must be called
+ * before the scheduler is started.
+ *
+ * @param priority - priority of the polling task
+ *
+ * @return pdPASS if initialization is successful, pdFAIL otherwise
+ */
+int16_t irqGuardInit(UBaseType_t priority)
+{
+    vEventFlagsInit(&guardFlags);
+
+    guardTaskHandle = objectsCreateTask(OBJ_TASK_IRQGUARD, irqGuardTask, NULL, priority);
+    if ( NULL == guardTaskHandle )
+    {
+        return pdFAIL;
+    }
+
+    pic_setThrottleHandler(&guardThrottleHandler);
+
+    return pdPASS;
+}
+
+
+/**
+ * Closes the current budget window of IRQs. It must be called on each tick,
+ * typically by vApplicationTickHook().
+ */
+void irqGuardTick(void)
+{
+    pic_newBudgetWindow();
+}
+
+
+/**
+ * A FreeRTOS task that services throttled IRQs by polling.
+ * The task is blocked until an IRQ is throttled, then it polls all
+ * throttled IRQs on each tick until none of them remains throttled.
+ *
+ * @param params - ignored
+ */
+void irqGuardTask(void* params)
+{
+    uint32_t throttled;
+    uint32_t mask;
+    uint8_t irq;
+
+    ( void ) params;
+
+    for ( ; ; )
+    {
+        /* The task is blocked until an IRQ is throttled */
+        ulEventFlagsWait(&guardFlags, GUARD_FLAG_THROTTLED, pdTRUE, pdFALSE, portMAX_DELAY);
+
+        while ( 0 != ( throttled = pic_getThrottledIrqs() ) )
+        {
+            for ( mask = throttled; 0 != mask; mask &= ~( 1UL << irq ) )
+            {
+                irq = (uint8_t) __builtin_ctz(mask);
+
+                /* Service the IRQ until it is not pending or its budget is exhausted */
+                while ( pic_pollIrq(irq) > 0 );
+            }
+
+            /*
+             * Wait for a new budget window. The polled ISRs must not switch the
+             * context (see pic_isrPolled()), so tasks they have woken up run now.
+             */
+            vTaskDelay(1);
+        }
+    }
+
+    /* if it ever breaks out of the infinite loop... */
+    vTaskDelete(NULL);
+}
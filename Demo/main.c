@@ -37,6 +37,16 @@
 #include "app_config.h"
 #include "print.h"
 #include "receive.h"
+#include "bench.h"
+#include "diag.h"
+#include "irqguard.h"
+#include "periodic.h"
+#include "objects.h"
+#include "pbuf.h"
+
+#if configUSE_TASK_STATS == 1
+#include "task_stats.h"
+#endif
 
 
 /*
@@ -50,6 +60,19 @@
 #pragma GCC diagnostic ignored "-Wmain"
 
 
+/*
+ * Tick hook, called by the kernel (from the IRQ context) on each tick.
+ */
+void vApplicationTickHook(void)
+{
+    /* Rate budgets of IRQs are accounted per tick */
+    irqGuardTick();
+
+    /* Ideal release times of periodic tasks are derived from ticks */
+    periodicTick();
+}
+
+
 /* Struct with settings for each task */
 typedef struct _paramStruct
 {
@@ -96,16 +119,16 @@ void vPeriodicTaskFunction(void* pvParameters)
     const portCHAR* taskName;
     UBaseType_t delay;
     paramStruct* params = (paramStruct*) pvParameters;
-    TickType_t lastWakeTime;
+    periodicTask periodic;
 
     taskName = ( NULL==params || NULL==params->text ? defaultText : params->text );
     delay = ( NULL==params ? defaultDelay : params->delay);
 
     /*
-     * This variable must be initialized once.
-     * Then it will be updated automatically by vTaskDelayUntil().
+     * The first release is the current tick. Latencies of all
+     * further releases are recorded (see the diagnostic command "periodic").
      */
-    lastWakeTime = xTaskGetTickCount();
+    periodicInit(&periodic, pcTaskGetName(NULL), delay / portTICK_RATE_MS);
 
     for( ; ; )
     {
@@ -118,7 +141,7 @@ void vPeriodicTaskFunction(void* pvParameters)
          * after the appropriate number of ticks), relative from the moment
          * it was last unblocked.
          */
-        vTaskDelayUntil( &lastWakeTime, delay / portTICK_RATE_MS );
+        periodicWait(&periodic);
     }
 
     /*
@@ -130,6 +153,12 @@ void vPeriodicTaskFunction(void* pvParameters)
 }
 
 
+#if configUSE_TASK_STATS == 1
+/* Execution and response times of both tasks (see the diagnostic command "tasks") */
+static TaskStats_t taskStats[2];
+#endif
+
+
 /* Parameters for two tasks */
 static const paramStruct tParam[2] =
 {
@@ -156,12 +185,19 @@ static void FreeRTOS_Error(const portCHAR* msg)
 /* Startup function that creates and runs two FreeRTOS tasks */
 void main(void)
 {
+    TaskHandle_t task[2];
+    TaskHandle_t gk;
+    TaskHandle_t recv;
+
     /* Init of print related tasks: */
     if ( pdFAIL == printInit(PRINT_UART_NR) )
     {
         FreeRTOS_Error("Initialization of print failed\r\n");
     }
 
+    /* Init of the pool of packet buffers: */
+    pbufInit();
+
     /*
      * I M P O R T A N T :
      * Make sure (in startup.s) that main is entered in Supervisor mode.
@@ -176,31 +212,102 @@ void main(void)
         FreeRTOS_Error("Initialization of receiver failed\r\n");
     }
 
+    /* Init of diagnostics: */
+    if ( pdFAIL == diagInit() )
+    {
+        FreeRTOS_Error("Initialization of diagnostics failed\r\n");
+    }
+
+    /* Init of the task that services throttled IRQs: */
+    if ( pdFAIL == irqGuardInit(PRIOR_IRQ_GUARD) )
+    {
+        FreeRTOS_Error("Initialization of IRQ guard failed\r\n");
+    }
+
     /* Create a print gate keeper task: */
-    if ( pdPASS != xTaskCreate(printGateKeeperTask, "gk", 128, NULL,
-                               PRIOR_PRINT_GATEKEEPR, NULL) )
+    gk = objectsCreateTask(OBJ_TASK_GK, printGateKeeperTask, NULL, PRIOR_PRINT_GATEKEEPR);
+    if ( NULL == gk )
     {
         FreeRTOS_Error("Could not create a print gate keeper task\r\n");
     }
 
-    if ( pdPASS != xTaskCreate(recvTask, "recv", 128, NULL, PRIOR_RECEIVER, NULL) )
+#if configUSE_PREEMPTION_THRESHOLD == 1
+    /* Producers of messages do not interrupt printing of a message */
+    vTaskSetPreemptionThreshold(gk, PRIOR_PRINT_GATEKEEPR_THRESHOLD);
+#else
+    ( void ) gk;
+#endif
+
+    recv = objectsCreateTask(OBJ_TASK_RECV, recvTask, NULL, PRIOR_RECEIVER);
+    if ( NULL == recv )
     {
         FreeRTOS_Error("Could not create a receiver task\r\n");
     }
 
+#if configUSE_TASK_BUDGET == 1
+    /* A flood of input may only delay other tasks for a limited time */
+    vTaskSetBudget(recv, RECV_BUDGET, RECV_BUDGET_PERIOD, PRIOR_RECEIVER_BACKGROUND);
+#else
+    ( void ) recv;
+#endif
+
     /* And finally create two tasks: */
-    if ( pdPASS != xTaskCreate(vTaskFunction, "task1", 128, (void*) &tParam[0],
-                               PRIOR_PERIODIC, NULL) )
+    task[0] = objectsCreateTask(OBJ_TASK_TASK1, vTaskFunction, (void*) &tParam[0], PRIOR_PERIODIC);
+    if ( NULL == task[0] )
     {
         FreeRTOS_Error("Could not create task1\r\n");
     }
 
-    if ( pdPASS != xTaskCreate(vPeriodicTaskFunction, "task2", 128, (void*) &tParam[1],
-                               PRIOR_FIX_FREQ_PERIODIC, NULL) )
+    task[1] = objectsCreateTask(OBJ_TASK_TASK2, vPeriodicTaskFunction, (void*) &tParam[1],
+                                PRIOR_FIX_FREQ_PERIODIC);
+    if ( NULL == task[1] )
     {
         FreeRTOS_Error("Could not create task2\r\n");
     }
 
+#if configUSE_TASK_STATS == 1
+    vPortTaskStatsRegister(task[0], &taskStats[0]);
+    vPortTaskStatsRegister(task[1], &taskStats[1]);
+#else
+    ( void ) task;
+#endif
+
+#if APP_BENCH_CRITICAL != 0
+    /* The benchmark task runs first and deletes itself when finished */
+    if ( NULL == objectsCreateTask(OBJ_TASK_BENCHCRIT, benchCriticalTask, NULL,
+                                   configMAX_PRIORITIES - 1) )
+    {
+        FreeRTOS_Error("Could not create a benchmark task\r\n");
+    }
+#endif
+
+#if APP_BENCH_EDF != 0
+    /* The benchmark task deletes itself when finished, its workers are suspended */
+    if ( NULL == objectsCreateTask(OBJ_TASK_BENCHEDF, benchEdfTask, NULL,
+                                   configMAX_PRIORITIES - 1) )
+    {
+        FreeRTOS_Error("Could not create a benchmark task\r\n");
+    }
+#endif
+
+#if APP_BENCH_IPC != 0
+    /* The benchmark task deletes its servers and itself when finished */
+    if ( NULL == objectsCreateTask(OBJ_TASK_BENCHIPC, benchIpcTask, NULL,
+                                   configMAX_PRIORITIES - 2) )
+    {
+        FreeRTOS_Error("Could not create a benchmark task\r\n");
+    }
+#endif
+
+#if APP_BENCH_MUTEX != 0
+    /* The benchmark task deletes its helper tasks and itself when finished */
+    if ( NULL == objectsCreateTask(OBJ_TASK_BENCHMTX, benchMutexTask, NULL,
+                                   configMAX_PRIORITIES - 2) )
+    {
+        FreeRTOS_Error("Could not create a benchmark task\r\n");
+    }
+#endif
+
     vDirectPrintMsg("A text may be entered using a keyboard.\r\n");
     vDirectPrintMsg("It will be displayed when 'Enter' is pressed.\r\n\r\n");
 
@@ -209,7 +316,8 @@ void main(void)
 
     /*
      * If all goes well, vTaskStartScheduler should never return.
-     * If it does return, typically not enough heap memory is reserved.
+     * All objects are allocated statically (see objects.h and
+     * vApplicationGetIdleTaskMemory in port.c), so no heap is involved.
      */
 
     FreeRTOS_Error("Could not start the scheduler!!!\r\n");
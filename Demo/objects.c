@@ -0,0 +1,181 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * Implementation of the application's object table (see objects.h).
+ *
+ * For each entry of the table, the X macros below expand to a control
+ * block and its storage (a stack, queue items or a stream buffer's
+ * storage area), all of them static,
+ * and to a case of the appropriate create function. A new object is
+ * thus added to the application by a single line in objects.h.
+ *
+ * Requires configSUPPORT_STATIC_ALLOCATION.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stddef.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <semphr.h>
+#include <stream_buffer.h>
+
+#include "objects.h"
+
+
+#if configSUPPORT_STATIC_ALLOCATION != 1
+#error objects.c requires configSUPPORT_STATIC_ALLOCATION
+#endif
+
+
+/* Control blocks and storage of all objects, reserved in .bss */
+
+#define OBJECTS_TASK_STORAGE(id, name, depth) \
+    static StaticTask_t taskTcb_##id; \
+    static StackType_t taskStack_##id[depth];
+
+#define OBJECTS_QUEUE_STORAGE(id, length, size) \
+    static StaticQueue_t queueBuf_##id; \
+    static uint8_t queueStorage_##id[(length) * (size)];
+
+#define OBJECTS_SEMAPHORE_STORAGE(id, create) \
+    static StaticSemaphore_t semaphoreBuf_##id;
+
+/* The storage area of a stream buffer requires an additional byte */
+#define OBJECTS_STREAM_STORAGE(id, size, trigger) \
+    static StaticStreamBuffer_t streamBuf_##id; \
+    static uint8_t streamStorage_##id[(size) + 1];
+
+OBJECTS_TASKS(OBJECTS_TASK_STORAGE)
+OBJECTS_QUEUES(OBJECTS_QUEUE_STORAGE)
+OBJECTS_SEMAPHORES(OBJECTS_SEMAPHORE_STORAGE)
+OBJECTS_STREAM_BUFFERS(OBJECTS_STREAM_STORAGE)
+
+
+/* Cases of create functions */
+
+#define OBJECTS_TASK_CASE(id, name, depth) \
+    case OBJ_TASK_##id: \
+        return xTaskCreateStatic(function, name, depth, params, priority, \
+                                 taskStack_##id, &taskTcb_##id);
+
+#define OBJECTS_QUEUE_CASE(id, length, size) \
+    case OBJ_QUEUE_##id: \
+        return xQueueCreateStatic(length, size, queueStorage_##id, &queueBuf_##id);
+
+#define OBJECTS_SEMAPHORE_CASE(id, create) \
+    case OBJ_SEMAPHORE_##id: \
+        return create(&semaphoreBuf_##id);
+
+#define OBJECTS_STREAM_CASE(id, size, trigger) \
+    case OBJ_STREAM_##id: \
+        return xStreamBufferCreateStatic(size, trigger, streamStorage_##id, &streamBuf_##id);
+
+
+/**
+ * Creates a task from the object table.
+ * Each task of the table may only be created once.
+ *
+ * @param id - identifier of the task in the table
+ * @param function - task's function
+ * @param params - parameter passed to the task's function
+ * @param priority - priority of the task
+ *
+ * @return handle of the created task or NULL if 'id' is invalid
+ */
+TaskHandle_t objectsCreateTask(objectsTaskId id, TaskFunction_t function,
+                               void* params, UBaseType_t priority)
+{
+    switch (id)
+    {
+        OBJECTS_TASKS(OBJECTS_TASK_CASE)
+
+        default:
+            return NULL;
+    }
+}
+
+
+/**
+ * Creates a queue from the object table.
+ * Each queue of the table may only be created once.
+ *
+ * @param id - identifier of the queue in the table
+ *
+ * @return handle of the created queue or NULL if 'id' is invalid
+ */
+QueueHandle_t objectsCreateQueue(objectsQueueId id)
+{
+    switch (id)
+    {
+        OBJECTS_QUEUES(OBJECTS_QUEUE_CASE)
+
+        default:
+            return NULL;
+    }
+}
+
+
+/**
+ * Creates a semaphore (or a mutex) from the object table.
+ * Each semaphore of the table may only be created once.
+ *
+ * @param id - identifier of the semaphore in the table
+ *
+ * @return handle of the created semaphore or NULL if 'id' is invalid
+ */
+SemaphoreHandle_t objectsCreateSemaphore(objectsSemaphoreId id)
+{
+    switch (id)
+    {
+        OBJECTS_SEMAPHORES(OBJECTS_SEMAPHORE_CASE)
+
+        default:
+            return NULL;
+    }
+}
+
+
+/**
+ * Creates a stream buffer from the object table.
+ * Each stream buffer of the table may only be created once.
+ *
+ * @param id - identifier of the stream buffer in the table
+ *
+ * @return handle of the created stream buffer or NULL if 'id' is invalid
+ */
+StreamBufferHandle_t objectsCreateStreamBuffer(objectsStreamBufferId id)
+{
+    switch (id)
+    {
+        OBJECTS_STREAM_BUFFERS(OBJECTS_STREAM_CASE)
+
+        default:
+            return NULL;
+    }
+}
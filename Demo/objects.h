@@ -0,0 +1,177 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * Declarative table of all kernel objects (tasks, queues, semaphores and
+ * stream buffers)
+ * created by the application. Storage of each object is reserved
+ * statically (in .bss) by objects.c, so no heap is necessary and
+ * the memory footprint is known at link time.
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _OBJECTS_H_
+#define _OBJECTS_H_
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+#include <semphr.h>
+#include <stream_buffer.h>
+
+#include "app_config.h"
+
+
+/*
+ * Benchmark tasks and their objects are only reserved
+ * when the appropriate benchmark is enabled.
+ */
+#if APP_BENCH_CRITICAL != 0
+#define OBJECTS_BENCH_CRIT_TASKS(X) \
+    X( BENCHCRIT,  "benchcrit",  256 )
+#define OBJECTS_BENCH_CRIT_QUEUES(X) \
+    X( BENCHCRIT,  1,                 sizeof(uint32_t) )
+#else
+#define OBJECTS_BENCH_CRIT_TASKS(X)
+#define OBJECTS_BENCH_CRIT_QUEUES(X)
+#endif
+
+#if APP_BENCH_EDF != 0
+#define OBJECTS_BENCH_EDF_TASKS(X) \
+    X( BENCHEDF,   "benchedf",   256 ) \
+    X( EDFWORK0,   "edfwork",    128 ) \
+    X( EDFWORK1,   "edfwork",    128 ) \
+    X( EDFWORK2,   "edfwork",    128 )
+#else
+#define OBJECTS_BENCH_EDF_TASKS(X)
+#endif
+
+#if APP_BENCH_IPC != 0
+#define OBJECTS_BENCH_IPC_TASKS(X) \
+    X( BENCHIPC,   "benchipc",   256 ) \
+    X( IPCQSRV,    "ipcqsrv",    128 ) \
+    X( IPCSRV,     "ipcsrv",     128 )
+#define OBJECTS_BENCH_IPC_QUEUES(X) \
+    X( BENCHIPC_REQUEST,  1,                 BENCH_IPC_MSG_LEN ) \
+    X( BENCHIPC_REPLY,    1,                 BENCH_IPC_MSG_LEN )
+#else
+#define OBJECTS_BENCH_IPC_TASKS(X)
+#define OBJECTS_BENCH_IPC_QUEUES(X)
+#endif
+
+#if APP_BENCH_MUTEX != 0
+#define OBJECTS_BENCH_MUTEX_TASKS(X) \
+    X( BENCHMTX,   "benchmtx",   256 ) \
+    X( MTXLOW,     "mtxlow",     128 ) \
+    X( MTXMED,     "mtxmed",     128 )
+#define OBJECTS_BENCH_MUTEX_SEMAPHORES(X) \
+    X( BENCHBIN,   xSemaphoreCreateBinaryStatic ) \
+    X( BENCHMTX,   xSemaphoreCreateMutexStatic ) \
+    X( BENCHRMTX,  xSemaphoreCreateRecursiveMutexStatic )
+#else
+#define OBJECTS_BENCH_MUTEX_TASKS(X)
+#define OBJECTS_BENCH_MUTEX_SEMAPHORES(X)
+#endif
+
+
+/*
+ * Tasks: X( id, name, stack depth in words )
+ * Note: workers of a benchmark must be listed consecutively.
+ */
+#define OBJECTS_TASKS(X) \
+    X( GK,         "gk",         128 ) \
+    X( RECV,       "recv",       192 ) \
+    X( TASK1,      "task1",      128 ) \
+    X( TASK2,      "task2",      256 ) \
+    X( IRQGUARD,   "irqguard",   160 ) \
+    OBJECTS_BENCH_CRIT_TASKS(X) \
+    OBJECTS_BENCH_EDF_TASKS(X) \
+    OBJECTS_BENCH_IPC_TASKS(X) \
+    OBJECTS_BENCH_MUTEX_TASKS(X)
+
+/* Queues: X( id, length, size of an item ) */
+#define OBJECTS_QUEUES(X) \
+    X( PRINT_URGENT,      PRINT_QUEUE_SIZE_URGENT,      sizeof(portCHAR*) ) \
+    X( PRINT_NORMAL,      PRINT_QUEUE_SIZE_NORMAL,      sizeof(portCHAR*) ) \
+    X( PRINT_BACKGROUND,  PRINT_QUEUE_SIZE_BACKGROUND,  sizeof(portCHAR*) ) \
+    OBJECTS_BENCH_CRIT_QUEUES(X) \
+    OBJECTS_BENCH_IPC_QUEUES(X)
+
+/*
+ * Semaphores: X( id, static create macro from semphr.h ),
+ * e.g. xSemaphoreCreateBinaryStatic or xSemaphoreCreateMutexStatic
+ */
+#define OBJECTS_SEMAPHORES(X) \
+    X( PRINT,      xSemaphoreCreateBinaryStatic ) \
+    OBJECTS_BENCH_MUTEX_SEMAPHORES(X)
+
+/* Stream buffers: X( id, size in bytes, trigger level in bytes ) */
+#define OBJECTS_STREAM_BUFFERS(X) \
+    X( RECV,       RECV_STREAM_SIZE, RECV_TRIGGER_LEVEL )
+
+
+/* Identifiers of objects, e.g. OBJ_TASK_GK or OBJ_QUEUE_PRINT */
+#define OBJECTS_TASK_ID(id, name, depth)        OBJ_TASK_##id,
+#define OBJECTS_QUEUE_ID(id, length, size)      OBJ_QUEUE_##id,
+#define OBJECTS_SEMAPHORE_ID(id, create)        OBJ_SEMAPHORE_##id,
+#define OBJECTS_STREAM_ID(id, size, trigger)    OBJ_STREAM_##id,
+
+typedef enum _objectsTaskId
+{
+    OBJECTS_TASKS(OBJECTS_TASK_ID)
+    OBJ_TASK_COUNT
+} objectsTaskId;
+
+typedef enum _objectsQueueId
+{
+    OBJECTS_QUEUES(OBJECTS_QUEUE_ID)
+    OBJ_QUEUE_COUNT
+} objectsQueueId;
+
+typedef enum _objectsSemaphoreId
+{
+    OBJECTS_SEMAPHORES(OBJECTS_SEMAPHORE_ID)
+    OBJ_SEMAPHORE_COUNT
+} objectsSemaphoreId;
+
+typedef enum _objectsStreamBufferId
+{
+    OBJECTS_STREAM_BUFFERS(OBJECTS_STREAM_ID)
+    OBJ_STREAM_COUNT
+} objectsStreamBufferId;
+
+
+TaskHandle_t objectsCreateTask(objectsTaskId id, TaskFunction_t function,
+                               void* params, UBaseType_t priority);
+
+QueueHandle_t objectsCreateQueue(objectsQueueId id);
+
+SemaphoreHandle_t objectsCreateSemaphore(objectsSemaphoreId id);
+
+StreamBufferHandle_t objectsCreateStreamBuffer(objectsStreamBufferId id);
+
+
+#endif  /* _OBJECTS_H_ */
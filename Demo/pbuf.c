@@ -0,0 +1,526 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * Implementation of reference counted packet buffers (pbufs).
+ *
+ * Buffers of a fixed size are taken from a statically allocated pool.
+ * Only pointers to them are passed between tasks via queues (items of
+ * size sizeof(pbuf*)), so a packet is never copied on its way. A packet
+ * may be passed to several consumers at once (see pbufFanOut()), each
+ * of them holds its own reference and frees it when done. The buffer
+ * returns to the pool when its last reference has been freed.
+ *
+ * The ARM926EJ-S (ARMv5) has no exclusive load/store instructions,
+ * hence reference counts and the pool are updated with IRQs disabled:
+ * in critical sections by tasks or by "FromISR" functions that
+ * may only be called when IRQs are already disabled (e.g. in ISRs).
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <queue.h>
+
+#include "app_config.h"
+#include "pbuf.h"
+
+
+/* The pool of buffers, its size has been defined in "app_config.h" */
+static pbuf pbufPool[ PBUF_POOL_SIZE ];
+
+/* Available buffers, linked by 'next' */
+static pbuf* pbufFreeList = NULL;
+
+/* Statistics of the pool */
+static pbufStats pbufPoolStats;
+
+
+
+/**
+ * Links all buffers into the list of available buffers.
+ * Must be called before any buffer is allocated.
+ */
+void pbufInit(void)
+{
+    uint16_t i;
+
+    pbufFreeList = NULL;
+
+    for ( i=0; i<PBUF_POOL_SIZE; ++i )
+    {
+        pbufPool[i].ref = 0;
+        pbufPool[i].next = pbufFreeList;
+        pbufFreeList = &pbufPool[i];
+    }
+
+    pbufPoolStats.available = PBUF_POOL_SIZE;
+    pbufPoolStats.minAvailable = PBUF_POOL_SIZE;
+    pbufPoolStats.failures = 0;
+}
+
+
+/**
+ * Allocates a buffer with one reference and no payload.
+ *
+ * @note IRQs are expected to be disabled, as it is the case in ISRs.
+ *
+ * @param reserve - number of bytes reserved in front of the payload for headers
+ *
+ * @return pointer to the buffer or NULL if none is available or 'reserve' is too large
+ */
+pbuf* pbufAllocFromISR(uint16_t reserve)
+{
+    pbuf* p = pbufFreeList;
+
+    if ( NULL == p || reserve > PBUF_SIZE )
+    {
+        ++pbufPoolStats.failures;
+        return NULL;
+    }
+
+    pbufFreeList = p->next;
+
+    if ( --pbufPoolStats.available < pbufPoolStats.minAvailable )
+    {
+        pbufPoolStats.minAvailable = pbufPoolStats.available;
+    }
+
+    p->next = NULL;
+    p->payload = p->data + reserve;
+    p->len = 0;
+    p->totLen = 0;
+    p->ref = 1;
+
+    return p;
+}
+
+
+/**
+ * Allocates a buffer with one reference and no payload.
+ *
+ * @param reserve - number of bytes reserved in front of the payload for headers
+ *
+ * @return pointer to the buffer or NULL if none is available or 'reserve' is too large
+ */
+pbuf* pbufAlloc(uint16_t reserve)
+{
+    pbuf* p;
+
+    taskENTER_CRITICAL();
+    {
+        p = pbufAllocFromISR(reserve);
+    }
+    taskEXIT_CRITICAL();
+
+    return p;
+}
+
+
+/**
+ * Adds a reference to a buffer (but not to the buffers, chained to it).
+ *
+ * @note IRQs are expected to be disabled, as it is the case in ISRs.
+ *
+ * @param p - buffer to add a reference to
+ */
+void pbufRefFromISR(pbuf* p)
+{
+    if ( NULL != p )
+    {
+        ++p->ref;
+    }
+}
+
+
+/**
+ * Adds a reference to a buffer (but not to the buffers, chained to it).
+ *
+ * @param p - buffer to add a reference to
+ */
+void pbufRef(pbuf* p)
+{
+    taskENTER_CRITICAL();
+    {
+        pbufRefFromISR(p);
+    }
+    taskEXIT_CRITICAL();
+}
+
+
+/**
+ * Frees a reference to a buffer. When the last reference is freed,
+ * the buffer returns to the pool and a reference to the next buffer
+ * of the chain is freed as well.
+ *
+ * @note IRQs are expected to be disabled, as it is the case in ISRs.
+ *
+ * @param p - buffer to free a reference of
+ */
+void pbufFreeFromISR(pbuf* p)
+{
+    pbuf* next;
+
+    while ( NULL != p && 0 != p->ref )
+    {
+        if ( 0 != --p->ref )
+        {
+            break;  /* out of while, the buffer is still referenced */
+        }
+
+        next = p->next;
+        p->next = pbufFreeList;
+        pbufFreeList = p;
+        ++pbufPoolStats.available;
+
+        p = next;
+    }
+}
+
+
+/**
+ * Frees a reference to a buffer. When the last reference is freed,
+ * the buffer returns to the pool and a reference to the next buffer
+ * of the chain is freed as well.
+ *
+ * @param p - buffer to free a reference of
+ */
+void pbufFree(pbuf* p)
+{
+    taskENTER_CRITICAL();
+    {
+        pbufFreeFromISR(p);
+    }
+    taskEXIT_CRITICAL();
+}
+
+
+/**
+ * Appends 'tail' (and buffers, chained to it) to the end of the chain
+ * of 'head'. The caller's reference to 'tail' is taken over by the chain.
+ *
+ * @param head - first buffer of a chain
+ * @param tail - first buffer of the chain to be appended
+ */
+void pbufChain(pbuf* head, pbuf* tail)
+{
+    pbuf* p;
+
+    if ( NULL == head || NULL == tail )
+    {
+        return;
+    }
+
+    for ( p=head; NULL!=p->next; p=p->next )
+    {
+        p->totLen += tail->totLen;
+    }
+
+    p->totLen += tail->totLen;
+    p->next = tail;
+}
+
+
+/**
+ * Moves the start of the payload by 'delta' bytes. A positive 'delta'
+ * prepends a header (into the space reserved by pbufAlloc()), a negative
+ * one removes a header. Nothing is copied.
+ *
+ * @param p - buffer to be modified (the first one of a chain)
+ * @param delta - number of bytes to prepend (if positive) or remove (if negative)
+ *
+ * @return pdPASS on success, pdFAIL if there is not enough room or payload
+ */
+int16_t pbufHeader(pbuf* p, int16_t delta)
+{
+    if ( NULL == p )
+    {
+        return pdFAIL;
+    }
+
+    if ( delta >= 0 )
+    {
+        if ( (uint16_t) delta > (uint16_t) ( p->payload - p->data ) )
+        {
+            return pdFAIL;
+        }
+    }
+    else if ( (uint16_t) -delta > p->len )
+    {
+        return pdFAIL;
+    }
+
+    p->payload -= delta;
+    p->len = (uint16_t) ( p->len + delta );
+    p->totLen = (uint16_t) ( p->totLen + delta );
+
+    return pdPASS;
+}
+
+
+/**
+ * Shortens a packet to 'totLen' bytes. References to buffers
+ * that are not necessary anymore are freed.
+ *
+ * Nothing is done if the packet is not longer than 'totLen'.
+ *
+ * @param p - first buffer of the packet
+ * @param totLen - new length of the packet
+ */
+void pbufTrim(pbuf* p, uint16_t totLen)
+{
+    pbuf* rest;
+
+    if ( NULL == p || totLen >= p->totLen )
+    {
+        return;
+    }
+
+    /* Skip buffers that are kept entirely */
+    while ( totLen > p->len )
+    {
+        p->totLen = totLen;
+        totLen = (uint16_t) ( totLen - p->len );
+        p = p->next;
+    }
+
+    p->len = totLen;
+    p->totLen = totLen;
+
+    rest = p->next;
+    p->next = NULL;
+    pbufFree(rest);
+}
+
+
+/**
+ * Copies data to the end of the payload of the last buffer of a chain,
+ * as much as fits into it. If necessary, the caller may allocate and
+ * chain another buffer and append the remaining data.
+ *
+ * @param p - first buffer of a chain
+ * @param src - data to be appended
+ * @param len - number of bytes to be appended
+ *
+ * @return number of bytes actually appended
+ */
+uint16_t pbufAppend(pbuf* p, const void* src, uint16_t len)
+{
+    pbuf* last;
+    uint16_t room;
+
+    if ( NULL == p || NULL == src )
+    {
+        return 0;
+    }
+
+    for ( last=p; NULL!=last->next; last=last->next );
+
+    room = (uint16_t) ( last->data + PBUF_SIZE - (last->payload + last->len) );
+    if ( len > room )
+    {
+        len = room;
+    }
+
+    memcpy(last->payload + last->len, src, len);
+    last->len = (uint16_t) ( last->len + len );
+
+    for ( ; p!=last; p=p->next )
+    {
+        p->totLen = (uint16_t) ( p->totLen + len );
+    }
+
+    last->totLen = (uint16_t) ( last->totLen + len );
+
+    return len;
+}
+
+
+/**
+ * Gathers payloads of a chain into a contiguous buffer.
+ *
+ * @param p - first buffer of a chain
+ * @param offset - number of bytes of the packet to be skipped
+ * @param dst - buffer to copy the payload to
+ * @param len - maximum number of bytes to be copied
+ *
+ * @return number of bytes actually copied
+ */
+uint16_t pbufCopy(const pbuf* p, uint16_t offset, void* dst, uint16_t len)
+{
+    uint8_t* d = (uint8_t*) dst;
+    uint16_t copied = 0;
+    uint16_t n;
+
+    if ( NULL == dst )
+    {
+        return 0;
+    }
+
+    for ( ; NULL!=p && copied<len; p=p->next )
+    {
+        if ( offset >= p->len )
+        {
+            offset = (uint16_t) ( offset - p->len );
+            continue;  /* with the next buffer */
+        }
+
+        n = (uint16_t) ( p->len - offset );
+        if ( n > len - copied )
+        {
+            n = (uint16_t) ( len - copied );
+        }
+
+        memcpy(d + copied, p->payload + offset, n);
+        copied = (uint16_t) ( copied + n );
+        offset = 0;
+    }
+
+    return copied;
+}
+
+
+/**
+ * Passes a packet to a queue. On success, the caller's reference
+ * is taken over by the receiver, otherwise the caller still owns it.
+ *
+ * @param queue - queue with items of size sizeof(pbuf*)
+ * @param p - first buffer of the packet
+ * @param ticksToWait - maximum number of ticks to wait for space in the queue
+ *
+ * @return pdPASS if the packet has been queued, pdFAIL otherwise
+ */
+BaseType_t pbufSend(QueueHandle_t queue, pbuf* p, TickType_t ticksToWait)
+{
+    if ( NULL == p )
+    {
+        return pdFAIL;
+    }
+
+    return xQueueSendToBack(queue, (void*) &p, ticksToWait);
+}
+
+
+/**
+ * Passes a packet to several queues without copying it. Each successful
+ * receiver gets its own reference to the packet and must free it.
+ * The caller keeps its reference in any case.
+ *
+ * @param queues - array of queues with items of size sizeof(pbuf*)
+ * @param nr - number of queues in 'queues'
+ * @param p - first buffer of the packet
+ * @param ticksToWait - maximum number of ticks to wait for space in each queue
+ *
+ * @return number of queues the packet has been passed to
+ */
+uint8_t pbufFanOut(const QueueHandle_t* queues, uint8_t nr, pbuf* p, TickType_t ticksToWait)
+{
+    uint8_t delivered = 0;
+    uint8_t i;
+
+    if ( NULL == queues || NULL == p )
+    {
+        return 0;
+    }
+
+    for ( i=0; i<nr; ++i )
+    {
+        /* The reference must exist before the receiver may free it */
+        pbufRef(p);
+
+        if ( pdPASS == pbufSend(queues[i], p, ticksToWait) )
+        {
+            ++delivered;
+        }
+        else
+        {
+            pbufFree(p);
+        }
+    }
+
+    return delivered;
+}
+
+
+/**
+ * Receives a packet from a queue. The caller becomes
+ * the owner of its reference and must free it.
+ *
+ * @param queue - queue with items of size sizeof(pbuf*)
+ * @param ticksToWait - maximum number of ticks to wait for a packet
+ *
+ * @return pointer to the first buffer of the packet or NULL if nothing has been received
+ */
+pbuf* pbufReceive(QueueHandle_t queue, TickType_t ticksToWait)
+{
+    pbuf* p;
+
+    if ( pdPASS != xQueueReceive(queue, (void*) &p, ticksToWait) )
+    {
+        return NULL;
+    }
+
+    return p;
+}
+
+
+/**
+ * Copies statistics of the pool.
+ *
+ * @param stats - statistics are written here
+ */
+void pbufGetStats(pbufStats* stats)
+{
+    if ( NULL == stats )
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    {
+        *stats = pbufPoolStats;
+    }
+    taskEXIT_CRITICAL();
+}
+
+
+/**
+ * Clears the number of failed allocations and sets the least
+ * number of available buffers to the current number.
+ */
+void pbufResetStats(void)
+{
+    taskENTER_CRITICAL();
+    {
+        pbufPoolStats.minAvailable = pbufPoolStats.available;
+        pbufPoolStats.failures = 0;
+    }
+    taskEXIT_CRITICAL();
+}
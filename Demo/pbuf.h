@@ -0,0 +1,103 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ * Declaration of reference counted packet buffers (pbufs).
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _PBUF_H_
+#define _PBUF_H_
+
+#include <stdint.h>
+
+#include <FreeRTOS.h>
+#include <queue.h>
+
+#include "app_config.h"
+
+
+/*
+ * A packet buffer. Its payload starts somewhere within 'data', so that
+ * headers may be prepended without copying (see pbufHeader()).
+ * Buffers may be chained into a packet, its total length is stored
+ * in the first buffer of the chain.
+ */
+typedef struct _pbuf
+{
+    struct _pbuf* next;              /* next buffer of the chain or NULL */
+    uint8_t* payload;                /* first valid byte of this buffer */
+    uint16_t len;                    /* number of valid bytes in this buffer */
+    uint16_t totLen;                 /* 'len' of this and all following buffers */
+    volatile uint8_t ref;            /* number of references, 0 if available */
+    uint8_t data[PBUF_SIZE];
+} pbuf;
+
+/* Statistics of the pool */
+typedef struct _pbufStats
+{
+    uint16_t available;              /* currently available buffers */
+    uint16_t minAvailable;           /* the least number of available buffers */
+    uint32_t failures;               /* number of failed allocations */
+} pbufStats;
+
+
+void pbufInit(void);
+
+pbuf* pbufAlloc(uint16_t reserve);
+
+pbuf* pbufAllocFromISR(uint16_t reserve);
+
+void pbufRef(pbuf* p);
+
+void pbufRefFromISR(pbuf* p);
+
+void pbufFree(pbuf* p);
+
+void pbufFreeFromISR(pbuf* p);
+
+void pbufChain(pbuf* head, pbuf* tail);
+
+int16_t pbufHeader(pbuf* p, int16_t delta);
+
+void pbufTrim(pbuf* p, uint16_t totLen);
+
+uint16_t pbufAppend(pbuf* p, const void* src, uint16_t len);
+
+uint16_t pbufCopy(const pbuf* p, uint16_t offset, void* dst, uint16_t len);
+
+BaseType_t pbufSend(QueueHandle_t queue, pbuf* p, TickType_t ticksToWait);
+
+uint8_t pbufFanOut(const QueueHandle_t* queues, uint8_t nr, pbuf* p, TickType_t ticksToWait);
+
+pbuf* pbufReceive(QueueHandle_t queue, TickType_t ticksToWait);
+
+void pbufGetStats(pbufStats* stats);
+
+void pbufResetStats(void);
+
+
+#endif  /* _PBUF_H_ */
@@ -0,0 +1,274 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file
+ * Implementation of a helper for fixed frequency periodic tasks.
+ *
+ * A periodic task calls periodicInit() once and then periodicWait() at the
+ * end of each activation instead of vTaskDelayUntil(). Each release
+ * is timestamped by the time base (see timebase.h) and compared to its
+ * ideal release time, i.e. the moment when the tick timer triggered
+ * the release tick. The difference (the release latency) includes the
+ * IRQ entry latency, the kernel's tick processing and the time the task
+ * waited for higher priority tasks.
+ *
+ * For each periodic task, a histogram of latencies, the maximum latency
+ * and the number of deadline overruns (activations that did not complete
+ * before the next release) are recorded.
+ *
+ * The tick hook (see main.c) must call periodicTick().
+ *
+ * The timestamp of the latest tick is shared with the tick hook via a
+ * sequence lock (see seqlock.h), so tasks read it without disabling IRQs
+ * and the tick is never delayed by a periodic task's release.
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stddef.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+
+#include "app_config.h"
+#include "timer.h"
+#include "timebase.h"
+
+#include "print.h"
+#include "periodic.h"
+#include "seqlock.h"
+
+
+#if configUSE_SEQLOCKS != 1
+#error periodic.c requires configUSE_SEQLOCKS
+#endif
+
+
+/* Duration of a tick in microseconds, equal to the tick timer's load */
+#define TICK_US        ( configCPU_CLOCK_HZ / configTICK_RATE_HZ )
+
+
+/* List of registered periodic tasks */
+static periodicTask* taskList = NULL;
+
+/*
+ * Timestamp of the latest tick, i.e. when the tick timer expired,
+ * and the corresponding tick count. Both are updated by periodicTick()
+ * and protected by tickLock.
+ */
+static SeqLock_t tickLock = { 0 };
+static volatile uint32_t tickStamp = 0;
+static volatile TickType_t tickCount = 0;
+static volatile int8_t tickValid = 0;
+
+
+/*
+ * Clears the statistics of a periodic task.
+ */
+static void prvReset(periodicTask* task)
+{
+    uint8_t i;
+
+    task->activations = 0;
+    task->overruns = 0;
+    task->maxLatency = 0;
+
+    for ( i=0; i<PERIODIC_HIST_BINS; ++i )
+    {
+        task->histogram[i] = 0;
+    }
+}
+
+
+/**
+ * Records the timestamp of the current tick. Must be called from the tick hook.
+ */
+void periodicTick(void)
+{
+    const TickType_t count = xTaskGetTickCountFromISR();
+    uint32_t sinceTick;
+
+    /*
+     * When the scheduler is suspended, ticks are pended and the tick count
+     * lags behind. Such ticks are skipped, the previous pair remains valid.
+     */
+    if ( 0 != tickValid && count == tickCount )
+    {
+        return;
+    }
+
+    /* The tick timer counts down from its load, reloaded at the tick */
+    sinceTick = TICK_US - timer_getValue(APP_TICK_TIMER, APP_TICK_COUNTER);
+
+    vSeqLockWriteBeginFromISR(&tickLock);
+    {
+        tickStamp = timebase_getCounter() - sinceTick;
+        tickCount = count;
+        tickValid = 1;
+    }
+    vSeqLockWriteEndFromISR(&tickLock);
+}
+
+
+/**
+ * Registers a periodic task and sets its first release to the current tick.
+ * Must be called by the periodic task itself, before the first periodicWait().
+ *
+ * @param task - state of the periodic task, must remain valid while the task exists
+ * @param name - name of the task to be displayed
+ * @param period - period of the task in ticks
+ */
+void periodicInit(periodicTask* task, const portCHAR* name, TickType_t period)
+{
+    prvReset(task);
+    task->name = name;
+    task->period = period;
+    task->release = xTaskGetTickCount();
+
+    taskENTER_CRITICAL();
+    {
+        task->next = taskList;
+        taskList = task;
+    }
+    taskEXIT_CRITICAL();
+}
+
+
+/**
+ * Blocks the periodic task until its next release
+ * and records the latency of the release.
+ *
+ * @param task - state of the periodic task
+ */
+void periodicWait(periodicTask* task)
+{
+    uint32_t now;
+    uint32_t ideal;
+    uint32_t latency;
+    uint32_t seq;
+    uint8_t bin;
+    int8_t valid;
+
+    /*
+     * The deadline equals the next release. If it has already passed,
+     * vTaskDelayUntil() will return immediately.
+     */
+    if ( (TickType_t) (xTaskGetTickCount() - task->release) >= task->period )
+    {
+        ++task->overruns;
+    }
+
+    vTaskDelayUntil(&task->release, task->period);
+
+    /* Repeated if a tick has occurred meanwhile */
+    do
+    {
+        seq = ulSeqLockReadBegin(&tickLock);
+        now = timebase_getCounter();
+        ideal = tickStamp - (uint32_t) (tickCount - task->release) * TICK_US;
+        valid = tickValid;
+    }
+    while ( pdFALSE != xSeqLockReadRetry(&tickLock, seq) );
+
+    if ( 0 == valid )
+    {
+        return;
+    }
+
+    /* Guard against rounding of the tick's phase */
+    latency = ( (int32_t) (now - ideal) > 0 ? now - ideal : 0 );
+
+    bin = ( (latency >> PERIODIC_BIN_SHIFT) < PERIODIC_HIST_BINS ?
+            (uint8_t) (latency >> PERIODIC_BIN_SHIFT) : PERIODIC_HIST_BINS - 1 );
+
+    taskENTER_CRITICAL();
+    {
+        ++task->activations;
+        ++task->histogram[bin];
+
+        if ( latency > task->maxLatency )
+        {
+            task->maxLatency = latency;
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+
+/**
+ * Prints release statistics of all registered periodic tasks.
+ */
+void periodicPrint(void)
+{
+    const periodicTask* task;
+    uint8_t i;
+
+    for ( task=taskList; NULL!=task; task=task->next )
+    {
+        vDirectPrintMsg(task->name);
+        vDirectPrintMsg(": ");
+        vDirectPrintNum(task->activations);
+        vDirectPrintMsg(" releases, ");
+        vDirectPrintNum(task->overruns);
+        vDirectPrintMsg(" overruns, max latency ");
+        vDirectPrintNum(task->maxLatency);
+        vDirectPrintMsg(" us\r\n");
+
+        /* Bins are equally wide, the last bin is unlimited */
+        vDirectPrintMsg("  histogram [< us: count]:");
+        for ( i=0; i<PERIODIC_HIST_BINS; ++i )
+        {
+            vDirectPrintMsg(" ");
+            if ( i < PERIODIC_HIST_BINS - 1 )
+            {
+                vDirectPrintNum((uint32_t) (i + 1) << PERIODIC_BIN_SHIFT);
+            }
+            else
+            {
+                vDirectPrintMsg("inf");
+            }
+            vDirectPrintMsg(":");
+            vDirectPrintNum(task->histogram[i]);
+        }
+        vDirectPrintMsg("\r\n");
+    }
+}
+
+
+/**
+ * Clears release statistics of all registered periodic tasks.
+ */
+void periodicReset(void)
+{
+    periodicTask* task;
+
+    taskENTER_CRITICAL();
+    {
+        for ( task=taskList; NULL!=task; task=task->next )
+        {
+            prvReset(task);
+        }
+    }
+    taskEXIT_CRITICAL();
+}
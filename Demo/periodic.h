@@ -0,0 +1,65 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file
+ * Declaration of a helper for fixed frequency periodic tasks
+ * that records jitter of their releases.
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _PERIODIC_H_
+#define _PERIODIC_H_
+
+#include <FreeRTOS.h>
+
+#include "app_config.h"
+
+
+/* State and release statistics of a periodic task */
+typedef struct _periodicTask
+{
+    struct _periodicTask* next;                  /* next registered periodic task */
+    const portCHAR* name;                        /* name to be displayed */
+    TickType_t period;                           /* period in ticks */
+    TickType_t release;                          /* tick of the current release */
+    uint32_t activations;                        /* number of measured releases */
+    uint32_t overruns;                           /* number of activations that missed their deadlines */
+    uint32_t maxLatency;                         /* the latest release in us */
+    uint32_t histogram[PERIODIC_HIST_BINS];      /* histogram of release latencies */
+} periodicTask;
+
+
+void periodicInit(periodicTask* task, const portCHAR* name, TickType_t period);
+
+void periodicWait(periodicTask* task);
+
+void periodicTick(void);
+
+void periodicPrint(void);
+
+void periodicReset(void);
+
+
+#endif  /* _PERIODIC_H_ */
@@ -24,47 +24,77 @@
  * @file
  * Implementation of functions that perform printing messages to a UART
  *
+ * Messages are passed to a gate keeper task via one queue per class
+ * (see print.h). A binary semaphore, given after each queued message, wakes
+ * up the gate keeper, which then prints all queued messages, those of the
+ * most urgent class first. When a
+ * class's queue is full, its policy (see app_config.h) decides whether
+ * the new or the oldest message is dropped or the caller waits. Dropped
+ * messages are counted per class (see the diagnostic command "print").
+ *
+ * Formatted messages (see format.h) and individual characters are stored
+ * into a pool of statically allocated slots, each of them is returned to
+ * the pool when its message has been printed or dropped. As a slot cannot
+ * be reused while its message is still queued, nothing is ever overwritten.
+ *
  * @author Jernej Kovacic
  */
 
+#include <stdarg.h>
+
 #include <FreeRTOS.h>
 #include <task.h>
 #include <queue.h>
+#include <semphr.h>
 
 #include "app_config.h"
 #include "bsp.h"
 #include "uart.h"
 
+#include "print.h"
+#include "format.h"
+
+#include "objects.h"
+
 
 
 /*
- * A string buffer is necessary for printing individual characters:
- * (1) The gate keeper tasks accepts pointers to strings only. Hence a character will
- *     be placed into a short string, its first character will be the actual character,
- *     followed by '\0'.
- * (2) Corruptions must be prevented when several tasks call vPrintChar simultaneously.
- *     To accomplish this, the buffer will consist of several strings, the optimal number
- *     depends on the application.
+ * Pool of slots for formatted messages and individual characters.
+ * Its size has been defined in "app_config.h".
  */
 
-/* The number of actual strings for the buffer has been defined in "app_config.h" */
+/* Length of a slot, including the terminating '\0' */
+#define PRINT_SLOT_LEN          ( 1 << PRINT_SLOT_SHIFT )
+
+/* A bit mask of all slots */
+#define PRINT_SLOTS_MASK        ( (uint32_t) ( (1ULL << PRINT_SLOTS) - 1 ) )
 
-/* Length of one buffer string, one byte for the character, the other one for '\0' */
-#define CHR_BUF_STRING_LEN      ( 2 )
+#if PRINT_SLOTS > 32
+#error PRINT_SLOTS must not exceed 32
+#endif
 
-/* Allocate the buffer for printing individual characters */
-static portCHAR printChBuf[ PRINT_CHR_BUF_SIZE ][ CHR_BUF_STRING_LEN ];
+static portCHAR printSlot[ PRINT_SLOTS ][ PRINT_SLOT_LEN ];
 
-/* Position of the currently available "slot" in the buffer */
-static uint16_t chBufCntr = 0;
+/* Each set bit denotes a slot that is in use */
+static volatile uint32_t printSlotsUsed = 0;
 
 
 
 /* UART number: */
 static uint8_t printUartNr = (uint8_t) -1;
 
-/* Messages to be printed will be pushed to this queue */
-static QueueHandle_t printQueue;
+/* Messages to be printed will be pushed to these queues, one per class */
+static QueueHandle_t printQueue[PRINT_NR_CLASSES];
+
+/* Given whenever a message of any class is queued, the gate keeper waits for it */
+static SemaphoreHandle_t printPending;
+
+/* Policies of classes when their queues are full */
+static const printPolicy printClassPolicy[PRINT_NR_CLASSES] =
+    { PRINT_POLICY_URGENT, PRINT_POLICY_NORMAL, PRINT_POLICY_BACKGROUND };
+
+/* Number of dropped messages per class */
+static volatile uint32_t printDropCount[PRINT_NR_CLASSES];
 
 
 
@@ -79,18 +109,12 @@ static QueueHandle_t printQueue;
  */
 int16_t printInit(uint8_t uart_nr)
 {
+    const objectsQueueId queueIds[PRINT_NR_CLASSES] =
+        { OBJ_QUEUE_PRINT_URGENT, OBJ_QUEUE_PRINT_NORMAL, OBJ_QUEUE_PRINT_BACKGROUND };
     uint16_t i;
 
-    /*
-     * Initialize the character print buffer.
-     * It is sufficient to set each string's second character to '\0'.
-     */
-    for ( i=0; i<PRINT_CHR_BUF_SIZE; ++i )
-    {
-        printChBuf[i][1] = '\0';
-    }
-
-    chBufCntr = 0;
+    /* All slots are available */
+    printSlotsUsed = 0;
 
     /* Check if UART number is valid */
     if ( uart_nr >= BSP_NR_UARTS )
@@ -100,13 +124,25 @@ int16_t printInit(uint8_t uart_nr)
 
     printUartNr = uart_nr;
 
-    /* Create and assert a queue for the gate keeper task */
-    printQueue = xQueueCreate(PRINT_QUEUE_SIZE, sizeof(portCHAR*));
-    if ( 0 == printQueue )
+    /* Create and assert a semaphore that wakes up the gate keeper task */
+    printPending = objectsCreateSemaphore(OBJ_SEMAPHORE_PRINT);
+    if ( NULL == printPending )
     {
         return pdFAIL;
     }
 
+    /* And a queue per class */
+    for ( i=0; i<PRINT_NR_CLASSES; ++i )
+    {
+        printQueue[i] = objectsCreateQueue(queueIds[i]);
+        if ( NULL == printQueue[i] )
+        {
+            return pdFAIL;
+        }
+
+        printDropCount[i] = 0;
+    }
+
     /* Enable the UART for transmission */
     uart_enableTx(printUartNr);
 
@@ -114,8 +150,103 @@ int16_t printInit(uint8_t uart_nr)
 }
 
 
+/*
+ * Takes a slot from the pool. The caller must prevent
+ * concurrent access, i.e. run in a critical section or an ISR.
+ *
+ * @return pointer to an available slot or NULL if all slots are in use
+ */
+static portCHAR* printTakeSlot(void)
+{
+    const uint32_t avail = ~printSlotsUsed & PRINT_SLOTS_MASK;
+    uint32_t idx;
+
+    if ( 0 == avail )
+    {
+        return NULL;
+    }
+
+    idx = (uint32_t) __builtin_ctz(avail);
+    printSlotsUsed |= ( 1UL << idx );
+
+    return printSlot[idx];
+}
+
+
+/*
+ * Returns the slot, holding 'msg', to the pool.
+ * Nothing is done if 'msg' is not stored in a slot.
+ *
+ * @note IRQs are expected to be disabled, as it is the case in ISRs.
+ *
+ * @param msg - message that has been printed or dropped
+ */
+static void printReleaseSlotFromISR(const portCHAR* msg)
+{
+    const portCHAR* const pool = &printSlot[0][0];
+
+    if ( msg >= pool && msg < pool + sizeof(printSlot) )
+    {
+        /* Slots are a power of 2 long, so no division is necessary */
+        printSlotsUsed &= ~( 1UL << ( (uint32_t) ( msg - pool ) >> PRINT_SLOT_SHIFT ) );
+    }
+}
+
+
+/*
+ * Returns the slot, holding 'msg', to the pool.
+ * Nothing is done if 'msg' is not stored in a slot.
+ *
+ * @param msg - message that has been printed or dropped
+ */
+static void printReleaseSlot(const portCHAR* msg)
+{
+    taskENTER_CRITICAL();
+    {
+        printReleaseSlotFromISR(msg);
+    }
+    taskEXIT_CRITICAL();
+}
+
+
+/*
+ * Drops a message of the given class, i.e. returns its slot
+ * (if any) to the pool and counts the dropped message.
+ *
+ * @note IRQs are expected to be disabled, as it is the case in ISRs.
+ *
+ * @param cls - class of the message (must be valid)
+ * @param msg - message that is dropped
+ */
+static void printDropFromISR(printClass cls, const portCHAR* msg)
+{
+    printReleaseSlotFromISR(msg);
+    ++printDropCount[cls];
+}
+
+
+/*
+ * Drops a message of the given class, i.e. returns its slot
+ * (if any) to the pool and counts the dropped message.
+ *
+ * The counter is also updated by vPrintfFromISR(), hence it is
+ * only incremented within a critical section.
+ *
+ * @param cls - class of the message (must be valid)
+ * @param msg - message that is dropped
+ */
+static void printDrop(printClass cls, const portCHAR* msg)
+{
+    taskENTER_CRITICAL();
+    {
+        printDropFromISR(cls, msg);
+    }
+    taskEXIT_CRITICAL();
+}
+
+
 /**
- * A gate keeper task that waits for messages to appear in the print queue and
+ * A gate keeper task that waits for messages to appear in any print queue and
  * prints them. This prevents corruption of printed messages if a task that
  * actually attempts to print, is preempted.
  *
@@ -124,13 +255,33 @@ int16_t printInit(uint8_t uart_nr)
 void printGateKeeperTask(void* params)
 {
     portCHAR* message;
+    uint16_t cls;
 
     for ( ; ; )
     {
-        /* The task is blocked until something appears in the queue */
-        xQueueReceive(printQueue, (void*) &message, portMAX_DELAY);
-        /* Print the message in the queue */
-        uart_print(printUartNr, message);
+        /* The task is blocked until a message of any class appears */
+        xSemaphoreTake(printPending, portMAX_DELAY);
+
+        /*
+         * Print all queued messages. After each message, the search restarts
+         * at the most urgent class, so a message, queued in the meantime,
+         * precedes messages of less urgent classes. A message, queued after
+         * its class has been found empty, gives the semaphore again.
+         */
+        cls = 0;
+        while ( cls < PRINT_NR_CLASSES )
+        {
+            if ( pdPASS == xQueueReceive(printQueue[cls], (void*) &message, 0) )
+            {
+                uart_print(printUartNr, message);
+                printReleaseSlot(message);
+                cls = 0;
+            }
+            else
+            {
+                ++cls;
+            }
+        }
     }
 
     /* if it ever breaks out of the infinite loop... */
@@ -142,8 +293,214 @@ void printGateKeeperTask(void* params)
 
 
 /**
- * Prints a message in a thread safe manner - even if the calling task is preempted,
- * the entire message will be printed.
+ * Prints a message of the given class in a thread safe manner - even if the
+ * calling task is preempted, the entire message will be printed.
+ *
+ * If the class's queue is full, the message is handled according to the
+ * class's policy and a dropped message is counted.
+ *
+ * Nothing is printed if 'msg' equals NULL or 'cls' is invalid.
+ *
+ * @note This function may only be called when the FreeRTOS scheduler is running!
+ *
+ * @param cls - class of the message
+ * @param msg - a message to be printed
+ */
+void vPrintMsgClass(printClass cls, const portCHAR* msg)
+{
+    const portCHAR* oldest;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    if ( NULL == msg || cls >= PRINT_NR_CLASSES )
+    {
+        return;
+    }
+
+    switch ( printClassPolicy[cls] )
+    {
+        case PRINT_POLICY_BLOCK :
+        {
+            if ( pdPASS == xQueueSendToBack(printQueue[cls], (void*) &msg, PRINT_BLOCK_TICKS) )
+            {
+                xSemaphoreGive(printPending);
+                return;
+            }
+
+            break;
+        }
+
+        case PRINT_POLICY_OVERWRITE :
+        {
+            /*
+             * Neither other tasks nor vPrintfFromISR() may print in the
+             * meantime, otherwise the freed entry could be taken.
+             */
+            taskENTER_CRITICAL();
+            {
+                if ( pdPASS != xQueueSendToBackFromISR(printQueue[cls], (void*) &msg, &higherPriorityTaskWoken) )
+                {
+                    /* Replace the oldest message */
+                    xQueueReceiveFromISR(printQueue[cls], (void*) &oldest, &higherPriorityTaskWoken);
+                    printDropFromISR(cls, oldest);
+
+                    if ( pdPASS != xQueueSendToBackFromISR(printQueue[cls], (void*) &msg, &higherPriorityTaskWoken) )
+                    {
+                        printDropFromISR(cls, msg);
+                    }
+                }
+
+                xSemaphoreGiveFromISR(printPending, &higherPriorityTaskWoken);
+            }
+            taskEXIT_CRITICAL();
+
+            if ( pdFALSE != higherPriorityTaskWoken )
+            {
+                taskYIELD();
+            }
+
+            return;
+        }
+
+        default :
+        {
+            if ( pdPASS == xQueueSendToBack(printQueue[cls], (void*) &msg, 0) )
+            {
+                xSemaphoreGive(printPending);
+                return;
+            }
+
+            break;
+        }
+    }
+
+    printDrop(cls, msg);
+}
+
+
+/*
+ * Formats a message (see format.h) into a slot and prints it as a message
+ * of the given class. If no slot is available, the message is dropped and counted.
+ *
+ * @param cls - class of the message (must be valid)
+ * @param fmt - format string
+ * @param args - arguments of conversions
+ */
+static void printFormatted(printClass cls, const portCHAR* fmt, va_list args)
+{
+    portCHAR* slot;
+
+    taskENTER_CRITICAL();
+    {
+        slot = printTakeSlot();
+        if ( NULL == slot )
+        {
+            printDropFromISR(cls, NULL);
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if ( NULL == slot )
+    {
+        return;
+    }
+
+    formatStringV(slot, PRINT_SLOT_LEN, fmt, args);
+    vPrintMsgClass(cls, slot);
+}
+
+
+/**
+ * Formats a message (see format.h) and prints it as a message of the given
+ * class in a thread safe manner. Messages, longer than PRINT_SLOT_LEN-1
+ * characters, are truncated.
+ *
+ * If no slot is available, the message is dropped and counted.
+ *
+ * @note This function may only be called when the FreeRTOS scheduler is running!
+ *
+ * @param cls - class of the message
+ * @param fmt - format string, followed by arguments of conversions
+ */
+void vPrintfClass(printClass cls, const portCHAR* fmt, ...)
+{
+    va_list args;
+
+    if ( cls >= PRINT_NR_CLASSES )
+    {
+        return;
+    }
+
+    va_start(args, fmt);
+    printFormatted(cls, fmt, args);
+    va_end(args);
+}
+
+
+/**
+ * Formats a message (see format.h) and prints it as a message of the class
+ * PRINT_CLASS_NORMAL in a thread safe manner, see vPrintfClass() for details.
+ *
+ * @note This function may only be called when the FreeRTOS scheduler is running!
+ *
+ * @param fmt - format string, followed by arguments of conversions
+ */
+void vPrintf(const portCHAR* fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    printFormatted(PRINT_CLASS_NORMAL, fmt, args);
+    va_end(args);
+}
+
+
+/**
+ * Formats a message (see format.h) and prints it as a message of the given
+ * class from an interrupt service routine. The ISR never waits, so the
+ * message is dropped and counted if no slot is available or the class's
+ * queue is full, regardless of the class's policy.
+ *
+ * @note IRQs are expected to be disabled, as it is the case in ISRs.
+ *
+ * @param pxHigherPriorityTaskWoken - set to pdTRUE if the gate keeper has been unblocked
+ * @param cls - class of the message
+ * @param fmt - format string, followed by arguments of conversions
+ */
+void vPrintfFromISR(BaseType_t* pxHigherPriorityTaskWoken, printClass cls, const portCHAR* fmt, ...)
+{
+    portCHAR* slot;
+    va_list args;
+
+    if ( cls >= PRINT_NR_CLASSES )
+    {
+        return;
+    }
+
+    slot = printTakeSlot();
+    if ( NULL == slot )
+    {
+        printDropFromISR(cls, NULL);
+        return;
+    }
+
+    va_start(args, fmt);
+    formatStringV(slot, PRINT_SLOT_LEN, fmt, args);
+    va_end(args);
+
+    if ( pdPASS == xQueueSendToBackFromISR(printQueue[cls], (void*) &slot, pxHigherPriorityTaskWoken) )
+    {
+        xSemaphoreGiveFromISR(printPending, pxHigherPriorityTaskWoken);
+    }
+    else
+    {
+        printDropFromISR(cls, slot);
+    }
+}
+
+
+/**
+ * Prints a message of the class PRINT_CLASS_NORMAL in a thread safe manner -
+ * even if the calling task is preempted, the entire message will be printed.
  *
  * Nothing is printed if 'msg' equals NULL.
  *
@@ -153,17 +510,44 @@ void printGateKeeperTask(void* params)
  */
 void vPrintMsg(const portCHAR* msg)
 {
-    if ( NULL != msg )
+    vPrintMsgClass(PRINT_CLASS_NORMAL, msg);
+}
+
+
+/**
+ * @param cls - class of messages
+ *
+ * @return number of dropped messages of the class 'cls', 0 if 'cls' is invalid
+ */
+uint32_t printGetDropCount(printClass cls)
+{
+    return ( cls < PRINT_NR_CLASSES ? printDropCount[cls] : 0 );
+}
+
+
+/**
+ * Clears counters of dropped messages of all classes.
+ */
+void printResetDropCounts(void)
+{
+    uint16_t i;
+
+    /* vPrintfFromISR() may update the counters at any time */
+    taskENTER_CRITICAL();
     {
-        xQueueSendToBack(printQueue, (void*) &msg, 0);
+        for ( i=0; i<PRINT_NR_CLASSES; ++i )
+        {
+            printDropCount[i] = 0;
+        }
     }
+    taskEXIT_CRITICAL();
 }
 
 
 /**
  * Prints a character in a thread safe manner - even if the calling task preempts
- * another printing task, its message will not be corrupted. Additionally, if another
- * task attempts to print a character, the buffer will not be corrupted.
+ * another printing task, its message will not be corrupted. The character is
+ * stored into a slot of the pool, so it cannot be overwritten before it is printed.
  *
  * @note This function may only be called when the FreeRTOS scheduler is running!
  *
@@ -171,26 +555,7 @@ void vPrintMsg(const portCHAR* msg)
  */
 void vPrintChar(portCHAR ch)
 {
-    /*
-     * If several tasks call this function "simultaneously", the buffer may get
-     * corrupted. To prevent this, the buffer contains several strings
-     */
-
-    /*
-     * Put 'ch' to the first character of the current buffer string,
-     * note that the second character has been initialized to '\0'.
-     */
-    printChBuf[chBufCntr][0] = ch;
-
-    /* Now the current buffer string may be sent to the printing queue */
-    vPrintMsg(printChBuf[chBufCntr]);
-
-    /*
-     * Update chBufCntr and make sure it always
-     * remains between 0 and CHR_PRINT_BUF_SIZE-1
-     */
-    ++chBufCntr;
-    chBufCntr %= PRINT_CHR_BUF_SIZE;
+    vPrintf("%c", ch);
 }
 
 
@@ -225,3 +590,37 @@ void vDirectPrintCh(portCHAR ch)
 {
     uart_printChar(printUartNr, ch);
 }
+
+
+/**
+ * Prints an unsigned integer, in decimal notation, directly to the UART.
+ * The function is not thread safe and corruptions are possible when multiple
+ * tasks attempt to print "simultaneously".
+ *
+ * @param num - an unsigned integer to be printed
+ */
+void vDirectPrintNum(uint32_t num)
+{
+    /* Up to 10 decimal digits of a 32-bit integer, followed by '\0' */
+    portCHAR digits[11];
+
+    formatString(digits, sizeof(digits), "%u", num);
+    uart_print(printUartNr, digits);
+}
+
+
+/**
+ * Prints an unsigned integer, in hexadecimal notation with a "0x" prefix
+ * and all 8 digits, directly to the UART. The function is not thread safe and
+ * corruptions are possible when multiple tasks attempt to print "simultaneously".
+ *
+ * @param num - an unsigned integer to be printed
+ */
+void vDirectPrintHex(uint32_t num)
+{
+    /* "0x", followed by 8 hexadecimal digits and '\0' */
+    portCHAR digits[11];
+
+    formatString(digits, sizeof(digits), "0x%08X", num);
+    uart_print(printUartNr, digits);
+}
@@ -34,17 +34,54 @@
 #include <FreeRTOS.h>
 
 
-int16_t printInit(uint16_t uart_nr);
+/*
+ * Classes of messages, printed by the gate keeper task.
+ * Messages of a more urgent class are always printed first.
+ */
+typedef enum _printClass
+{
+    PRINT_CLASS_URGENT = 0,
+    PRINT_CLASS_NORMAL,
+    PRINT_CLASS_BACKGROUND,
+    PRINT_NR_CLASSES
+} printClass;
+
+/* What happens to a message when the queue of its class is full */
+typedef enum _printPolicy
+{
+    PRINT_POLICY_DROP = 0,       /* the message is dropped */
+    PRINT_POLICY_BLOCK,          /* the caller waits up to PRINT_BLOCK_TICKS, then drops it */
+    PRINT_POLICY_OVERWRITE       /* the oldest message of the class is dropped instead */
+} printPolicy;
+
+
+int16_t printInit(uint8_t uart_nr);
 
 void printGateKeeperTask(void* params);
 
 void vPrintMsg(const portCHAR* msg);
 
+void vPrintMsgClass(printClass cls, const portCHAR* msg);
+
+void vPrintf(const portCHAR* fmt, ...);
+
+void vPrintfClass(printClass cls, const portCHAR* fmt, ...);
+
+void vPrintfFromISR(BaseType_t* pxHigherPriorityTaskWoken, printClass cls, const portCHAR* fmt, ...);
+
+uint32_t printGetDropCount(printClass cls);
+
+void printResetDropCounts(void);
+
 void vPrintChar(portCHAR ch);
 
 void vDirectPrintMsg(const portCHAR* msg);
 
 void vDirectPrintCh(portCHAR ch);
 
+void vDirectPrintNum(uint32_t num);
+
+void vDirectPrintHex(uint32_t num);
+
 
 #endif  /* _PRINT_H_ */
@@ -24,21 +24,28 @@
  * @file
  * Implementation of functions that handle data receiving via a UART.
  *
+ * Each entered line (unless it is a diagnostic command) is echoed and
+ * published to the topic BUS_TOPIC_RECV_LINE (see bus.h), so other tasks
+ * may consume user's input without modifying this file.
+ *
  * @author Jernej Kovacic
  */
 
 #include <string.h>
 
 #include <FreeRTOS.h>
-#include <queue.h>
 #include <task.h>
+#include <stream_buffer.h>
 
 #include "app_config.h"
 #include "bsp.h"
-#include "uart.h"
-#include "interrupt.h"
+#include "uart_rx.h"
 
 #include "print.h"
+#include "diag.h"
+#include "objects.h"
+#include "pbuf.h"
+#include "bus.h"
 
 
 /* Numeric codes for special keys: */
@@ -59,6 +66,9 @@
  */
 #define RECV_TOTAL_BUFFER_LEN        ( MSG_OFFSET + RECV_BUFFER_LEN + 3 + 1 )
 
+/* Number of characters, obtained from the UART driver at once */
+#define RECV_CHUNK_LEN               ( 16 )
+
 /* Allocated "circular" buffer */
 static portCHAR buf[ RECV_BUFFER_SIZE ][ RECV_TOTAL_BUFFER_LEN ];
 
@@ -71,12 +81,8 @@ static uint16_t bufPos = 0;
 /* UART number: */
 static uint8_t recvUartNr = ( uint8_t ) -1;
 
-/* A queue for received characters, not processed yet */
-static QueueHandle_t recvQueue;
-
-
-/* forward declaration of an ISR handler: */
-static void recvIsrHandler(void);
+/* A stream buffer for received characters, not processed yet */
+static StreamBufferHandle_t recvStream;
 
 
 /**
@@ -89,11 +95,6 @@ static void recvIsrHandler(void);
  */
 int16_t recvInit(uint8_t uart_nr)
 {
-    /* Obtain the UART's IRQ from BSP */
-    const uint8_t uartIrqs[BSP_NR_UARTS] = BSP_UART_IRQS;
-    const uint8_t irq = ( uart_nr<BSP_NR_UARTS ?
-                             uartIrqs[uart_nr] :
-                             (uint8_t) -1 );
     uint16_t i;
 
     for ( i=0; i<RECV_BUFFER_SIZE; ++i )
@@ -113,201 +114,211 @@ int16_t recvInit(uint8_t uart_nr)
 
     recvUartNr = uart_nr;
 
-    /* Create and assert a queue for received characters */
-    recvQueue = xQueueCreate(RECV_QUEUE_SIZE, sizeof(portCHAR));
-    if ( 0 == recvQueue )
+    /* Create and assert a stream buffer for received characters */
+    recvStream = objectsCreateStreamBuffer(OBJ_STREAM_RECV);
+    if ( NULL == recvStream )
     {
         return pdFAIL;
     }
 
-    /* Attempt to register UART's IRQ on VIC */
-    if ( pic_registerIrq(irq, &recvIsrHandler, 50) < 0 )
+    /* The UART driver fills the stream buffer and passes complete lines */
+    if ( uartrx_init(recvUartNr, recvStream, CODE_CR, RECV_IRQ_PRIORITY, RECV_IRQ_BUDGET) < 0 )
     {
         return pdFAIL;
     }
 
-    /* Enable the UART's IRQ on VIC */
-    pic_enableInterrupt(irq);
-
-    /* Configure the UART to receive data and trigger interrupts on receive */
-    uart_enableRx(recvUartNr);
-    uart_enableRxInterrupt(recvUartNr);
-
     return pdPASS;
 }
 
 
 /*
- * ISR handler, triggered by IRQ 12.
- * It reads a character from the UART and pushes it into the queue.
+ * Publishes an entered line to the topic BUS_TOPIC_RECV_LINE.
+ * Nothing is published if no packet buffer is available.
+ *
+ * @param line - entered characters (not terminated by '\0')
+ * @param len - number of characters
  */
-static void recvIsrHandler(void)
+static void recvPublishLine(const portCHAR* line, uint16_t len)
 {
-    portCHAR ch;
+    pbuf* p = pbufAlloc(0);
 
-    /* Get the received character from the UART */
-    ch = uart_readChar(recvUartNr);
-
-    /*
-     * Push it to the queue.
-     * Note, since this is not a FreeRTOS task,
-     * a *FromISR implementation of the command must be called!
-     */
-    xQueueSendToBackFromISR(recvQueue, (void*) &ch, 0);
-    /* And acknowledge the interrupt on the UART controller */
-    uart_clearRxInterrupt(recvUartNr);
+    if ( NULL != p )
+    {
+        pbufAppend(p, line, len);
+        busPublish(BUS_TOPIC_RECV_LINE, p);
+        pbufFree(p);
+    }
 }
 
 
 /**
  * A FreeRTOS task that processes received characters.
- * The task is waiting in blocked state until the ISR handler pushes something
- * into the queue. If the received character is valid, it will be appended to a
+ * The task is waiting in blocked state until the UART driver passes a line
+ * (or a part of a long line). Each valid character will be appended to a
  * string buffer. When 'Enter' is pressed, the entire string will be sent to UART0.
  *
  * @param params - ignored
  */
 void recvTask(void* params)
 {
+    portCHAR chunk[RECV_CHUNK_LEN];
     portCHAR ch;
+    size_t len;
+    size_t i;
 
     for ( ; ; )
     {
-        /* The task is blocked until something appears in the queue */
-        xQueueReceive(recvQueue, (void*) &ch, portMAX_DELAY);
-
-        /*
-         * Although a bit long, 'switch' offers a convenient way to
-         * insert or remove valid characters.
-         */
-        switch (ch)
+        /* The task is blocked until a line (or RECV_CHUNK_LEN characters) is received */
+        len = uartrx_readLine(recvUartNr, chunk, RECV_CHUNK_LEN, portMAX_DELAY);
+
+        for ( i=0; i<len; ++i )
         {
-            /* "Ordinary" valid characters that will be appended to a buffer */
-
-            /* Uppercase letters 'A' .. 'Z': */
-            case 'A' :
-            case 'B' :
-            case 'C' :
-            case 'D' :
-            case 'E' :
-            case 'F' :
-            case 'G' :
-            case 'H' :
-            case 'I' :
-            case 'J' :
-            case 'K' :
-            case 'L' :
-            case 'M' :
-            case 'N' :
-            case 'O' :
-            case 'P' :
-            case 'Q' :
-            case 'R' :
-            case 'S' :
-            case 'T' :
-            case 'U' :
-            case 'V' :
-            case 'W' :
-            case 'X' :
-            case 'Y' :
-            case 'Z' :
-
-            /* Lowercase letters 'a'..'z': */
-            case 'a' :
-            case 'b' :
-            case 'c' :
-            case 'd' :
-            case 'e' :
-            case 'f' :
-            case 'g' :
-            case 'h' :
-            case 'i' :
-            case 'j' :
-            case 'k' :
-            case 'l' :
-            case 'm' :
-            case 'n' :
-            case 'o' :
-            case 'p' :
-            case 'q' :
-            case 'r' :
-            case 's' :
-            case 't' :
-            case 'u' :
-            case 'v' :
-            case 'w' :
-            case 'x' :
-            case 'y' :
-            case 'z' :
-
-            /* Decimal digits '0'..'9': */
-            case '0' :
-            case '1' :
-            case '2' :
-            case '3' :
-            case '4' :
-            case '5' :
-            case '6' :
-            case '7' :
-            case '8' :
-            case '9' :
-
-            /* Other valid characters: */
-            case ' ' :
-            case '_' :
-            case '+' :
-            case '-' :
-            case '/' :
-            case '.' :
-            case ',' :
+            ch = chunk[i];
+
+            /*
+             * Although a bit long, 'switch' offers a convenient way to
+             * insert or remove valid characters.
+             */
+            switch (ch)
             {
-                if ( bufPos < RECV_BUFFER_LEN )
+                /* "Ordinary" valid characters that will be appended to a buffer */
+
+                /* Uppercase letters 'A' .. 'Z': */
+                case 'A' :
+                case 'B' :
+                case 'C' :
+                case 'D' :
+                case 'E' :
+                case 'F' :
+                case 'G' :
+                case 'H' :
+                case 'I' :
+                case 'J' :
+                case 'K' :
+                case 'L' :
+                case 'M' :
+                case 'N' :
+                case 'O' :
+                case 'P' :
+                case 'Q' :
+                case 'R' :
+                case 'S' :
+                case 'T' :
+                case 'U' :
+                case 'V' :
+                case 'W' :
+                case 'X' :
+                case 'Y' :
+                case 'Z' :
+
+                /* Lowercase letters 'a'..'z': */
+                case 'a' :
+                case 'b' :
+                case 'c' :
+                case 'd' :
+                case 'e' :
+                case 'f' :
+                case 'g' :
+                case 'h' :
+                case 'i' :
+                case 'j' :
+                case 'k' :
+                case 'l' :
+                case 'm' :
+                case 'n' :
+                case 'o' :
+                case 'p' :
+                case 'q' :
+                case 'r' :
+                case 's' :
+                case 't' :
+                case 'u' :
+                case 'v' :
+                case 'w' :
+                case 'x' :
+                case 'y' :
+                case 'z' :
+
+                /* Decimal digits '0'..'9': */
+                case '0' :
+                case '1' :
+                case '2' :
+                case '3' :
+                case '4' :
+                case '5' :
+                case '6' :
+                case '7' :
+                case '8' :
+                case '9' :
+
+                /* Other valid characters: */
+                case ' ' :
+                case '_' :
+                case '+' :
+                case '-' :
+                case '/' :
+                case '.' :
+                case ',' :
                 {
-                    /* If the buffer is not full yet, append the character */
-                    buf[bufCntr][MSG_OFFSET + bufPos] = ch;
-                    /* and increase the position index: */
-                    ++bufPos;
+                    if ( bufPos < RECV_BUFFER_LEN )
+                    {
+                        /* If the buffer is not full yet, append the character */
+                        buf[bufCntr][MSG_OFFSET + bufPos] = ch;
+                        /* and increase the position index: */
+                        ++bufPos;
+                    }
+
+                    break;
                 }
 
-                break;
-            }
+                /* Backspace must be handled separately: */
+                case CODE_BS :
+                {
+                    /*
+                     * If the buffer is not empty, decrease the position index,
+                     * i.e. "delete" the last character
+                     */
+                    if ( bufPos>0 )
+                    {
+                        --bufPos;
+                    }
+
+                    break;
+                }
 
-            /* Backspace must be handled separately: */
-            case CODE_BS :
-            {
-                /*
-                 * If the buffer is not empty, decrease the position index,
-                 * i.e. "delete" the last character
-                 */
-                if ( bufPos>0 )
+                /* 'Enter' a.k.a. Carriage Return (CR): */
+                case CODE_CR :
                 {
-                    --bufPos;
+                    /* If the entered text is a diagnostic command, execute it instead of echoing it */
+                    buf[bufCntr][MSG_OFFSET + bufPos] = '\0';
+                    if ( pdTRUE == diagExecCommand(&buf[bufCntr][MSG_OFFSET]) )
+                    {
+                        bufPos = 0;
+                        break;
+                    }
+
+                    recvPublishLine(&buf[bufCntr][MSG_OFFSET], bufPos);
+
+                    /* Append characters to terminate the string:*/
+                    bufPos += MSG_OFFSET;
+                    buf[bufCntr][bufPos++] = '"';
+                    buf[bufCntr][bufPos++] = '\r';
+                    buf[bufCntr][bufPos++] = '\n';
+                    buf[bufCntr][bufPos]   = '\0';
+                    /* Send the entire string to the print queue, the user's input is printed first */
+                    vPrintMsgClass(PRINT_CLASS_URGENT, buf[bufCntr]);
+                    /* And switch to the next line of the "circular" buffer */
+                    ++bufCntr;
+                    bufCntr %= RECV_BUFFER_SIZE;
+                    /* "Reset" the position index */
+                    bufPos = 0;
+
+                    break;
                 }
 
-                break;
-            }
+            }  /* switch */
 
-            /* 'Enter' a.k.a. Carriage Return (CR): */
-            case CODE_CR :
-            {
-                /* Append characters to terminate the string:*/
-                bufPos += MSG_OFFSET;
-                buf[bufCntr][bufPos++] = '"';
-                buf[bufCntr][bufPos++] = '\r';
-                buf[bufCntr][bufPos++] = '\n';
-                buf[bufCntr][bufPos]   = '\0';
-                /* Send the entire string to the print queue */
-                vPrintMsg(buf[bufCntr]);
-                /* And switch to the next line of the "circular" buffer */
-                ++bufCntr;
-                bufCntr %= RECV_BUFFER_SIZE;
-                /* "Reset" the position index */
-                bufPos = 0;
-
-                break;
-            }
-
-        }  /* switch */
+        }  /* for i */
 
     }  /* for */
 
@@ -52,6 +52,8 @@
 
 .equ EXCEPTION_VECT,   0x00000000   @ Start of exception vectors
 
+.equ STACK_FILL,   0xA5A5A5A5       @ Pattern of unused stacks, equal to tskSTACK_FILL_BYTE in tasks.c
+
 
 .section .init
 .code 32                                   @ 32-bit ARM instruction set
@@ -98,6 +100,8 @@ vectors_end:
  * IRQ and System), disables IRQ iand FIQ nterrupts for all modes and finally
  * it jumps into the startup function.
  *
+ * All stacks are painted with a known pattern before they are used.
+ *
  * Note: 'stack_top', 'irq_stack_top' and 'svc_stack_top' are allocated in qemu.ld
  */
 reset_handler:
@@ -124,6 +128,16 @@ bss_clear_loop:
     STRLTB r2, [r0], #1            @ ...store a byte of r2 (i.r. 0) to location pointed by r0++
     BLT bss_clear_loop             @ ...and continue the loop
 
+    @ Paint stacks of all operating modes, so their usage can be measured (see stack_stats.h)
+    @ Nothing has been pushed to the Supervisor mode's stack yet.
+    LDR r0, =svc_stack_bottom
+    LDR r1, =stack_top
+    LDR r2, =STACK_FILL
+stack_paint_loop:
+    CMP r0, r1                     @ if (r0<r1) ....
+    STRLT r2, [r0], #4             @ ...store a word of the pattern to location pointed by r0++
+    BLT stack_paint_loop           @ ...and continue the loop
+
 
     @ Set stack pointers and IRQ/FIQ bits for all supported operating modes
 
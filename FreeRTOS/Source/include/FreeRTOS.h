@@ -548,6 +548,30 @@
     #define traceTASK_PRIORITY_SET( pxTask, uxNewPriority )
 #endif
 
+#ifndef traceTASK_SET_DEADLINE
+    #define traceTASK_SET_DEADLINE( pxTask, xRelativeDeadline )
+#endif
+
+#ifndef traceTASK_SET_PREEMPTION_THRESHOLD
+    #define traceTASK_SET_PREEMPTION_THRESHOLD( pxTask, uxThreshold )
+#endif
+
+#ifndef traceTASK_SET_BUDGET
+    #define traceTASK_SET_BUDGET( pxTask, xBudget, xPeriod )
+#endif
+
+#ifndef traceTASK_BUDGET_EXHAUSTED
+    #define traceTASK_BUDGET_EXHAUSTED( pxTask )
+#endif
+
+#ifndef traceTASK_BUDGET_REPLENISHED
+    #define traceTASK_BUDGET_REPLENISHED( pxTask )
+#endif
+
+#ifndef traceTASK_SET_TIME_SLICE
+    #define traceTASK_SET_TIME_SLICE( pxTask, xTicks )
+#endif
+
 #ifndef traceTASK_SUSPEND
     #define traceTASK_SUSPEND( pxTaskToSuspend )
 #endif
@@ -564,6 +588,20 @@
     #define traceTASK_INCREMENT_TICK( xTickCount )
 #endif
 
+#ifndef traceSCHEDULER_SUSPENDED
+
+/* Called by vTaskSuspendAll() when the scheduler gets suspended, i.e. not
+ * for nested calls. */
+    #define traceSCHEDULER_SUSPENDED()
+#endif
+
+#ifndef traceSCHEDULER_RESUMED
+
+/* Called by xTaskResumeAll() from within a critical section when the
+ * scheduler is no longer suspended. */
+    #define traceSCHEDULER_RESUMED()
+#endif
+
 #ifndef traceTIMER_CREATE
     #define traceTIMER_CREATE( pxNewTimer )
 #endif
@@ -778,6 +816,30 @@
     #define configUSE_TICKLESS_IDLE    0
 #endif
 
+#ifndef configUSE_TIMING_WHEEL
+    #define configUSE_TIMING_WHEEL    0
+#endif
+
+#ifndef configUSE_EDF_SCHEDULER
+    #define configUSE_EDF_SCHEDULER    0
+#endif
+
+#ifndef configEDF_PRIORITY
+    #define configEDF_PRIORITY    1
+#endif
+
+#ifndef configUSE_PREEMPTION_THRESHOLD
+    #define configUSE_PREEMPTION_THRESHOLD    0
+#endif
+
+#ifndef configUSE_TASK_BUDGET
+    #define configUSE_TASK_BUDGET    0
+#endif
+
+#ifndef configUSE_TASK_TIME_SLICES
+    #define configUSE_TASK_TIME_SLICES    0
+#endif
+
 #ifndef configPRE_SUPPRESS_TICKS_AND_SLEEP_PROCESSING
     #define configPRE_SUPPRESS_TICKS_AND_SLEEP_PROCESSING( x )
 #endif
@@ -898,6 +960,14 @@
     #endif /* INCLUDE_vTaskSuspend */
 #endif /* configUSE_TICKLESS_IDLE */
 
+#if ( ( configUSE_TIMING_WHEEL == 1 ) && ( configUSE_TICKLESS_IDLE != 0 ) )
+    #error configUSE_TIMING_WHEEL cannot be used with configUSE_TICKLESS_IDLE
+#endif
+
+#if ( ( configUSE_EDF_SCHEDULER == 1 ) && ( ( configEDF_PRIORITY < 1 ) || ( configEDF_PRIORITY >= configMAX_PRIORITIES ) ) )
+    #error configEDF_PRIORITY must be above the idle priority and below configMAX_PRIORITIES
+#endif
+
 #if ( ( configSUPPORT_STATIC_ALLOCATION == 0 ) && ( configSUPPORT_DYNAMIC_ALLOCATION == 0 ) )
     #error configSUPPORT_STATIC_ALLOCATION and configSUPPORT_DYNAMIC_ALLOCATION cannot both be 0, but can both be 1.
 #endif
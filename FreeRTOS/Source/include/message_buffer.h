@@ -812,6 +812,66 @@ typedef void * MessageBufferHandle_t;
 #define xMessageBufferReceiveCompletedFromISR( xMessageBuffer, pxHigherPriorityTaskWoken ) \
     xStreamBufferReceiveCompletedFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pxHigherPriorityTaskWoken )
 
+/**
+ * message_buffer.h
+ *
+ * <pre>
+ * size_t xMessageBufferGetWriteWindow( MessageBufferHandle_t xMessageBuffer,
+ *                                      StreamBufferWindow_t * const pxWindow,
+ *                                      size_t xMessageLength,
+ *                                      TickType_t xTicksToWait );
+ * size_t xMessageBufferCommit( MessageBufferHandle_t xMessageBuffer, size_t xMessageLength );
+ * size_t xMessageBufferCommitFromISR( MessageBufferHandle_t xMessageBuffer,
+ *                                     size_t xMessageLength,
+ *                                     BaseType_t * const pxHigherPriorityTaskWoken );
+ * </pre>
+ *
+ * Writes a message in place.  xMessageBufferGetWriteWindow() returns a window
+ * of exactly xMessageLength bytes if the message, including its length, fits
+ * into the message buffer, and 0 otherwise.  The message is sent once its
+ * data is written into the window and committed by xMessageBufferCommit(),
+ * where xMessageLength must not exceed the window's length.
+ *
+ * See xStreamBufferGetWriteWindow() and xStreamBufferCommit() for details.
+ *
+ * \defgroup xMessageBufferGetWriteWindow xMessageBufferGetWriteWindow
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferGetWriteWindow( xMessageBuffer, pxWindow, xMessageLength, xTicksToWait ) \
+    xStreamBufferGetWriteWindow( ( StreamBufferHandle_t ) xMessageBuffer, pxWindow, xMessageLength, xTicksToWait )
+#define xMessageBufferCommit( xMessageBuffer, xMessageLength ) \
+    xStreamBufferCommit( ( StreamBufferHandle_t ) xMessageBuffer, xMessageLength )
+#define xMessageBufferCommitFromISR( xMessageBuffer, xMessageLength, pxHigherPriorityTaskWoken ) \
+    xStreamBufferCommitFromISR( ( StreamBufferHandle_t ) xMessageBuffer, xMessageLength, pxHigherPriorityTaskWoken )
+
+/**
+ * message_buffer.h
+ *
+ * <pre>
+ * size_t xMessageBufferGetReadWindow( MessageBufferHandle_t xMessageBuffer,
+ *                                     StreamBufferWindow_t * const pxWindow,
+ *                                     TickType_t xTicksToWait );
+ * size_t xMessageBufferConsume( MessageBufferHandle_t xMessageBuffer );
+ * size_t xMessageBufferConsumeFromISR( MessageBufferHandle_t xMessageBuffer,
+ *                                      BaseType_t * const pxHigherPriorityTaskWoken );
+ * </pre>
+ *
+ * Reads a message in place.  xMessageBufferGetReadWindow() returns a window
+ * into the data of the next message and its length.  The message remains in
+ * the message buffer until it is removed by xMessageBufferConsume().
+ *
+ * See xStreamBufferGetReadWindow() and xStreamBufferConsume() for details.
+ *
+ * \defgroup xMessageBufferGetReadWindow xMessageBufferGetReadWindow
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferGetReadWindow( xMessageBuffer, pxWindow, xTicksToWait ) \
+    xStreamBufferGetReadWindow( ( StreamBufferHandle_t ) xMessageBuffer, pxWindow, xTicksToWait )
+#define xMessageBufferConsume( xMessageBuffer ) \
+    xStreamBufferConsume( ( StreamBufferHandle_t ) xMessageBuffer, 0 )
+#define xMessageBufferConsumeFromISR( xMessageBuffer, pxHigherPriorityTaskWoken ) \
+    xStreamBufferConsumeFromISR( ( StreamBufferHandle_t ) xMessageBuffer, 0, pxHigherPriorityTaskWoken )
+
 /* *INDENT-OFF* */
 #if defined( __cplusplus )
     } /* extern "C" */
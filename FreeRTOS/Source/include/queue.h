@@ -1608,6 +1608,25 @@ BaseType_t xQueueGiveMutexRecursive( QueueHandle_t xMutex ) PRIVILEGED_FUNCTION;
  */
 QueueSetHandle_t xQueueCreateSet( const UBaseType_t uxEventQueueLength ) PRIVILEGED_FUNCTION;
 
+/*
+ * Creates a queue set in the same way as xQueueCreateSet(), but the memory is
+ * provided by the caller instead of being allocated from the FreeRTOS heap.
+ *
+ * @param uxEventQueueLength See xQueueCreateSet().
+ *
+ * @param pucQueueStorage Must point to a uint8_t array that is at least
+ * uxEventQueueLength * sizeof( QueueSetMemberHandle_t ) bytes big.
+ *
+ * @param pxStaticQueue Must point to a StaticQueue_t variable, which will be
+ * used to hold the queue set's data structure.
+ *
+ * @return If pucQueueStorage and pxStaticQueue are not NULL then the handle
+ * of the created queue set is returned.  Otherwise NULL is returned.
+ */
+QueueSetHandle_t xQueueCreateSetStatic( const UBaseType_t uxEventQueueLength,
+                                        uint8_t * pucQueueStorage,
+                                        StaticQueue_t * pxStaticQueue ) PRIVILEGED_FUNCTION;
+
 /*
  * Adds a queue or semaphore to a queue set that was previously created by a
  * call to xQueueCreateSet().
@@ -69,6 +69,19 @@
 struct StreamBufferDef_t;
 typedef struct StreamBufferDef_t * StreamBufferHandle_t;
 
+/**
+ * Describes a part of a stream buffer's storage area that may be accessed
+ * directly, without copying, see xStreamBufferGetWriteWindow() and
+ * xStreamBufferGetReadWindow().  As the storage area is circular, the part may
+ * wrap around its end, in which case it consists of two contiguous regions.
+ * Otherwise pucData[ 1 ] is NULL and xLength[ 1 ] is 0.
+ */
+typedef struct xSTREAM_BUFFER_WINDOW
+{
+    uint8_t * pucData[ 2 ]; /*< Start of each region. */
+    size_t xLength[ 2 ];    /*< Number of bytes in each region. */
+} StreamBufferWindow_t;
+
 
 /**
  * message_buffer.h
@@ -838,6 +851,187 @@ BaseType_t xStreamBufferSendCompletedFromISR( StreamBufferHandle_t xStreamBuffer
 BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuffer,
                                                  BaseType_t * pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferGetWriteWindow( StreamBufferHandle_t xStreamBuffer,
+ *                                     StreamBufferWindow_t * const pxWindow,
+ *                                     size_t xBytesWanted,
+ *                                     TickType_t xTicksToWait );
+ * </pre>
+ *
+ * Obtains a window into the free space of a stream buffer, so the data may be
+ * written directly into the buffer's storage area (e.g. by a driver or a DMA
+ * transfer) instead of being copied in by xStreamBufferSend().  Nothing is
+ * sent until the written bytes are committed by xStreamBufferCommit() or
+ * xStreamBufferCommitFromISR().
+ *
+ * In case of a stream buffer the window covers all the free space, but the
+ * calling task may wait until at least xBytesWanted bytes are free.  In case
+ * of a message buffer the window covers exactly xBytesWanted bytes, i.e. the
+ * message's data, and is only returned if the whole message, including its
+ * length, fits into the buffer.
+ *
+ * The window remains valid until it is committed.  Only one writer may hold
+ * a window at a time and no other function may write to the buffer meanwhile.
+ *
+ * If xTicksToWait is 0, no critical section is entered and the function may
+ * also be called from an interrupt service routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to be written to.
+ *
+ * @param pxWindow Filled with one or two regions of the obtained window.
+ *
+ * @param xBytesWanted The number of bytes the caller intends to write.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should
+ * remain in the Blocked state to wait for enough free space.
+ *
+ * @return The number of bytes in the window, 0 if no window could be obtained.
+ *
+ * \defgroup xStreamBufferGetWriteWindow xStreamBufferGetWriteWindow
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferGetWriteWindow( StreamBufferHandle_t xStreamBuffer,
+                                    StreamBufferWindow_t * const pxWindow,
+                                    size_t xBytesWanted,
+                                    TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferCommit( StreamBufferHandle_t xStreamBuffer, size_t xBytesWritten );
+ * </pre>
+ *
+ * Sends xBytesWritten bytes, written into a window obtained by
+ * xStreamBufferGetWriteWindow(), and unblocks the reader if the buffer's
+ * trigger level is reached.  In case of a message buffer a message of
+ * xBytesWritten bytes is sent, that must not exceed the window's length.
+ * Committing 0 bytes releases the window without sending anything.
+ *
+ * Use xStreamBufferCommitFromISR() to commit from an interrupt service
+ * routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer that was written to.
+ *
+ * @param xBytesWritten The number of bytes written into the window.
+ *
+ * @return The number of bytes sent.
+ *
+ * \defgroup xStreamBufferCommit xStreamBufferCommit
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferCommit( StreamBufferHandle_t xStreamBuffer,
+                            size_t xBytesWritten ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+ *                                    size_t xBytesWritten,
+ *                                    BaseType_t * const pxHigherPriorityTaskWoken );
+ * </pre>
+ *
+ * A version of xStreamBufferCommit() that can be called from an interrupt
+ * service routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if the
+ * unblocked reader has a priority above the currently running task.
+ *
+ * \defgroup xStreamBufferCommitFromISR xStreamBufferCommitFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+                                   size_t xBytesWritten,
+                                   BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferGetReadWindow( StreamBufferHandle_t xStreamBuffer,
+ *                                    StreamBufferWindow_t * const pxWindow,
+ *                                    TickType_t xTicksToWait );
+ * </pre>
+ *
+ * Obtains a window into the data of a stream buffer, so it may be processed
+ * in place instead of being copied out by xStreamBufferReceive().  The data
+ * remains in the buffer until it is released by xStreamBufferConsume() or
+ * xStreamBufferConsumeFromISR().
+ *
+ * In case of a stream buffer the window covers all the available data, in
+ * case of a message buffer it covers the data of the next message.
+ *
+ * The window remains valid until it is consumed.  Only one reader may hold
+ * a window at a time and no other function may read from the buffer meanwhile.
+ *
+ * If xTicksToWait is 0, no critical section is entered and the function may
+ * also be called from an interrupt service routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to be read from.
+ *
+ * @param pxWindow Filled with one or two regions of the obtained window.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should
+ * remain in the Blocked state to wait for data.
+ *
+ * @return The number of bytes in the window, 0 if the buffer is empty.
+ *
+ * \defgroup xStreamBufferGetReadWindow xStreamBufferGetReadWindow
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferGetReadWindow( StreamBufferHandle_t xStreamBuffer,
+                                   StreamBufferWindow_t * const pxWindow,
+                                   TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferConsume( StreamBufferHandle_t xStreamBuffer, size_t xBytesRead );
+ * </pre>
+ *
+ * Removes xBytesRead bytes, obtained by xStreamBufferGetReadWindow(), from
+ * a stream buffer and unblocks the writer waiting for space.  In case of a
+ * message buffer xBytesRead is ignored and the whole next message is removed.
+ *
+ * Use xStreamBufferConsumeFromISR() to consume from an interrupt service
+ * routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer that was read from.
+ *
+ * @param xBytesRead The number of bytes processed, may be less than the
+ * window's length.
+ *
+ * @return The number of bytes removed from the buffer.
+ *
+ * \defgroup xStreamBufferConsume xStreamBufferConsume
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferConsume( StreamBufferHandle_t xStreamBuffer,
+                             size_t xBytesRead ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+ * <pre>
+ * size_t xStreamBufferConsumeFromISR( StreamBufferHandle_t xStreamBuffer,
+ *                                     size_t xBytesRead,
+ *                                     BaseType_t * const pxHigherPriorityTaskWoken );
+ * </pre>
+ *
+ * A version of xStreamBufferConsume() that can be called from an interrupt
+ * service routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if the
+ * unblocked writer has a priority above the currently running task.
+ *
+ * \defgroup xStreamBufferConsumeFromISR xStreamBufferConsumeFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferConsumeFromISR( StreamBufferHandle_t xStreamBuffer,
+                                    size_t xBytesRead,
+                                    BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /* Functions below here are not part of the public API. */
 StreamBufferHandle_t xStreamBufferGenericCreate( size_t xBufferSizeBytes,
                                                  size_t xTriggerLevelBytes,
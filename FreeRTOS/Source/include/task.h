@@ -1057,6 +1057,247 @@ void vTaskGetInfo( TaskHandle_t xTask,
 void vTaskPrioritySet( TaskHandle_t xTask,
                        UBaseType_t uxNewPriority ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <pre>void vTaskSetDeadline( TaskHandle_t xTask, TickType_t xRelativeDeadline );</pre>
+ *
+ * configUSE_EDF_SCHEDULER must be defined as 1 for this function to be
+ * available.
+ *
+ * Ready tasks of priority configEDF_PRIORITY are not scheduled round robin,
+ * but by the Earliest Deadline First policy, i.e. the task with the earliest
+ * absolute deadline runs.  Tasks of higher priorities still preempt them and
+ * tasks of lower priorities only run when no task of configEDF_PRIORITY is
+ * ready.
+ *
+ * Sets the relative deadline of a task and starts its current release now,
+ * so its absolute deadline becomes the current tick count plus
+ * xRelativeDeadline.  Each subsequent release by vTaskDelayUntil() (or
+ * vTaskDelay()) sets the absolute deadline to the wake time plus
+ * xRelativeDeadline.  Tasks that are released by other events may call this
+ * function at the beginning of each release.  The relative deadline of a newly
+ * created task is zero ticks, so its absolute deadline is its creation time
+ * (or last release time) and it precedes tasks with pending deadlines.
+ *
+ * Deadlines are compared relative to each other, so the order is kept when
+ * the tick count overflows, as long as the absolute deadlines of ready tasks
+ * are less than half the range of TickType_t apart.
+ *
+ * @param xTask Handle to the task whose deadline is set.  Passing a NULL
+ * handle results in the deadline of the calling task being set.
+ *
+ * @param xRelativeDeadline The deadline in ticks, relative to each release,
+ * typically equal to the period of the task.
+ *
+ * \defgroup vTaskSetDeadline vTaskSetDeadline
+ * \ingroup TaskCtrl
+ */
+void vTaskSetDeadline( TaskHandle_t xTask,
+                       TickType_t xRelativeDeadline ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>TickType_t xTaskGetDeadline( TaskHandle_t xTask );</pre>
+ *
+ * configUSE_EDF_SCHEDULER must be defined as 1 for this function to be
+ * available.  See vTaskSetDeadline() for more details.
+ *
+ * @param xTask Handle of the task to be queried.  Passing a NULL
+ * handle results in the deadline of the calling task being returned.
+ *
+ * @return The absolute deadline (in ticks) of the current release of xTask.
+ *
+ * \defgroup xTaskGetDeadline xTaskGetDeadline
+ * \ingroup TaskCtrl
+ */
+TickType_t xTaskGetDeadline( const TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>void vTaskSetPreemptionThreshold( TaskHandle_t xTask, UBaseType_t uxThreshold );</pre>
+ *
+ * configUSE_PREEMPTION_THRESHOLD must be defined as 1 for this function to be
+ * available.
+ *
+ * Sets the preemption threshold of a task.  While the task is running, its
+ * priority is effectively raised to the threshold, so only tasks of
+ * priorities above the threshold can preempt it.  Tasks of priorities
+ * between its priority and its threshold (inclusive) wait until it blocks,
+ * which avoids unnecessary context switches between cooperating tasks, and
+ * such tasks never need stack space for preempting each other.  If the task
+ * is preempted by a more urgent task, it is resumed before the tasks it is
+ * protected from.  A task with a threshold is not time sliced.
+ *
+ * A threshold below the priority of the task has no effect, which is the
+ * default.  The threshold does not affect the selection of the task to run
+ * after a task blocks.
+ *
+ * @param xTask Handle to the task for which the threshold is being set.
+ * Passing a NULL handle results in the threshold of the calling task being
+ * set.
+ *
+ * @param uxThreshold The preemption threshold, a priority between 0 and
+ * ( configMAX_PRIORITIES - 1 ).
+ *
+ * Example usage:
+ * <pre>
+ * void vAFunction( void )
+ * {
+ * TaskHandle_t xHandle;
+ *
+ *   // Create a task, storing the handle.
+ *   xTaskCreate( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY + 1, &xHandle );
+ *
+ *   // Tasks of priority tskIDLE_PRIORITY + 2 cannot preempt the task anymore.
+ *   vTaskSetPreemptionThreshold( xHandle, tskIDLE_PRIORITY + 2 );
+ * }
+ * </pre>
+ * \defgroup vTaskSetPreemptionThreshold vTaskSetPreemptionThreshold
+ * \ingroup TaskCtrl
+ */
+void vTaskSetPreemptionThreshold( TaskHandle_t xTask,
+                                  UBaseType_t uxThreshold ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>UBaseType_t uxTaskGetPreemptionThreshold( TaskHandle_t xTask );</pre>
+ *
+ * configUSE_PREEMPTION_THRESHOLD must be defined as 1 for this function to be
+ * available.  See vTaskSetPreemptionThreshold() for more details.
+ *
+ * @param xTask Handle of the task to be queried.  Passing a NULL
+ * handle results in the threshold of the calling task being returned.
+ *
+ * @return The effective preemption threshold of xTask, i.e. its threshold
+ * or its priority, whichever is higher.
+ *
+ * \defgroup uxTaskGetPreemptionThreshold uxTaskGetPreemptionThreshold
+ * \ingroup TaskCtrl
+ */
+UBaseType_t uxTaskGetPreemptionThreshold( const TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>void vTaskSetBudget( TaskHandle_t xTask, TickType_t xBudget, TickType_t xPeriod, UBaseType_t uxBackgroundPriority );</pre>
+ *
+ * configUSE_TASK_BUDGET must be defined as 1 for this function to be
+ * available.
+ *
+ * Limits the processor time a task may consume at its priority (deferrable
+ * server), which bounds the interference of an aperiodic task with tasks of
+ * lower priorities.  The task may run for xBudget ticks within each period of
+ * xPeriod ticks.  When its budget is exhausted, the task drops to
+ * uxBackgroundPriority and continues to run only when no task of a higher
+ * priority is ready.  At the end of each period the budget is replenished to
+ * xBudget (an unused budget is not carried over) and the task returns to its
+ * priority.  The first period starts when this function is called.
+ *
+ * The running task is charged for each tick interrupt, like time slicing, so
+ * the accounting is only accurate on average for tasks that run for less
+ * than a tick at a time.  The priority of the task must not be changed by
+ * vTaskPrioritySet() while it has a budget.
+ *
+ * @param xTask Handle to the task whose budget is set.  Passing a NULL handle
+ * results in the budget of the calling task being set.
+ *
+ * @param xBudget The budget in ticks, not greater than xPeriod.  Zero removes
+ * the budget of the task.
+ *
+ * @param xPeriod The replenishment period in ticks.
+ *
+ * @param uxBackgroundPriority The priority of the task while its budget is
+ * exhausted, typically tskIDLE_PRIORITY.
+ *
+ * Example usage:
+ * <pre>
+ * void vAFunction( TaskHandle_t xAperiodicTask )
+ * {
+ *   // The task may use 20% of the processor time at its priority.
+ *   vTaskSetBudget( xAperiodicTask, pdMS_TO_TICKS( 20 ), pdMS_TO_TICKS( 100 ), tskIDLE_PRIORITY );
+ * }
+ * </pre>
+ * \defgroup vTaskSetBudget vTaskSetBudget
+ * \ingroup TaskCtrl
+ */
+void vTaskSetBudget( TaskHandle_t xTask,
+                     TickType_t xBudget,
+                     TickType_t xPeriod,
+                     UBaseType_t uxBackgroundPriority ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>TickType_t xTaskGetBudgetLeft( TaskHandle_t xTask );</pre>
+ *
+ * configUSE_TASK_BUDGET must be defined as 1 for this function to be
+ * available.  See vTaskSetBudget() for more details.
+ *
+ * @param xTask Handle of the task to be queried.  Passing a NULL
+ * handle results in the budget of the calling task being returned.
+ *
+ * @return The remaining budget of xTask in the current period, zero if it
+ * is exhausted, or portMAX_DELAY if the task has no budget.
+ *
+ * \defgroup xTaskGetBudgetLeft xTaskGetBudgetLeft
+ * \ingroup TaskCtrl
+ */
+TickType_t xTaskGetBudgetLeft( const TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>void vTaskSetTimeSlice( TaskHandle_t xTask, TickType_t xTicks );</pre>
+ *
+ * configUSE_TASK_TIME_SLICES must be defined as 1 for this function to be
+ * available.  It only has an effect if configUSE_PREEMPTION and
+ * configUSE_TIME_SLICING are both 1.
+ *
+ * Sets the length of the time slice of a task, i.e. the number of ticks the
+ * task may run before it has to share the processor with ready tasks of the
+ * same priority.  A new time slice starts each time the task is switched in.
+ * Throughput oriented tasks may use long time slices to avoid switching at
+ * every tick, while interactive tasks keep the default length of one tick.
+ * Tasks of higher priorities preempt the task regardless of its time slice.
+ *
+ * @param xTask Handle to the task whose time slice is set.  Passing a NULL
+ * handle results in the time slice of the calling task being set.
+ *
+ * @param xTicks The length of the time slice in ticks, at least 1.
+ *
+ * Example usage:
+ * <pre>
+ * void vBatchTask( void * pvParameters )
+ * {
+ *   // Switch to other tasks of this priority every 10 ms only.
+ *   vTaskSetTimeSlice( NULL, pdMS_TO_TICKS( 10 ) );
+ *
+ *   for( ;; )
+ *   {
+ *     // Process data
+ *   }
+ * }
+ * </pre>
+ * \defgroup vTaskSetTimeSlice vTaskSetTimeSlice
+ * \ingroup TaskCtrl
+ */
+void vTaskSetTimeSlice( TaskHandle_t xTask,
+                        TickType_t xTicks ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <pre>TickType_t xTaskGetTimeSlice( TaskHandle_t xTask );</pre>
+ *
+ * configUSE_TASK_TIME_SLICES must be defined as 1 for this function to be
+ * available.  See vTaskSetTimeSlice() for more details.
+ *
+ * @param xTask Handle of the task to be queried.  Passing a NULL
+ * handle results in the time slice of the calling task being returned.
+ *
+ * @return The length of the time slice of xTask in ticks.
+ *
+ * \defgroup xTaskGetTimeSlice xTaskGetTimeSlice
+ * \ingroup TaskCtrl
+ */
+TickType_t xTaskGetTimeSlice( const TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+
 /**
  * task. h
  * <pre>
@@ -2558,7 +2799,7 @@ uint32_t ulTaskGenericNotifyTake( UBaseType_t uxIndexToWaitOn,
 #define ulTaskNotifyTake( xClearCountOnExit, xTicksToWait ) \
     ulTaskGenericNotifyTake( ( tskDEFAULT_INDEX_TO_NOTIFY ), ( xClearCountOnExit ), ( xTicksToWait ) )
 #define ulTaskNotifyTakeIndexed( uxIndexToWaitOn, xClearCountOnExit, xTicksToWait ) \
-    ulTaskGenericNotifyTake( ( uxIndexToNotify ), ( xClearCountOnExit ), ( xTicksToWait ) )
+    ulTaskGenericNotifyTake( ( uxIndexToWaitOn ), ( xClearCountOnExit ), ( xTicksToWait ) )
 
 /**
  * task. h
@@ -0,0 +1,139 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ *
+ * Hierarchical timing wheel, an alternative to sorted lists of timeouts.
+ *
+ * When configUSE_TIMING_WHEEL is set to 1 (in FreeRTOSConfig.h), delayed
+ * (blocked) tasks and active software timers are kept in timing wheels
+ * instead of lists, sorted by their wake or expiry times. Insertion and
+ * cancellation (via uxListRemove()) are O(1), regardless of the number
+ * of armed timeouts.
+ *
+ * A wheel consists of configTIMING_WHEEL_LEVELS levels of twheelSLOTS slots,
+ * each slot is an ordinary (unsorted) list. A slot at the level L spans
+ * twheelSLOTS^L ticks. An item is inserted into the lowest level whose
+ * range covers its timeout. When a slot of a higher level is reached, its
+ * items are cascaded to lower levels. Items, whose timeouts exceed the
+ * range of the top level, are parked at its furthest slot and cascaded
+ * repeatedly until they fit.
+ *
+ * Each level keeps a bitmap of (possibly) occupied slots, so the wheel
+ * can skip empty ticks (see pxTimingWheelAdvance()) and report the next
+ * tick when it must be advanced (see xTimingWheelNextEvent()).
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#ifndef INC_FREERTOS_H
+    #error "include FreeRTOS.h must appear in source files before include timing_wheel.h"
+#endif
+
+#include "list.h"
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    extern "C" {
+#endif
+/* *INDENT-ON* */
+
+
+/* Number of levels. The range of the wheel is twheelSLOTS^configTIMING_WHEEL_LEVELS ticks. */
+#ifndef configTIMING_WHEEL_LEVELS
+    #define configTIMING_WHEEL_LEVELS    4
+#endif
+
+#if ( configTIMING_WHEEL_LEVELS < 2 ) || ( configTIMING_WHEEL_LEVELS > 6 )
+    #error configTIMING_WHEEL_LEVELS must be between 2 and 6
+#endif
+
+/* Slots per level. Occupied slots of a level are tracked by a 32-bit bitmap. */
+#define twheelSLOT_BITS    ( 5U )
+#define twheelSLOTS        ( 1U << twheelSLOT_BITS )
+#define twheelSLOT_MASK    ( twheelSLOTS - 1U )
+
+/* Total number of slots, i.e. lists, of a wheel. */
+#define twheelNUM_LISTS    ( configTIMING_WHEEL_LEVELS * twheelSLOTS )
+
+typedef struct xTIMING_WHEEL
+{
+    TickType_t xTime;                                    /*< The tick up to which the wheel has been advanced. */
+    uint32_t ulOccupied[ configTIMING_WHEEL_LEVELS ];    /*< Bitmaps of (possibly) occupied slots of each level. */
+    List_t xSlots[ twheelNUM_LISTS ];                    /*< Slots of all levels, the level L starts at L * twheelSLOTS. */
+} TimingWheel_t;
+
+/*
+ * Initialises an empty wheel, advanced up to the tick xTime.
+ */
+void vTimingWheelInitialise( TimingWheel_t * const pxWheel,
+                             TickType_t xTime ) PRIVILEGED_FUNCTION;
+
+/*
+ * Inserts the item into the wheel. Its timeout is the item's value, i.e. the
+ * tick when it expires. Items that have already expired (the item's value
+ * equals the wheel's time) expire on the next tick. The item is removed
+ * from the wheel (e.g. cancelled) by uxListRemove().
+ */
+void vTimingWheelInsert( TimingWheel_t * const pxWheel,
+                         ListItem_t * const pxItem ) PRIVILEGED_FUNCTION;
+
+/*
+ * Advances the wheel towards the tick xTime, cascading items of higher levels
+ * and skipping ticks without any expired items. It stops at the first tick
+ * whose slot contains expired items and returns the slot. The caller must
+ * remove all items from the slot before the wheel is advanced again.
+ *
+ * NULL is returned when the wheel has been advanced up to xTime
+ * and no (more) items have expired.
+ */
+List_t * pxTimingWheelAdvance( TimingWheel_t * const pxWheel,
+                               TickType_t xTime ) PRIVILEGED_FUNCTION;
+
+/*
+ * Obtains the next tick when the wheel must be advanced, i.e. when
+ * items may expire or must be cascaded.
+ *
+ * pdFALSE is returned if the wheel is empty.
+ */
+BaseType_t xTimingWheelNextEvent( const TimingWheel_t * const pxWheel,
+                                  TickType_t * const pxTime ) PRIVILEGED_FUNCTION;
+
+/*
+ * Is the list one of the wheel's slots?
+ */
+#define twheelIS_SLOT( pxWheel, pxList )                                                  \
+    ( ( ( const List_t * ) ( pxList ) >= &( ( pxWheel )->xSlots[ 0 ] ) ) &&               \
+      ( ( const List_t * ) ( pxList ) < &( ( pxWheel )->xSlots[ twheelNUM_LISTS ] ) ) )
+
+
+/* *INDENT-OFF* */
+#ifdef __cplusplus
+    }
+#endif
+/* *INDENT-ON* */
+
+#endif /* TIMING_WHEEL_H */
@@ -0,0 +1,309 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ *
+ * Implementation of the instrumentation of sections with disabled
+ * interrupts and sections with the suspended scheduler.
+ *
+ * See critical_stats.h for more details.
+ *
+ * @author Jernej Kovacic
+ */
+
+
+#include <stddef.h>
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "timer.h"
+#include "timebase.h"
+#include "tick_timer_settings.h"
+#include "critical_stats.h"
+
+
+#if ( configUSE_CRITICAL_STATS == 1 )
+
+/*
+ * Positions of the saved SPSR and the return address within a task's
+ * context, relative to its top of stack. See portSAVE_CONTEXT().
+ */
+#define portCONTEXT_SPSR                ( 1 )
+#define portCONTEXT_RETURN_ADDR         ( 17 )
+
+/* The saved return address is offset by one instruction (as in IRQ mode). */
+#define portINSTRUCTION_SIZE            ( ( StackType_t ) 4 )
+
+/* The first item of each TCB is the task's top of stack. */
+extern volatile void * volatile pxCurrentTCB;
+
+/* Statistics of sections with disabled interrupts */
+static CriticalStats_t xIrqStats;
+
+/* Statistics of sections with the suspended scheduler */
+static CriticalStats_t xSchedStats;
+
+/* Start of the currently open section with disabled interrupts and its caller */
+static uint32_t ulIrqStart = 0;
+static void * pvIrqCaller = NULL;
+
+/* Start of the currently open section with the suspended scheduler and its caller */
+static uint32_t ulSchedStart = 0;
+static void * pvSchedCaller = NULL;
+
+/*
+ * Address of the free running counter's Value Register.
+ * Nothing is recorded until the counter is started by vPortCriticalStatsInit().
+ */
+static const volatile uint32_t * pulCounter = NULL;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The counter counts down, its complement is an increasing timestamp.
+ */
+static inline uint32_t prvTimestamp( void )
+{
+    return ~( *pulCounter );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Checks the IRQ bit of the SPSR, saved in the current task's context.
+ * The context is laid out by portSAVE_CONTEXT().
+ */
+static inline BaseType_t prvSavedContextMasked( void )
+{
+    StackType_t * pxTopOfStack = *( ( StackType_t ** ) pxCurrentTCB );
+
+    return ( 0UL != ( pxTopOfStack[ portCONTEXT_SPSR ] & portCPSR_IRQ_BIT ) ? pdTRUE : pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Records a finished section into 'pxStats'.
+ *
+ * Must be called with disabled interrupts.
+ */
+static void prvRecord( CriticalStats_t * pxStats, uint32_t ulDuration, void * pvCaller )
+{
+    UBaseType_t uxBin;
+    UBaseType_t uxPos;
+
+    pxStats->ulCount++;
+    pxStats->ulTotal += ulDuration;
+
+    if( ulDuration > pxStats->ulMax )
+    {
+        pxStats->ulMax = ulDuration;
+    }
+
+    /* Bin of the histogram equals the number of significant bits */
+    uxBin = ( 0UL == ulDuration ? 0 : 32 - __builtin_clz( ulDuration ) );
+    if( uxBin >= portCRITICAL_STATS_BINS )
+    {
+        uxBin = portCRITICAL_STATS_BINS - 1;
+    }
+    pxStats->ulHistogram[ uxBin ]++;
+
+    /*
+     * Update the table of the longest sections. Each caller appears
+     * at most once. If it is already in the table, its position is taken,
+     * otherwise the last (i.e. the shortest) section is replaced.
+     */
+    for( uxPos = 0; uxPos < portCRITICAL_STATS_LONGEST - 1; uxPos++ )
+    {
+        if( pxStats->xLongest[ uxPos ].pvCaller == pvCaller )
+        {
+            break;
+        }
+    }
+
+    if( ulDuration <= pxStats->xLongest[ uxPos ].ulDuration )
+    {
+        return;
+    }
+
+    /* Move shorter sections one position down */
+    while( uxPos > 0 && pxStats->xLongest[ uxPos - 1 ].ulDuration < ulDuration )
+    {
+        pxStats->xLongest[ uxPos ] = pxStats->xLongest[ uxPos - 1 ];
+        uxPos--;
+    }
+
+    pxStats->xLongest[ uxPos ].ulDuration = ulDuration;
+    pxStats->xLongest[ uxPos ].pvCaller = pvCaller;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Starts recording. Called when the scheduler is started,
+ * after the free running counter has been started by timebase_init().
+ */
+void vPortCriticalStatsInit( void )
+{
+    vPortResetCriticalStats();
+
+    pulCounter = timer_getValueAddr( portFREE_RUNNING_TIMER, portFREE_RUNNING_COUNTER );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by portDISABLE_INTERRUPTS() when IRQs have just been disabled.
+ * The section's caller is the function where portDISABLE_INTERRUPTS()
+ * (or portENTER_CRITICAL()) has been inlined.
+ */
+void vPortCriticalStatsMasked( void )
+{
+    if( NULL != pulCounter )
+    {
+        ulIrqStart = prvTimestamp();
+        pvIrqCaller = __builtin_return_address( 0 );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by portENABLE_INTERRUPTS() just before IRQs are reenabled.
+ */
+void vPortCriticalStatsUnmasked( void )
+{
+    if( NULL != pulCounter && NULL != pvIrqCaller )
+    {
+        prvRecord( &xIrqStats, prvTimestamp() - ulIrqStart, pvIrqCaller );
+        pvIrqCaller = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by vPortYieldProcessor() after the context of the current task
+ * has been saved.
+ *
+ * A task may yield from within a critical section. Its section is
+ * finished at this point as the next task might run with enabled IRQs.
+ */
+void vPortCriticalStatsYield( void )
+{
+    if( NULL != pulCounter && NULL != pvIrqCaller && pdFALSE != prvSavedContextMasked() )
+    {
+        prvRecord( &xIrqStats, prvTimestamp() - ulIrqStart, pvIrqCaller );
+    }
+
+    pvIrqCaller = NULL;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called just before a task's context is restored (after a yield or an ISR).
+ *
+ * If the restored task was switched out from within a critical section,
+ * a new section starts now. Its caller is the address, where the task
+ * will resume, and the section will be finished by portEXIT_CRITICAL().
+ */
+void vPortCriticalStatsSwitched( void )
+{
+    StackType_t * pxTopOfStack;
+
+    pvIrqCaller = NULL;
+
+    if( NULL != pulCounter && pdFALSE != prvSavedContextMasked() )
+    {
+        pxTopOfStack = *( ( StackType_t ** ) pxCurrentTCB );
+        ulIrqStart = prvTimestamp();
+        pvIrqCaller = ( void * ) ( pxTopOfStack[ portCONTEXT_RETURN_ADDR ] - portINSTRUCTION_SIZE );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by vTaskSuspendAll() when the scheduler is suspended.
+ */
+void vPortCriticalStatsSchedulerSuspended( void * pvCaller )
+{
+    if( NULL != pulCounter )
+    {
+        ulSchedStart = prvTimestamp();
+        pvSchedCaller = pvCaller;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by xTaskResumeAll() (within a critical section)
+ * when the scheduler is resumed.
+ */
+void vPortCriticalStatsSchedulerResumed( void )
+{
+    if( NULL != pulCounter && NULL != pvSchedCaller )
+    {
+        prvRecord( &xSchedStats, prvTimestamp() - ulSchedStart, pvSchedCaller );
+        pvSchedCaller = NULL;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Copies the current statistics.
+ *
+ * Any pointer may be NULL if the corresponding statistics are not needed.
+ *
+ * @param pxIrqDisabled - statistics of sections with disabled interrupts will be copied here
+ * @param pxSchedulerSuspended - statistics of sections with the suspended scheduler will be copied here
+ */
+void vPortGetCriticalStats( CriticalStats_t * pxIrqDisabled, CriticalStats_t * pxSchedulerSuspended )
+{
+    portENTER_CRITICAL();
+    {
+        if( NULL != pxIrqDisabled )
+        {
+            *pxIrqDisabled = xIrqStats;
+        }
+
+        if( NULL != pxSchedulerSuspended )
+        {
+            *pxSchedulerSuspended = xSchedStats;
+        }
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Clears all statistics.
+ */
+void vPortResetCriticalStats( void )
+{
+    portENTER_CRITICAL();
+    {
+        memset( &xIrqStats, 0, sizeof( xIrqStats ) );
+        memset( &xSchedStats, 0, sizeof( xSchedStats ) );
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_CRITICAL_STATS == 1 */
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ *
+ * Optional instrumentation of sections with disabled interrupts and of
+ * sections with the suspended scheduler.
+ *
+ * When configUSE_CRITICAL_STATS is set to 1 (in FreeRTOSConfig.h),
+ * each transition of the CPSR's IRQ bit (performed by portDISABLE_INTERRUPTS(),
+ * portENABLE_INTERRUPTS() and thus also by portENTER_CRITICAL() and
+ * portEXIT_CRITICAL()) and each suspension of the scheduler (vTaskSuspendAll())
+ * are timestamped by the free running counter (see tick_timer_settings.h).
+ *
+ * For both kinds of sections, the number of sections, their total and
+ * maximum duration, a histogram of durations and the longest sections
+ * with their callers' addresses are recorded. The addresses can be resolved
+ * into source lines by 'arm-none-eabi-addr2line -e image.elf <address>'.
+ *
+ * If a task is switched out from within a critical section (e.g. when it
+ * yields), its section is split at the context switch. The second part starts
+ * when the task is restored and its caller is the address, where the task
+ * resumes its execution.
+ *
+ * All durations are expressed in ticks of the free running counter,
+ * i.e. in microseconds.
+ *
+ * @note Time spent in IRQ mode (i.e. in ISRs) is not included.
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _CRITICAL_STATS_H_
+#define _CRITICAL_STATS_H_
+
+#include <stdint.h>
+
+
+/*
+ * Number of histogram's bins. Bin 0 counts sections shorter than 1 us,
+ * bin n (n>0) counts sections, lasting between 2^(n-1) and 2^n - 1 us,
+ * the last bin also counts all longer sections.
+ */
+#define portCRITICAL_STATS_BINS          ( 12 )
+
+/* Number of the longest sections (with distinct callers) that are recorded */
+#define portCRITICAL_STATS_LONGEST       ( 4 )
+
+
+/* A section and its caller's address */
+typedef struct xCRITICAL_SECTION_RECORD
+{
+    uint32_t ulDuration;                 /* duration of the section */
+    void * pvCaller;                     /* where the section started */
+} CriticalSectionRecord_t;
+
+/* Statistics of one kind of sections */
+typedef struct xCRITICAL_STATS
+{
+    uint32_t ulCount;                                          /* number of sections */
+    uint32_t ulTotal;                                          /* total duration of all sections */
+    uint32_t ulMax;                                            /* the longest section */
+    uint32_t ulHistogram[ portCRITICAL_STATS_BINS ];           /* histogram of durations */
+    CriticalSectionRecord_t xLongest[ portCRITICAL_STATS_LONGEST ];  /* sorted by descending duration */
+} CriticalStats_t;
+
+
+void vPortGetCriticalStats( CriticalStats_t * pxIrqDisabled, CriticalStats_t * pxSchedulerSuspended );
+
+void vPortResetCriticalStats( void );
+
+
+#endif  /* _CRITICAL_STATS_H_ */
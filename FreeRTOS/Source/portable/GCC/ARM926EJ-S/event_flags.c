@@ -0,0 +1,230 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ *
+ * Implementation of event flags with a single waiting task.
+ *
+ * See event_flags.h for more details.
+ *
+ * @author Jernej Kovacic
+ */
+
+
+#include <stddef.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "event_flags.h"
+#include "hrtimer.h"
+
+
+#if ( configUSE_EVENT_FLAGS == 1 )
+
+#if ( portEVENT_FLAGS_NOTIFY_INDEX == 0 ) || ( portEVENT_FLAGS_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES )
+#error Invalid index of the direct notification!
+#endif
+
+#if ( configUSE_HR_TIMER == 1 ) && ( portEVENT_FLAGS_NOTIFY_INDEX == portHR_TIMER_NOTIFY_INDEX )
+#error The direct notification is already reserved for vTaskDelayUs()!
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Is the wait condition met by the currently set flags?
+ */
+static inline BaseType_t prvConditionMet( uint32_t ulFlags, uint32_t ulWaitFor, BaseType_t xWaitForAll )
+{
+    if( pdFALSE != xWaitForAll )
+    {
+        return ( ( ulFlags & ulWaitFor ) == ulWaitFor ? pdTRUE : pdFALSE );
+    }
+
+    return ( 0UL != ( ulFlags & ulWaitFor ) ? pdTRUE : pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+void vEventFlagsInit( EventFlags_t * pxFlags )
+{
+    configASSERT( pxFlags );
+
+    pxFlags->ulFlags = 0UL;
+    pxFlags->xWaitingTask = NULL;
+    pxFlags->ulWaitFor = 0UL;
+    pxFlags->xWaitForAll = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Sets flags from the IRQ context, i.e. with disabled interrupts. If the
+ * waiting task's condition is met, the task is woken up immediately.
+ * Returns the flags after they have been set.
+ */
+uint32_t ulEventFlagsSetFromISR( EventFlags_t * pxFlags, uint32_t ulFlagsToSet, BaseType_t * pxHigherPriorityTaskWoken )
+{
+    TaskHandle_t xWaitingTask;
+    uint32_t ulFlags;
+
+    configASSERT( pxFlags );
+
+    ulFlags = pxFlags->ulFlags | ulFlagsToSet;
+    pxFlags->ulFlags = ulFlags;
+    xWaitingTask = pxFlags->xWaitingTask;
+
+    if( NULL != xWaitingTask && pdFALSE != prvConditionMet( ulFlags, pxFlags->ulWaitFor, pxFlags->xWaitForAll ) )
+    {
+        /* Notified once, the task reevaluates its condition when it runs. */
+        pxFlags->xWaitingTask = NULL;
+        vTaskNotifyGiveIndexedFromISR( xWaitingTask, portEVENT_FLAGS_NOTIFY_INDEX, pxHigherPriorityTaskWoken );
+    }
+
+    return ulFlags;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulEventFlagsSet( EventFlags_t * pxFlags, uint32_t ulFlagsToSet )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    uint32_t ulFlags;
+
+    portENTER_CRITICAL();
+    {
+        ulFlags = ulEventFlagsSetFromISR( pxFlags, ulFlagsToSet, &xHigherPriorityTaskWoken );
+    }
+    portEXIT_CRITICAL();
+
+    if( pdFALSE != xHigherPriorityTaskWoken )
+    {
+        portYIELD();
+    }
+
+    return ulFlags;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Clears flags and returns the flags before they were cleared.
+ */
+uint32_t ulEventFlagsClear( EventFlags_t * pxFlags, uint32_t ulFlagsToClear )
+{
+    uint32_t ulFlags;
+
+    configASSERT( pxFlags );
+
+    portENTER_CRITICAL();
+    {
+        ulFlags = pxFlags->ulFlags;
+        pxFlags->ulFlags = ulFlags & ~ulFlagsToClear;
+    }
+    portEXIT_CRITICAL();
+
+    return ulFlags;
+}
+/*-----------------------------------------------------------*/
+
+uint32_t ulEventFlagsGet( const EventFlags_t * pxFlags )
+{
+    configASSERT( pxFlags );
+
+    return pxFlags->ulFlags;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Blocks the calling task until any (or all if 'xWaitForAll' equals pdTRUE)
+ * of 'ulWaitFor' flags are set or 'xTicksToWait' expires. The awaited flags
+ * are cleared if the condition is met and 'xClearOnExit' equals pdTRUE.
+ * Returns the flags at the time the condition was met or the wait timed out,
+ * so the caller may test them to tell these cases apart.
+ *
+ * Only one task may wait for the same flags at a time.
+ */
+uint32_t ulEventFlagsWait( EventFlags_t * pxFlags, uint32_t ulWaitFor, BaseType_t xClearOnExit, BaseType_t xWaitForAll, TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+    BaseType_t xTimedOut = ( ( TickType_t ) 0 == xTicksToWait ? pdTRUE : pdFALSE );
+    BaseType_t xBlocked = pdFALSE;
+    BaseType_t xMet;
+    uint32_t ulFlags;
+
+    configASSERT( pxFlags );
+    configASSERT( 0UL != ulWaitFor );
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ; ; )
+    {
+        portENTER_CRITICAL();
+        {
+            ulFlags = pxFlags->ulFlags;
+            xMet = prvConditionMet( ulFlags, ulWaitFor, xWaitForAll );
+
+            if( pdFALSE != xMet || pdFALSE != xTimedOut )
+            {
+                if( pdFALSE != xMet && pdFALSE != xClearOnExit )
+                {
+                    pxFlags->ulFlags = ulFlags & ~ulWaitFor;
+                }
+
+                pxFlags->xWaitingTask = NULL;
+
+                /* A notification may have been given just after the wait timed out. */
+                if( pdFALSE != xBlocked )
+                {
+                    ( void ) xTaskNotifyStateClearIndexed( NULL, portEVENT_FLAGS_NOTIFY_INDEX );
+                    ( void ) ulTaskNotifyValueClearIndexed( NULL, portEVENT_FLAGS_NOTIFY_INDEX, 0xFFFFFFFFUL );
+                }
+            }
+            else
+            {
+                /* Only one task may wait for the flags. */
+                configASSERT( NULL == pxFlags->xWaitingTask || xTaskGetCurrentTaskHandle() == pxFlags->xWaitingTask );
+
+                pxFlags->xWaitingTask = xTaskGetCurrentTaskHandle();
+                pxFlags->ulWaitFor = ulWaitFor;
+                pxFlags->xWaitForAll = xWaitForAll;
+            }
+        }
+        portEXIT_CRITICAL();
+
+        if( pdFALSE != xMet || pdFALSE != xTimedOut )
+        {
+            break;
+        }
+
+        /* A stale notification only causes another evaluation of the condition. */
+        ( void ) ulTaskNotifyTakeIndexed( portEVENT_FLAGS_NOTIFY_INDEX, pdTRUE, xTicksToWait );
+        xBlocked = pdTRUE;
+        xTimedOut = xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait );
+    }
+
+    return ulFlags;
+}
+/*-----------------------------------------------------------*/
+
+#endif  /* configUSE_EVENT_FLAGS == 1 */
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ *
+ * Event flags that may be set by ISRs in bounded time.
+ *
+ * xEventGroupSetBitsFromISR() defers setting of bits to the timer daemon
+ * task, as an event group may have any number of waiting tasks. When
+ * configUSE_EVENT_FLAGS is set to 1 (in FreeRTOSConfig.h), this module
+ * provides a lighter alternative with at most one waiting task per set of
+ * flags. Setting flags (from an ISR or a task) therefore only evaluates a
+ * single wait condition and wakes up the waiting task directly via its
+ * direct notification with the index portEVENT_FLAGS_NOTIFY_INDEX, so an
+ * event costs a single context switch and no daemon task is necessary.
+ *
+ * A waiting task may request any or all of the flags it waits for and may
+ * clear them when its condition is met. Flags are only cleared by the
+ * waiting task (or by ulEventFlagsClear()), not at the time they are set.
+ *
+ * Flags are allocated by the application (e.g. statically) and must be
+ * initialized by vEventFlagsInit() before use.
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _EVENT_FLAGS_H_
+#define _EVENT_FLAGS_H_
+
+#include <stdint.h>
+
+
+#ifndef configUSE_EVENT_FLAGS
+    #define configUSE_EVENT_FLAGS    0
+#endif
+
+
+#if ( configUSE_EVENT_FLAGS == 1 )
+
+    /*
+     * Index of the direct notification that wakes up the waiting task.
+     * It must be reserved for event flags as ulEventFlagsWait() consumes
+     * and clears any notification, given to this index. Index 0 is left
+     * to the application, so FreeRTOSConfig.h must set another one.
+     */
+    #ifndef portEVENT_FLAGS_NOTIFY_INDEX
+        #error portEVENT_FLAGS_NOTIFY_INDEX must be set in FreeRTOSConfig.h!
+    #endif
+
+    typedef struct xEVENT_FLAGS
+    {
+        volatile uint32_t ulFlags;      /* Currently set flags. */
+        TaskHandle_t xWaitingTask;      /* The only task waiting for flags, NULL if none. */
+        uint32_t ulWaitFor;             /* Flags the waiting task waits for. */
+        BaseType_t xWaitForAll;         /* pdTRUE if all of ulWaitFor must be set, pdFALSE if any. */
+    } EventFlags_t;
+
+    void vEventFlagsInit( EventFlags_t * pxFlags );
+
+    uint32_t ulEventFlagsSet( EventFlags_t * pxFlags, uint32_t ulFlagsToSet );
+
+    uint32_t ulEventFlagsSetFromISR( EventFlags_t * pxFlags, uint32_t ulFlagsToSet, BaseType_t * pxHigherPriorityTaskWoken );
+
+    uint32_t ulEventFlagsClear( EventFlags_t * pxFlags, uint32_t ulFlagsToClear );
+
+    uint32_t ulEventFlagsGet( const EventFlags_t * pxFlags );
+
+    uint32_t ulEventFlagsWait( EventFlags_t * pxFlags, uint32_t ulWaitFor, BaseType_t xClearOnExit, BaseType_t xWaitForAll, TickType_t xTicksToWait );
+
+#endif  /* configUSE_EVENT_FLAGS == 1 */
+
+#endif  /* _EVENT_FLAGS_H_ */
@@ -0,0 +1,465 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ *
+ * Implementation of software timers, backed by a hardware counter,
+ * and of delays of tasks with a microsecond resolution.
+ *
+ * See hrtimer.h for more details.
+ *
+ * @author Jernej Kovacic
+ */
+
+
+#include <stddef.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+#include "bsp.h"
+#include "interrupt.h"
+#include "timer.h"
+#include "timebase.h"
+#include "tick_timer_settings.h"
+#include "hrtimer.h"
+
+
+#if ( configUSE_HR_TIMER == 1 )
+
+#if portHR_TIMER >= BSP_NR_TIMERS
+#error Invalid timer selected!
+#endif
+
+#if portHR_TIMER_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES
+#error Invalid index of the direct notification!
+#endif
+
+/* Period of a tick in microseconds. */
+#define portTICK_PERIOD_US              ( ( uint32_t ) ( BSP_TIMER_CLOCK_HZ / configTICK_RATE_HZ ) )
+
+/* Maximum delay (in microseconds) that can be compared as a difference of counts. */
+#define portHR_TIMER_MAX_DELAY          ( 0x7FFFFFFFUL )
+
+/* Active timers, ordered by their deadlines. */
+static HrTimer_t * pxActiveTimers = NULL;
+
+/* Expired soft timers, waiting for the daemon task. */
+static QueueHandle_t xExpiredQueue = NULL;
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    /* Storage of the daemon task and its queue, reserved at link time. */
+    static StaticTask_t xHrTimerTaskTCB;
+    static StackType_t uxHrTimerTaskStack[ configHR_TIMER_TASK_STACK_DEPTH ];
+    static StaticQueue_t xExpiredQueueBuffer;
+    static uint8_t ucExpiredQueueStorage[ configHR_TIMER_QUEUE_LENGTH * sizeof( HrTimer_t * ) ];
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Has the deadline been reached at the count 'ulNow'?
+ */
+static inline BaseType_t prvExpired( uint32_t ulDeadline, uint32_t ulNow )
+{
+    return ( ( int32_t ) ( ulDeadline - ulNow ) <= 0 ? pdTRUE : pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Programs the one shot counter to expire at the nearest deadline
+ * or stops it if no timer is active.
+ *
+ * Must be called with disabled interrupts.
+ */
+static void prvProgramCounter( void )
+{
+    int32_t lDelay;
+
+    timer_stop( portHR_TIMER, portHR_TIMER_COUNTER );
+
+    if( NULL != pxActiveTimers )
+    {
+        lDelay = ( int32_t ) ( pxActiveTimers->ulDeadline - timebase_getCounter() );
+
+        /* The counter must not be loaded with 0. A missed deadline expires at once. */
+        if( lDelay <= 0 )
+        {
+            lDelay = 1;
+        }
+
+        /* Writing the Load Register also reloads the counter. */
+        timer_setLoad( portHR_TIMER, portHR_TIMER_COUNTER, ( uint32_t ) lDelay );
+        timer_start( portHR_TIMER, portHR_TIMER_COUNTER );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Inserts the timer into the list of active timers, after all timers
+ * with the same or an earlier deadline.
+ *
+ * Must be called with disabled interrupts.
+ */
+static void prvInsert( HrTimer_t * pxTimer, uint32_t ulNow )
+{
+    HrTimer_t ** ppxPos = &pxActiveTimers;
+    const uint32_t ulDelay = pxTimer->ulDeadline - ulNow;
+
+    /* Deadlines are compared relative to the current count. */
+    while( NULL != *ppxPos && ( ( *ppxPos )->ulDeadline - ulNow ) <= ulDelay )
+    {
+        ppxPos = &( ( *ppxPos )->pxNext );
+    }
+
+    pxTimer->pxNext = *ppxPos;
+    *ppxPos = pxTimer;
+    pxTimer->xActive = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Removes the timer from the list of active timers.
+ *
+ * Must be called with disabled interrupts.
+ */
+static void prvRemove( HrTimer_t * pxTimer )
+{
+    HrTimer_t ** ppxPos = &pxActiveTimers;
+
+    while( NULL != *ppxPos && pxTimer != *ppxPos )
+    {
+        ppxPos = &( ( *ppxPos )->pxNext );
+    }
+
+    if( NULL != *ppxPos )
+    {
+        *ppxPos = pxTimer->pxNext;
+    }
+
+    pxTimer->pxNext = NULL;
+    pxTimer->xActive = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * ISR of the one shot counter. It dispatches all expired timers
+ * and programs the next deadline.
+ */
+static void prvHrTimerISR( void )
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    HrTimer_t * pxTimer;
+    uint32_t ulNow;
+
+    timer_clearInterrupt( portHR_TIMER, portHR_TIMER_COUNTER );
+
+    ulNow = timebase_getCounter();
+
+    while( NULL != pxActiveTimers && pdFALSE != prvExpired( pxActiveTimers->ulDeadline, ulNow ) )
+    {
+        pxTimer = pxActiveTimers;
+        pxActiveTimers = pxTimer->pxNext;
+        pxTimer->pxNext = NULL;
+        pxTimer->xActive = pdFALSE;
+
+        /* Periodic timers are reinserted first, so their callbacks may stop them. */
+        if( 0UL != pxTimer->ulPeriod )
+        {
+            pxTimer->ulDeadline += pxTimer->ulPeriod;
+
+            while( pdFALSE != prvExpired( pxTimer->ulDeadline, ulNow ) )
+            {
+                pxTimer->ulDeadline += pxTimer->ulPeriod;
+                pxTimer->ulOverruns++;
+            }
+
+            prvInsert( pxTimer, ulNow );
+        }
+
+        if( pdFALSE != pxTimer->xHard )
+        {
+            pxTimer->pxCallback( pxTimer, &xHigherPriorityTaskWoken );
+        }
+        else if( pdTRUE != xQueueSendToBackFromISR( xExpiredQueue, &pxTimer, &xHigherPriorityTaskWoken ) )
+        {
+            pxTimer->ulMissed++;
+        }
+
+        /* Callbacks might take a while. */
+        ulNow = timebase_getCounter();
+    }
+
+    prvProgramCounter();
+
+    /* The whole context is saved on IRQ entry, so a switch is possible here. */
+    if( pdFALSE != xHigherPriorityTaskWoken )
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * The daemon task that executes callbacks of expired soft timers.
+ */
+static void prvHrTimerTask( void * pvParameters )
+{
+    HrTimer_t * pxTimer;
+    BaseType_t xDummy;
+
+    ( void ) pvParameters;
+
+    for( ; ; )
+    {
+        if( pdTRUE == xQueueReceive( xExpiredQueue, &pxTimer, portMAX_DELAY ) )
+        {
+            xDummy = pdFALSE;
+            pxTimer->pxCallback( pxTimer, &xDummy );
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Creates the daemon task and its queue of expired timers.
+ * Called by vTaskStartScheduler() before the scheduler is started.
+ */
+BaseType_t xPortHrTimerCreateTask( void )
+{
+    BaseType_t xReturn = pdFAIL;
+
+    #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+    {
+        xExpiredQueue = xQueueCreateStatic( configHR_TIMER_QUEUE_LENGTH, sizeof( HrTimer_t * ),
+                                            ucExpiredQueueStorage, &xExpiredQueueBuffer );
+
+        if( ( NULL != xExpiredQueue ) &&
+            ( NULL != xTaskCreateStatic( prvHrTimerTask, "hrtimer", configHR_TIMER_TASK_STACK_DEPTH,
+                                         NULL, configHR_TIMER_TASK_PRIORITY,
+                                         uxHrTimerTaskStack, &xHrTimerTaskTCB ) ) )
+        {
+            xReturn = pdPASS;
+        }
+    }
+    #else
+    {
+        xExpiredQueue = xQueueCreate( configHR_TIMER_QUEUE_LENGTH, sizeof( HrTimer_t * ) );
+
+        if( NULL != xExpiredQueue )
+        {
+            xReturn = xTaskCreate( prvHrTimerTask, "hrtimer", configHR_TIMER_TASK_STACK_DEPTH,
+                                   NULL, configHR_TIMER_TASK_PRIORITY, NULL );
+        }
+    }
+    #endif /* configSUPPORT_STATIC_ALLOCATION */
+
+    configASSERT( xReturn );
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Configures the one shot counter and its IRQ.
+ * Called when the scheduler is started.
+ */
+void vPortHrTimerInit( void )
+{
+    const uint8_t irqs[ BSP_NR_TIMERS ] = BSP_TIMER_IRQS;
+    const uint8_t irq = irqs[ portHR_TIMER ];
+
+    timer_init( portHR_TIMER, portHR_TIMER_COUNTER );
+    timer_setOneShot( portHR_TIMER, portHR_TIMER_COUNTER, 1 );
+    timer_enableInterrupt( portHR_TIMER, portHR_TIMER_COUNTER );
+
+    pic_registerIrq( irq, &prvHrTimerISR, portHR_TIMER_IRQ_PRIORITY, PIC_NO_BUDGET );
+    pic_enableInterrupt( irq );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Initializes an inactive timer.
+ */
+void vHrTimerInit( HrTimer_t * pxTimer, HrTimerCallback_t pxCallback, void * pvContext, BaseType_t xHard )
+{
+    configASSERT( pxTimer );
+
+    pxTimer->pxNext = NULL;
+    pxTimer->ulDeadline = 0UL;
+    pxTimer->ulPeriod = 0UL;
+    pxTimer->pxCallback = pxCallback;
+    pxTimer->pvContext = pvContext;
+    pxTimer->xHard = xHard;
+    pxTimer->xActive = pdFALSE;
+    pxTimer->ulOverruns = 0UL;
+    pxTimer->ulMissed = 0UL;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Starts (or restarts) the timer from the IRQ context, i.e. with disabled interrupts.
+ * It expires after 'ulDelayUs' microseconds and then every 'ulPeriodUs'
+ * microseconds, unless 'ulPeriodUs' equals 0.
+ */
+BaseType_t xHrTimerStartFromISR( HrTimer_t * pxTimer, uint32_t ulDelayUs, uint32_t ulPeriodUs )
+{
+    uint32_t ulNow;
+
+    if( NULL == pxTimer || NULL == pxTimer->pxCallback ||
+        ulDelayUs > portHR_TIMER_MAX_DELAY || ulPeriodUs > portHR_TIMER_MAX_DELAY )
+    {
+        return pdFAIL;
+    }
+
+    if( pdFALSE != pxTimer->xActive )
+    {
+        prvRemove( pxTimer );
+    }
+
+    ulNow = timebase_getCounter();
+    pxTimer->ulDeadline = ulNow + ulDelayUs;
+    pxTimer->ulPeriod = ulPeriodUs;
+    prvInsert( pxTimer, ulNow );
+
+    /* Reprogram the counter only if the nearest deadline has changed. */
+    if( pxActiveTimers == pxTimer )
+    {
+        prvProgramCounter();
+    }
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xHrTimerStart( HrTimer_t * pxTimer, uint32_t ulDelayUs, uint32_t ulPeriodUs )
+{
+    BaseType_t xReturn;
+
+    portENTER_CRITICAL();
+    {
+        xReturn = xHrTimerStartFromISR( pxTimer, ulDelayUs, ulPeriodUs );
+    }
+    portEXIT_CRITICAL();
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Stops the timer from the IRQ context, i.e. with disabled interrupts.
+ * An expiry of a soft timer, already waiting for the daemon task, is not cancelled.
+ */
+void vHrTimerStopFromISR( HrTimer_t * pxTimer )
+{
+    if( NULL != pxTimer && pdFALSE != pxTimer->xActive )
+    {
+        prvRemove( pxTimer );
+
+        /* The counter might have been programmed for this timer. */
+        prvProgramCounter();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vHrTimerStop( HrTimer_t * pxTimer )
+{
+    portENTER_CRITICAL();
+    {
+        vHrTimerStopFromISR( pxTimer );
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xHrTimerIsActive( const HrTimer_t * pxTimer )
+{
+    return ( NULL != pxTimer ? pxTimer->xActive : pdFALSE );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Callback of the hard timer that wakes up a task delayed by vTaskDelayUs().
+ */
+static void prvDelayExpired( HrTimer_t * pxTimer, BaseType_t * pxHigherPriorityTaskWoken )
+{
+    vTaskNotifyGiveIndexedFromISR( ( TaskHandle_t ) pxTimer->pvContext,
+                                   portHR_TIMER_NOTIFY_INDEX,
+                                   pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Delays the calling task for (at least) the specified number of microseconds.
+ * The delay must be shorter than 2^31 microseconds (approximately 35 minutes).
+ */
+void vTaskDelayUs( uint32_t ulMicroseconds )
+{
+    const uint32_t ulDeadline = timebase_getCounter() + ulMicroseconds;
+    int32_t lRemaining;
+    HrTimer_t xTimer;
+
+    /* Sleep through whole ticks first. */
+    for( ; ; )
+    {
+        lRemaining = ( int32_t ) ( ulDeadline - timebase_getCounter() );
+
+        if( lRemaining < ( int32_t ) portTICK_PERIOD_US )
+        {
+            break;
+        }
+
+        /* Wakes up on a tick boundary, i.e. not later than the deadline. */
+        vTaskDelay( ( TickType_t ) ( ( uint32_t ) lRemaining / portTICK_PERIOD_US ) );
+    }
+
+    if( lRemaining <= 0 )
+    {
+        return;
+    }
+
+    if( lRemaining < ( int32_t ) portHR_TIMER_MIN_US )
+    {
+        delay_us( ( uint32_t ) lRemaining );
+        return;
+    }
+
+    vHrTimerInit( &xTimer, prvDelayExpired, ( void * ) xTaskGetCurrentTaskHandle(), pdTRUE );
+
+    /* Discard any stale notification, so the wait below cannot end prematurely. */
+    ( void ) ulTaskNotifyTakeIndexed( portHR_TIMER_NOTIFY_INDEX, pdTRUE, 0 );
+
+    portENTER_CRITICAL();
+    {
+        /* A deadline, missed meanwhile, expires at once. */
+        lRemaining = ( int32_t ) ( ulDeadline - timebase_getCounter() );
+        ( void ) xHrTimerStartFromISR( &xTimer, ( lRemaining > 0 ? ( uint32_t ) lRemaining : 0UL ), 0UL );
+    }
+    portEXIT_CRITICAL();
+
+    ( void ) ulTaskNotifyTakeIndexed( portHR_TIMER_NOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_HR_TIMER == 1 */
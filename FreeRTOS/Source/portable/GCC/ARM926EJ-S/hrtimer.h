@@ -0,0 +1,147 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ *
+ * Software timers, backed by a hardware counter, with a microsecond resolution.
+ *
+ * When configUSE_HR_TIMER is set to 1 (in FreeRTOSConfig.h), active timers
+ * are kept in a list, ordered by their deadlines. The nearest deadline is
+ * programmed into a counter in one shot mode (see tick_timer_settings.h),
+ * so expiries are independent of the tick rate.
+ *
+ * On expiry, a timer's callback is dispatched either:
+ * - directly in the IRQ context ("hard" timers), so the callback must only
+ *   call *FromISR API functions, or
+ * - in the timer daemon task ("soft" timers) with the priority
+ *   configHR_TIMER_TASK_PRIORITY, where any API function may be called.
+ *
+ * Timers are allocated by the application (e.g. statically) and must not
+ * be modified, except via functions below, while they are active.
+ * Deadlines are compared as differences of 32-bit counts, so delays and
+ * periods must be shorter than 2^31 microseconds (approximately 35 minutes).
+ *
+ * vTaskDelayUs() blocks the calling task for whole ticks first
+ * (see vTaskDelay()), the remainder, shorter than a tick, is timed by
+ * a hard timer that wakes up the task via its direct notification with
+ * the index portHR_TIMER_NOTIFY_INDEX. Remainders, shorter than
+ * portHR_TIMER_MIN_US, are busy waited, as blocking would take longer.
+ *
+ * All times are measured by the time base (see timebase.h).
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _HRTIMER_H_
+#define _HRTIMER_H_
+
+#include <stdint.h>
+
+
+#ifndef configUSE_HR_TIMER
+    #define configUSE_HR_TIMER    0
+#endif
+
+/*
+ * Remainders of delays (in microseconds), shorter than this value,
+ * are busy waited. It should exceed the time necessary to block
+ * a task and to switch it in again.
+ */
+#ifndef portHR_TIMER_MIN_US
+    #define portHR_TIMER_MIN_US   ( 50UL )
+#endif
+
+
+#if ( configUSE_HR_TIMER == 1 )
+
+    /* Priority of the daemon task that executes callbacks of soft timers */
+    #ifndef configHR_TIMER_TASK_PRIORITY
+        #define configHR_TIMER_TASK_PRIORITY       ( configMAX_PRIORITIES - 1 )
+    #endif
+
+    #ifndef configHR_TIMER_TASK_STACK_DEPTH
+        #define configHR_TIMER_TASK_STACK_DEPTH    ( configMINIMAL_STACK_SIZE * 2 )
+    #endif
+
+    /* Number of expired soft timers that may wait for the daemon task */
+    #ifndef configHR_TIMER_QUEUE_LENGTH
+        #define configHR_TIMER_QUEUE_LENGTH        ( 8 )
+    #endif
+
+    /* Index of the direct notification, reserved for vTaskDelayUs() */
+    #ifndef portHR_TIMER_NOTIFY_INDEX
+        #define portHR_TIMER_NOTIFY_INDEX          ( configTASK_NOTIFICATION_ARRAY_ENTRIES - 1 )
+    #endif
+
+    struct xHR_TIMER;
+
+    /*
+     * Prototype of timers' callbacks. A callback of a hard timer is executed
+     * in the IRQ context and must set *pxHigherPriorityTaskWoken to pdTRUE
+     * if it unblocks a task with a higher priority (as *FromISR functions do).
+     */
+    typedef void ( * HrTimerCallback_t )( struct xHR_TIMER * pxTimer, BaseType_t * pxHigherPriorityTaskWoken );
+
+    typedef struct xHR_TIMER
+    {
+        struct xHR_TIMER * pxNext;      /* Next active timer with a later deadline. */
+        uint32_t ulDeadline;            /* Count of the time base when the timer expires. */
+        uint32_t ulPeriod;              /* Period in microseconds, 0 for one shot timers. */
+        HrTimerCallback_t pxCallback;   /* Called when the timer expires. */
+        void * pvContext;               /* Arbitrary data, available to the callback. */
+        BaseType_t xHard;               /* pdTRUE if the callback is executed in the IRQ context. */
+        BaseType_t xActive;             /* pdTRUE while the timer is in the list of active timers. */
+        uint32_t ulOverruns;            /* Number of periods, skipped as they expired in the past. */
+        uint32_t ulMissed;              /* Number of expiries, lost as the daemon's queue was full. */
+    } HrTimer_t;
+
+    /*
+     * Creates the daemon and its queue of expired timers.  Called by
+     * vTaskStartScheduler() before the scheduler is started, like
+     * xTimerCreateTimerTask().
+     */
+    BaseType_t xPortHrTimerCreateTask( void );
+
+    /*
+     * Sets up the timer and its IRQ.  Called by xPortStartScheduler().
+     */
+    void vPortHrTimerInit( void );
+
+    void vHrTimerInit( HrTimer_t * pxTimer, HrTimerCallback_t pxCallback, void * pvContext, BaseType_t xHard );
+
+    BaseType_t xHrTimerStart( HrTimer_t * pxTimer, uint32_t ulDelayUs, uint32_t ulPeriodUs );
+
+    BaseType_t xHrTimerStartFromISR( HrTimer_t * pxTimer, uint32_t ulDelayUs, uint32_t ulPeriodUs );
+
+    void vHrTimerStop( HrTimer_t * pxTimer );
+
+    void vHrTimerStopFromISR( HrTimer_t * pxTimer );
+
+    BaseType_t xHrTimerIsActive( const HrTimer_t * pxTimer );
+
+    void vTaskDelayUs( uint32_t ulMicroseconds );
+
+#endif
+
+
+#endif  /* _HRTIMER_H_ */
@@ -0,0 +1,331 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+/**
+ * @file
+ *
+ * Implementation of synchronous send/receive/reply IPC channels.
+ *
+ * See ipc_channel.h for more details.
+ *
+ * @author Jernej Kovacic
+ */
+
+
+#include <stddef.h>
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "ipc_channel.h"
+#include "event_flags.h"
+#include "hrtimer.h"
+
+
+#if ( configUSE_IPC_CHANNELS == 1 )
+
+#if ( portIPC_NOTIFY_INDEX == 0 ) || ( portIPC_NOTIFY_INDEX >= configTASK_NOTIFICATION_ARRAY_ENTRIES )
+#error Invalid index of the direct notification!
+#endif
+
+#if ( configUSE_HR_TIMER == 1 ) && ( portIPC_NOTIFY_INDEX == portHR_TIMER_NOTIFY_INDEX )
+#error The direct notification is already reserved for vTaskDelayUs()!
+#endif
+
+#if ( configUSE_EVENT_FLAGS == 1 ) && ( portIPC_NOTIFY_INDEX == portEVENT_FLAGS_NOTIFY_INDEX )
+#error The direct notification is already reserved for event flags!
+#endif
+
+#if ( INCLUDE_vTaskPrioritySet != 1 ) || ( INCLUDE_uxTaskPriorityGet != 1 ) || ( INCLUDE_xTaskGetCurrentTaskHandle != 1 )
+#error IPC channels require INCLUDE_vTaskPrioritySet, INCLUDE_uxTaskPriorityGet and INCLUDE_xTaskGetCurrentTaskHandle
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Sets the server's priority to the highest of its own priority and
+ * priorities of all clients it is serving or that are waiting for it.
+ * Must be called from a critical section. If the server's priority is
+ * lowered, the kernel switches to a higher priority task (typically the
+ * client that has just been replied to) as soon as the section is left.
+ */
+static void prvUpdateServerPriority( IpcChannel_t * pxChannel )
+{
+    UBaseType_t uxPriority;
+
+    if( NULL == pxChannel->xServer )
+    {
+        /* The server is not known yet, it will update its priority on its first receive. */
+        return;
+    }
+
+    uxPriority = pxChannel->uxServerPriority;
+
+    /* Clients are sorted by priorities, so the first one is the most urgent. */
+    if( NULL != pxChannel->pxWaiting && pxChannel->pxWaiting->uxPriority > uxPriority )
+    {
+        uxPriority = pxChannel->pxWaiting->uxPriority;
+    }
+
+    if( NULL != pxChannel->pxServing && pxChannel->pxServing->uxPriority > uxPriority )
+    {
+        uxPriority = pxChannel->pxServing->uxPriority;
+    }
+
+    if( uxTaskPriorityGet( pxChannel->xServer ) != uxPriority )
+    {
+        vTaskPrioritySet( pxChannel->xServer, uxPriority );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vIpcChannelInit( IpcChannel_t * pxChannel )
+{
+    configASSERT( pxChannel );
+
+    pxChannel->pxWaiting = NULL;
+    pxChannel->pxServing = NULL;
+    pxChannel->xServer = NULL;
+    pxChannel->uxServerPriority = tskIDLE_PRIORITY;
+    pxChannel->xServerBlocked = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Sends a request to the channel's server and blocks until the server
+ * replies. The request is copied directly into the server's buffer, the
+ * reply (truncated to *pxReplyLength bytes) directly into 'pvReply'.
+ * Meanwhile the server runs at least at the caller's priority.
+ *
+ * On return, *pxReplyLength holds the number of bytes actually copied
+ * to 'pvReply'. Returns the status, passed by the server to vIpcReply().
+ *
+ * Must not be called by the channel's server.
+ */
+int32_t lIpcSend( IpcChannel_t * pxChannel, const void * pvMessage, size_t xMessageLength, void * pvReply, size_t * pxReplyLength )
+{
+    IpcRequest_t xRequest;
+    IpcRequest_t ** ppxPrev;
+    TaskHandle_t xServer = NULL;
+
+    configASSERT( pxChannel );
+    configASSERT( NULL != pvMessage || 0 == xMessageLength );
+
+    xRequest.xClient = xTaskGetCurrentTaskHandle();
+    xRequest.uxPriority = uxTaskPriorityGet( NULL );
+    xRequest.pvMessage = pvMessage;
+    xRequest.xMessageLength = xMessageLength;
+    xRequest.pvReply = pvReply;
+    xRequest.xReplyLength = ( ( NULL != pvReply && NULL != pxReplyLength ) ? *pxReplyLength : 0 );
+    xRequest.lStatus = 0;
+    xRequest.xReplied = pdFALSE;
+
+    portENTER_CRITICAL();
+    {
+        configASSERT( xRequest.xClient != pxChannel->xServer );
+
+        /* Insert the request behind all clients with the same or higher priority. */
+        ppxPrev = &pxChannel->pxWaiting;
+
+        while( NULL != *ppxPrev && ( *ppxPrev )->uxPriority >= xRequest.uxPriority )
+        {
+            ppxPrev = &( *ppxPrev )->pxNext;
+        }
+
+        xRequest.pxNext = *ppxPrev;
+        *ppxPrev = &xRequest;
+
+        /* Donate the priority, so the notification below switches directly to the server. */
+        prvUpdateServerPriority( pxChannel );
+
+        if( pdFALSE != pxChannel->xServerBlocked )
+        {
+            pxChannel->xServerBlocked = pdFALSE;
+            xServer = pxChannel->xServer;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    portEXIT_CRITICAL();
+
+    if( NULL != xServer )
+    {
+        ( void ) xTaskNotifyGiveIndexed( xServer, portIPC_NOTIFY_INDEX );
+    }
+
+    /* The request must remain on the stack until the reply has been copied. */
+    while( pdFALSE == xRequest.xReplied )
+    {
+        ( void ) ulTaskNotifyTakeIndexed( portIPC_NOTIFY_INDEX, pdTRUE, portMAX_DELAY );
+    }
+
+    if( NULL != pxReplyLength )
+    {
+        *pxReplyLength = xRequest.xReplyLength;
+    }
+
+    return xRequest.lStatus;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Blocks the calling task (the channel's server) until a client sends
+ * a request or 'xTicksToWait' expires. The most urgent request is copied
+ * (truncated to 'xBufferSize' bytes) into 'pvBuffer' and its full length
+ * is written to *pxMessageLength.
+ *
+ * Returns the identifier of the request, that must be passed to
+ * vIpcReply(), or NULL if the wait timed out.
+ */
+IpcReceiveId_t xIpcReceive( IpcChannel_t * pxChannel, void * pvBuffer, size_t xBufferSize, size_t * pxMessageLength, TickType_t xTicksToWait )
+{
+    TimeOut_t xTimeOut;
+    BaseType_t xTimedOut = ( ( TickType_t ) 0 == xTicksToWait ? pdTRUE : pdFALSE );
+    BaseType_t xBlocked = pdFALSE;
+    IpcRequest_t * pxRequest;
+
+    configASSERT( pxChannel );
+    configASSERT( NULL != pvBuffer || 0 == xBufferSize );
+
+    vTaskSetTimeOutState( &xTimeOut );
+
+    for( ; ; )
+    {
+        portENTER_CRITICAL();
+        {
+            /* Only one task may serve the channel and it must have replied to its previous request. */
+            configASSERT( NULL == pxChannel->xServer || xTaskGetCurrentTaskHandle() == pxChannel->xServer );
+            configASSERT( NULL == pxChannel->pxServing );
+
+            if( NULL == pxChannel->xServer )
+            {
+                pxChannel->xServer = xTaskGetCurrentTaskHandle();
+                pxChannel->uxServerPriority = uxTaskPriorityGet( NULL );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            pxRequest = pxChannel->pxWaiting;
+
+            if( NULL != pxRequest )
+            {
+                pxChannel->pxWaiting = pxRequest->pxNext;
+                pxChannel->pxServing = pxRequest;
+                pxChannel->xServerBlocked = pdFALSE;
+                prvUpdateServerPriority( pxChannel );
+            }
+            else
+            {
+                pxChannel->xServerBlocked = ( pdFALSE == xTimedOut ? pdTRUE : pdFALSE );
+            }
+
+            if( ( NULL != pxRequest || pdFALSE != xTimedOut ) && pdFALSE != xBlocked )
+            {
+                /* A notification may have been given just after the wait timed out. */
+                ( void ) xTaskNotifyStateClearIndexed( NULL, portIPC_NOTIFY_INDEX );
+                ( void ) ulTaskNotifyValueClearIndexed( NULL, portIPC_NOTIFY_INDEX, 0xFFFFFFFFUL );
+            }
+        }
+        portEXIT_CRITICAL();
+
+        if( NULL != pxRequest || pdFALSE != xTimedOut )
+        {
+            break;
+        }
+
+        /* A stale notification only causes another check for waiting clients. */
+        ( void ) ulTaskNotifyTakeIndexed( portIPC_NOTIFY_INDEX, pdTRUE, xTicksToWait );
+        xBlocked = pdTRUE;
+        xTimedOut = xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait );
+    }
+
+    if( NULL != pxRequest )
+    {
+        /* The client is blocked until it is replied to, so its request may be read without a lock. */
+        memcpy( pvBuffer, pxRequest->pvMessage,
+                ( pxRequest->xMessageLength < xBufferSize ? pxRequest->xMessageLength : xBufferSize ) );
+
+        if( NULL != pxMessageLength )
+        {
+            *pxMessageLength = pxRequest->xMessageLength;
+        }
+    }
+
+    return pxRequest;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Copies the reply (truncated to the size of the client's reply buffer)
+ * directly to the client, unblocks it and returns the server to its own
+ * priority (or the priority of the most urgent waiting client). If the
+ * client has a higher priority than the server now, the kernel switches
+ * directly to the client.
+ */
+void vIpcReply( IpcChannel_t * pxChannel, IpcReceiveId_t xReceiveId, int32_t lStatus, const void * pvReply, size_t xReplyLength )
+{
+    TaskHandle_t xClient;
+
+    configASSERT( pxChannel );
+    configASSERT( NULL != xReceiveId && xReceiveId == pxChannel->pxServing );
+    configASSERT( NULL != pvReply || 0 == xReplyLength );
+
+    if( xReplyLength < xReceiveId->xReplyLength )
+    {
+        xReceiveId->xReplyLength = xReplyLength;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    memcpy( xReceiveId->pvReply, pvReply, xReceiveId->xReplyLength );
+    xReceiveId->lStatus = lStatus;
+
+    portENTER_CRITICAL();
+    {
+        /* The request is gone (from the client's stack) as soon as the client runs. */
+        xClient = xReceiveId->xClient;
+        xReceiveId->xReplied = pdTRUE;
+        pxChannel->pxServing = NULL;
+
+        ( void ) xTaskNotifyGiveIndexed( xClient, portIPC_NOTIFY_INDEX );
+        prvUpdateServerPriority( pxChannel );
+    }
+    portEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+#endif  /* configUSE_IPC_CHANNELS == 1 */
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+/**
+ * @file
+ *
+ * Synchronous send/receive/reply IPC channels.
+ *
+ * A request/response exchange over two queues copies the request into
+ * the request queue and out of it, the response likewise, and takes at
+ * least four context switches. When configUSE_IPC_CHANNELS is set to 1
+ * (in FreeRTOSConfig.h), this module provides a rendezvous in the QNX
+ * style instead:
+ *
+ * - A client calls lIpcSend() and stays blocked until the server replies.
+ *   Its request and reply buffers remain on its own stack meanwhile.
+ * - The server's xIpcReceive() copies the request directly from the
+ *   client's buffer into the server's buffer.
+ * - vIpcReply() copies the reply directly into the client's reply buffer
+ *   and wakes up the client.
+ *
+ * So each message is copied once. While a client is waiting for the
+ * server, the server runs at least at the client's priority (priority
+ * donation). Hence the send switches directly to the server and the
+ * reply switches directly back to the client, and a medium priority task
+ * cannot delay a high priority client by preempting a low priority server.
+ * Waiting clients are served in the order of their priorities.
+ *
+ * Each channel has a single server task, it must reply to a request
+ * before it receives the next one. The server's priority must not be
+ * changed by other means while it serves a channel.
+ *
+ * Channels are allocated by the application (e.g. statically) and must be
+ * initialized by vIpcChannelInit() before use.
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _IPC_CHANNEL_H_
+#define _IPC_CHANNEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#ifndef configUSE_IPC_CHANNELS
+    #define configUSE_IPC_CHANNELS    0
+#endif
+
+
+#if ( configUSE_IPC_CHANNELS == 1 )
+
+    /*
+     * Index of the direct notification that wakes up clients and servers.
+     * It must be reserved for IPC channels as a server, waiting for requests,
+     * consumes and clears any notification, given to this index. Index 0
+     * is left to the application, so FreeRTOSConfig.h must set another one.
+     */
+    #ifndef portIPC_NOTIFY_INDEX
+        #error portIPC_NOTIFY_INDEX must be set in FreeRTOSConfig.h!
+    #endif
+
+    /* A pending request, kept on the client's stack while it is blocked. */
+    typedef struct xIPC_REQUEST
+    {
+        struct xIPC_REQUEST * pxNext;   /* Next waiting client of the channel. */
+        TaskHandle_t xClient;           /* The client task. */
+        UBaseType_t uxPriority;         /* The client's priority, donated to the server. */
+        const void * pvMessage;         /* The client's request. */
+        size_t xMessageLength;
+        void * pvReply;                 /* The client's reply buffer. */
+        size_t xReplyLength;            /* Size of the reply buffer, then the reply's length. */
+        int32_t lStatus;                /* Status, passed by the server's reply. */
+        volatile BaseType_t xReplied;   /* pdTRUE when the reply has been copied. */
+    } IpcRequest_t;
+
+    /* Identifies a received request when the server replies to it. */
+    typedef IpcRequest_t * IpcReceiveId_t;
+
+    typedef struct xIPC_CHANNEL
+    {
+        IpcRequest_t * pxWaiting;       /* Clients waiting to be received, by priority. */
+        IpcRequest_t * pxServing;       /* The received request not replied yet, NULL if none. */
+        TaskHandle_t xServer;           /* The server, NULL until it receives for the first time. */
+        UBaseType_t uxServerPriority;   /* The server's own priority. */
+        BaseType_t xServerBlocked;      /* pdTRUE while the server waits for a client. */
+    } IpcChannel_t;
+
+    void vIpcChannelInit( IpcChannel_t * pxChannel );
+
+    int32_t lIpcSend( IpcChannel_t * pxChannel, const void * pvMessage, size_t xMessageLength, void * pvReply, size_t * pxReplyLength );
+
+    IpcReceiveId_t xIpcReceive( IpcChannel_t * pxChannel, void * pvBuffer, size_t xBufferSize, size_t * pxMessageLength, TickType_t xTicksToWait );
+
+    void vIpcReply( IpcChannel_t * pxChannel, IpcReceiveId_t xReceiveId, int32_t lStatus, const void * pvReply, size_t xReplyLength );
+
+#endif  /* configUSE_IPC_CHANNELS == 1 */
+
+#endif  /* _IPC_CHANNEL_H_ */
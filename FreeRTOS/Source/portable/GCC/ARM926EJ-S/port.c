@@ -55,12 +55,18 @@
 /* Scheduler includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+
+#if ( ( configSUPPORT_STATIC_ALLOCATION == 1 ) && ( configUSE_TIMERS == 1 ) )
+    #include "timers.h"
+#endif
 
 /* Includes for functions to peripherals' drivers: */
 #include "bsp.h"
 #include "interrupt.h"
 #include "timer.h"
+#include "timebase.h"
 #include "tick_timer_settings.h"
+#include "hrtimer.h"
 
 /* Constants required to setup the task context. */
 /* System mode, ARM mode, IRQ enabled, FIQ disabled */
@@ -82,6 +88,16 @@ static void prvSetupTimerInterrupt( void );
  */
 extern void vPortISRStartFirstTask( void );
 
+#if ( configUSE_CRITICAL_STATS == 1 )
+    /* Starts the free running counter, defined in critical_stats.c */
+    extern void vPortCriticalStatsInit( void );
+#endif
+
+#if ( configUSE_TASK_STATS == 1 )
+    /* Starts measurement of tasks, defined in task_stats.c */
+    extern void vPortTaskStatsInit( void );
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -171,6 +187,21 @@ BaseType_t xPortStartScheduler( void )
     here already. */
     prvSetupTimerInterrupt();
 
+    /* Start the free running counter (unless already started by the application). */
+    timebase_init( portFREE_RUNNING_TIMER, portFREE_RUNNING_COUNTER );
+
+    #if ( configUSE_HR_TIMER == 1 )
+        vPortHrTimerInit();
+    #endif
+
+    #if ( configUSE_CRITICAL_STATS == 1 )
+        vPortCriticalStatsInit();
+    #endif
+
+    #if ( configUSE_TASK_STATS == 1 )
+        vPortTaskStatsInit();
+    #endif
+
     /* Start the first task. */
     vPortISRStartFirstTask();
 
@@ -225,7 +256,7 @@ static void prvSetupTimerInterrupt( void )
     timer_enableInterrupt(portTICK_TIMER, portTICK_TIMER_COUNTER);
 
     /* Configure the VIC to service IRQ4 (triggered by the timer) properly */
-    pic_registerIrq(irq, &vTickISR, PIC_MAX_PRIORITY);
+    pic_registerIrq(irq, &vTickISR, PIC_MAX_PRIORITY, PIC_NO_BUDGET);
 
     /* Enable servicing of IRQ4 */
     pic_enableInterrupt(irq);
@@ -238,3 +269,44 @@ static void prvSetupTimerInterrupt( void )
 
 }
 /*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+/*
+ * Memory of the idle task, reserved at link time. The kernel obtains it
+ * when the scheduler is started, so the idle task needs no heap.
+ */
+void vApplicationGetIdleTaskMemory( StaticTask_t ** ppxIdleTaskTCBBuffer,
+                                    StackType_t ** ppxIdleTaskStackBuffer,
+                                    uint32_t * pulIdleTaskStackSize )
+{
+    static StaticTask_t xIdleTaskTCB;
+    static StackType_t uxIdleTaskStack[ configMINIMAL_STACK_SIZE ];
+
+    *ppxIdleTaskTCBBuffer = &xIdleTaskTCB;
+    *ppxIdleTaskStackBuffer = uxIdleTaskStack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TIMERS == 1 )
+
+/*
+ * Memory of the timer service task, reserved at link time.
+ */
+void vApplicationGetTimerTaskMemory( StaticTask_t ** ppxTimerTaskTCBBuffer,
+                                     StackType_t ** ppxTimerTaskStackBuffer,
+                                     uint32_t * pulTimerTaskStackSize )
+{
+    static StaticTask_t xTimerTaskTCB;
+    static StackType_t uxTimerTaskStack[ configTIMER_TASK_STACK_DEPTH ];
+
+    *ppxTimerTaskTCBBuffer = &xTimerTaskTCB;
+    *ppxTimerTaskStackBuffer = uxTimerTaskStack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TIMERS */
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
@@ -67,12 +67,13 @@
 #include "FreeRTOS.h"
 
 #include "timer.h"
+#include "timebase.h"
 #include "tick_timer_settings.h"
 
 
 /* Constants required to handle critical sections. */
 #define portNO_CRITICAL_NESTING		( ( uint32_t) 0 )
-volatile unsigned long ulCriticalNesting = 9999UL;
+volatile uint32_t ulCriticalNesting = 9999UL;
 
 /*-----------------------------------------------------------*/
 
@@ -112,15 +113,28 @@ void vPortYieldProcessor( void )
     /* Perform the context switch.  First save the context of the current task. */
     portSAVE_CONTEXT();
 
+#if ( configUSE_CRITICAL_STATS == 1 )
+    /* The task may yield from within a critical section. */
+    __asm volatile ( "bl vPortCriticalStatsYield" );
+#endif
+
     /* Find the highest priority task that is ready to run. */
     __asm volatile ( "bl vTaskSwitchContext" );
 
+#if ( configUSE_CRITICAL_STATS == 1 )
+    __asm volatile ( "bl vPortCriticalStatsSwitched" );
+#endif
+
     /* Restore the context of the new task. */
     portRESTORE_CONTEXT();
 }
 /*-----------------------------------------------------------*/
 
 extern void _pic_IrqHandler(void);
+
+#if ( configUSE_CRITICAL_STATS == 1 )
+extern void vPortCriticalStatsSwitched( void );
+#endif
 
 /*
  * When an IRQ exception is triggered, it is handled by this function,
@@ -131,6 +145,10 @@ void vFreeRTOS_ISR( void )
 {
     portSAVE_CONTEXT();
     _pic_IrqHandler();
+#if ( configUSE_CRITICAL_STATS == 1 )
+    /* The ISR might have switched to another task. */
+    vPortCriticalStatsSwitched();
+#endif
     portRESTORE_CONTEXT();
 }
 
@@ -158,6 +176,9 @@ void vTickISR( void )
     /* Acknowledge the interrupt on timer */
     timer_clearInterrupt(portTICK_TIMER, portTICK_TIMER_COUNTER);
 
+    /* Detect wraparounds of the free running counter */
+    timebase_update();
+
 }
 
 
@@ -167,7 +188,8 @@ void vTickISR( void )
  * The interrupt management utilities can only be called from ARM mode.  When
  * THUMB_INTERWORK is defined the utilities are defined as functions here to
  * ensure a switch to ARM mode.  When THUMB_INTERWORK is not defined then
- * the utilities are defined as macros in portmacro.h - as per other ports.
+ * the utilities, including vPortEnterCritical() and vPortExitCritical(),
+ * are defined as inline functions in portmacro.h.
  */
 #ifdef THUMB_INTERWORK
 
@@ -201,8 +223,6 @@ void vTickISR( void )
             "BX	    R14" );                 /* Return back to thumb.                    */
     }
 
-#endif /* THUMB_INTERWORK */
-
 /* The code generated by the GCC compiler uses the stack in different ways at
 different optimisation levels.  The interrupt flags can therefore not always
 be saved to the stack.  Instead the critical section nesting level is stored
@@ -250,3 +270,5 @@ void vPortExitCritical( void )
         }
     }
 }
+
+#endif /* THUMB_INTERWORK */
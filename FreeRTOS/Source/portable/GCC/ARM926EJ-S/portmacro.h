@@ -178,12 +178,68 @@ extern volatile uint32_t ulCriticalNesting;                    \
 
 extern void vTaskSwitchContext( void );
 #define portYIELD_FROM_ISR()        vTaskSwitchContext()
-#define portYIELD()                 __asm volatile ( "SWI 0" )
+#define portYIELD()                 __asm volatile ( "SWI 0" : : : "memory" )
 /*-----------------------------------------------------------*/
 
 
 /* Critical section management. */
 
+/*
+ * When configUSE_CRITICAL_STATS is set to 1, the time spent with disabled
+ * IRQs and the time the scheduler is suspended are measured.
+ * See critical_stats.h for more details.
+ */
+#ifndef configUSE_CRITICAL_STATS
+    #define configUSE_CRITICAL_STATS    0
+#endif
+
+#if ( configUSE_CRITICAL_STATS == 1 )
+
+    /* IRQ disable bit of the CPSR */
+    #define portCPSR_IRQ_BIT            ( 0x80UL )
+
+    extern void vPortCriticalStatsMasked( void );
+    extern void vPortCriticalStatsUnmasked( void );
+    extern void vPortCriticalStatsSchedulerSuspended( void * pvCaller );
+    extern void vPortCriticalStatsSchedulerResumed( void );
+
+    #define traceSCHEDULER_SUSPENDED()  vPortCriticalStatsSchedulerSuspended( __builtin_return_address( 0 ) )
+    #define traceSCHEDULER_RESUMED()    vPortCriticalStatsSchedulerResumed()
+
+#endif
+
+/*
+ * When configUSE_TASK_STATS is set to 1, execution and response times
+ * of registered tasks are measured. See task_stats.h for more details.
+ * The hooks are only expanded in tasks.c, where TCBs are accessible.
+ */
+#ifndef configUSE_TASK_STATS
+    #define configUSE_TASK_STATS        0
+#endif
+
+#if ( configUSE_TASK_STATS == 1 )
+
+    #if ( configUSE_APPLICATION_TASK_TAG != 1 )
+        #error configUSE_TASK_STATS requires configUSE_APPLICATION_TASK_TAG to be set to 1
+    #endif
+
+    extern void vPortTaskStatsReady( void * pvTag );
+    extern void vPortTaskStatsSwitchedIn( void * pvTag );
+    extern void vPortTaskStatsSwitchedOut( void * pvTag, BaseType_t xStillReady );
+    extern void vPortTaskStatsDeleted( void * pvTag );
+
+    #define traceMOVED_TASK_TO_READY_STATE( pxTCB )    vPortTaskStatsReady( ( void * ) ( pxTCB )->pxTaskTag )
+    #define traceTASK_SWITCHED_IN()                    vPortTaskStatsSwitchedIn( ( void * ) pxCurrentTCB->pxTaskTag )
+    #define traceTASK_DELETE( pxTCB )                  vPortTaskStatsDeleted( ( void * ) ( pxTCB )->pxTaskTag )
+
+    /* The task has been preempted (or has yielded) if it is still in its ready list. */
+    #define traceTASK_SWITCHED_OUT()                                                        \
+        vPortTaskStatsSwitchedOut( ( void * ) pxCurrentTCB->pxTaskTag,                      \
+                                   listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ), \
+                                                            &( pxCurrentTCB->xStateListItem ) ) )
+
+#endif
+
 /*
  * The interrupt management utilities can only be called from ARM mode.  When
  * THUMB_INTERWORK is defined the utilities are defined as functions in
@@ -199,36 +255,129 @@ extern void vTaskSwitchContext( void );
     #define portDISABLE_INTERRUPTS()    vPortDisableInterruptsFromThumb()
     #define portENABLE_INTERRUPTS()     vPortEnableInterruptsFromThumb()
 
+    extern void vPortEnterCritical( void );
+    extern void vPortExitCritical( void );
+
+    #if ( configUSE_CRITICAL_STATS == 1 )
+        #error configUSE_CRITICAL_STATS is not supported when THUMB_INTERWORK is defined
+    #endif
+
 #else
 
-    #define portDISABLE_INTERRUPTS()                                            \
-        __asm volatile (                                                        \
-            "STMDB  SP!, {R0}       \n\t"   /* Push R0.                     */  \
-            "MRS    R0, CPSR        \n\t"   /* Get CPSR.                    */  \
-            "ORR    R0, R0, #0xC0   \n\t"   /* Disable IRQ, FIQ.            */  \
-            "MSR    CPSR, R0        \n\t"   /* Write back modified value.   */  \
-            "LDMIA  SP!, {R0}           " ) /* Pop R0.                      */
+    /*
+     * The CPSR is modified via a scratch register, allocated by the compiler,
+     * so no register must be pushed to and popped from the stack. Only the
+     * control field (CPSR_c) is written as the flags and other fields remain
+     * unmodified anyway.
+     *
+     * The "memory" clobber makes both functions compiler barriers, i.e. no
+     * memory access will be moved in or out of a section with disabled
+     * interrupts.
+     */
+    static inline void vPortDisableInterrupts( void ) __attribute__ ((always_inline));
+    static inline void vPortDisableInterrupts( void )
+    {
+        uint32_t ulCpsr;
+
+        #if ( configUSE_CRITICAL_STATS == 1 )
+            uint32_t ulPrevCpsr;
+
+            __asm volatile (
+                "MRS    %1, CPSR        \n\t"   /* Get CPSR.                    */
+                "ORR    %0, %1, #0xC0   \n\t"   /* Disable IRQ, FIQ.            */
+                "MSR    CPSR_c, %0          "   /* Write back modified value.   */
+                : "=&r" ( ulCpsr ), "=&r" ( ulPrevCpsr ) : : "memory" );
+
+            /* Only the transition from enabled to disabled IRQs starts a section. */
+            if( 0UL == ( ulPrevCpsr & portCPSR_IRQ_BIT ) )
+            {
+                vPortCriticalStatsMasked();
+            }
+        #else
+            __asm volatile (
+                "MRS    %0, CPSR        \n\t"   /* Get CPSR.                    */
+                "ORR    %0, %0, #0xC0   \n\t"   /* Disable IRQ, FIQ.            */
+                "MSR    CPSR_c, %0          "   /* Write back modified value.   */
+                : "=r" ( ulCpsr ) : : "memory" );
+        #endif
+    }
 
     /*
      * NOTE:
-     * As FIQ is currently not supported, it is not enabled by the macro.
+     * As FIQ is currently not supported, it is not enabled by the function.
      * If this is necessary, replace #0x80 by #0xC0.
      */
-    #define portENABLE_INTERRUPTS()												\
-        __asm volatile (														\
-            "STMDB  SP!, {R0}       \n\t"   /* Push R0.                     */  \
-            "MRS    R0, CPSR        \n\t"   /* Get CPSR.                    */  \
-            "BIC    R0, R0, #0x80   \n\t"   /* Enable IRQ                   */  \
-            "MSR    CPSR, R0        \n\t"   /* Write back modified value.   */  \
-            "LDMIA  SP!, {R0}           " ) /* Pop R0.                      */
+    static inline void vPortEnableInterrupts( void ) __attribute__ ((always_inline));
+    static inline void vPortEnableInterrupts( void )
+    {
+        uint32_t ulCpsr;
 
-#endif /* THUMB_INTERWORK */
+        #if ( configUSE_CRITICAL_STATS == 1 )
+            __asm volatile ( "MRS    %0, CPSR" : "=r" ( ulCpsr ) : : "memory" );
+
+            /* The section ends when IRQs are actually reenabled. */
+            if( 0UL != ( ulCpsr & portCPSR_IRQ_BIT ) )
+            {
+                vPortCriticalStatsUnmasked();
+            }
+        #endif
+
+        __asm volatile (
+            "MRS    %0, CPSR        \n\t"   /* Get CPSR.                    */
+            "BIC    %0, %0, #0x80   \n\t"   /* Enable IRQ.                  */
+            "MSR    CPSR_c, %0          "   /* Write back modified value.   */
+            : "=r" ( ulCpsr ) : : "memory" );
+    }
 
-extern void vPortEnterCritical( void );
-extern void vPortExitCritical( void );
+    #define portDISABLE_INTERRUPTS()    vPortDisableInterrupts()
+    #define portENABLE_INTERRUPTS()     vPortEnableInterrupts()
+
+    /*
+     * The code generated by the GCC compiler uses the stack in different ways at
+     * different optimisation levels.  The interrupt flags can therefore not always
+     * be saved to the stack.  Instead the critical section nesting level is stored
+     * in a variable, which is then saved as part of the stack context.
+     *
+     * Both functions are inlined into the kernel. The nesting counter is read
+     * into a register once, modified there and written back once.
+     */
+    extern volatile uint32_t ulCriticalNesting;
+
+    static inline void vPortEnterCritical( void ) __attribute__ ((always_inline));
+    static inline void vPortEnterCritical( void )
+    {
+        portDISABLE_INTERRUPTS();
+
+        /* Now interrupts are disabled ulCriticalNesting can be accessed
+        directly.  Increment ulCriticalNesting to keep a count of how many times
+        portENTER_CRITICAL() has been called. */
+        ulCriticalNesting = ulCriticalNesting + 1;
+    }
+
+    static inline void vPortExitCritical( void ) __attribute__ ((always_inline));
+    static inline void vPortExitCritical( void )
+    {
+        uint32_t ulNesting = ulCriticalNesting;
+
+        if( ulNesting > 0UL )
+        {
+            /* Decrement the nesting count as we are leaving a critical section. */
+            --ulNesting;
+            ulCriticalNesting = ulNesting;
+
+            /* If the nesting level has reached zero then interrupts should be
+            re-enabled. */
+            if( 0UL == ulNesting )
+            {
+                portENABLE_INTERRUPTS();
+            }
+        }
+    }
+
+#endif /* THUMB_INTERWORK */
 
-#define portENTER_CRITICAL()        vPortEnterCritical();
-#define portEXIT_CRITICAL()         vPortExitCritical();
+#define portENTER_CRITICAL()        vPortEnterCritical()
+#define portEXIT_CRITICAL()         vPortExitCritical()
 /*-----------------------------------------------------------*/
 
 /* Task function macros as described on the FreeRTOS.org WEB site. */
@@ -0,0 +1,241 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+/**
+ * @file
+ *
+ * Implementation of sequence locks and latches.
+ *
+ * See seqlock.h for more details.
+ *
+ * @author Jernej Kovacic
+ */
+
+
+#include <stddef.h>
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "seqlock.h"
+
+
+#if ( configUSE_SEQLOCKS == 1 )
+
+/*-----------------------------------------------------------*/
+
+void vSeqLockInit( SeqLock_t * pxLock )
+{
+    configASSERT( pxLock );
+
+    pxLock->ulSequence = 0UL;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Starts an update of the data from the IRQ context. As IRQs are not
+ * nested, the update cannot be interrupted.
+ */
+void vSeqLockWriteBeginFromISR( SeqLock_t * pxLock )
+{
+    configASSERT( pxLock );
+    configASSERT( 0UL == ( pxLock->ulSequence & 1UL ) );
+
+    pxLock->ulSequence++;
+    portSEQLOCK_BARRIER();
+}
+/*-----------------------------------------------------------*/
+
+void vSeqLockWriteEndFromISR( SeqLock_t * pxLock )
+{
+    configASSERT( pxLock );
+    configASSERT( 0UL != ( pxLock->ulSequence & 1UL ) );
+
+    portSEQLOCK_BARRIER();
+    pxLock->ulSequence++;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Starts an update of the data by a task. The scheduler remains suspended
+ * until vSeqLockWriteEnd(), so the update may only be interrupted by ISRs.
+ */
+void vSeqLockWriteBegin( SeqLock_t * pxLock )
+{
+    vTaskSuspendAll();
+    vSeqLockWriteBeginFromISR( pxLock );
+}
+/*-----------------------------------------------------------*/
+
+void vSeqLockWriteEnd( SeqLock_t * pxLock )
+{
+    vSeqLockWriteEndFromISR( pxLock );
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Copies 'xSize' bytes from 'pvSource' to the protected 'pvData'.
+ */
+void vSeqLockWrite( SeqLock_t * pxLock, void * pvData, const void * pvSource, size_t xSize )
+{
+    vSeqLockWriteBegin( pxLock );
+    memcpy( pvData, pvSource, xSize );
+    vSeqLockWriteEnd( pxLock );
+}
+/*-----------------------------------------------------------*/
+
+void vSeqLockWriteFromISR( SeqLock_t * pxLock, void * pvData, const void * pvSource, size_t xSize )
+{
+    vSeqLockWriteBeginFromISR( pxLock );
+    memcpy( pvData, pvSource, xSize );
+    vSeqLockWriteEndFromISR( pxLock );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Copies a consistent snapshot of 'xSize' bytes of the protected 'pvData'
+ * to 'pvDestination'. The copy is only repeated if an ISR has updated the
+ * data meanwhile. Must not be called by ISRs.
+ */
+void vSeqLockRead( const SeqLock_t * pxLock, void * pvDestination, const void * pvData, size_t xSize )
+{
+    uint32_t ulSequence;
+
+    configASSERT( pxLock );
+
+    do
+    {
+        ulSequence = ulSeqLockReadBegin( pxLock );
+        memcpy( pvDestination, pvData, xSize );
+    } while( pdFALSE != xSeqLockReadRetry( pxLock, ulSequence ) );
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Copies a snapshot of the protected data from the IRQ context. If the ISR
+ * has interrupted an update, it cannot wait for its completion, so pdFAIL is
+ * returned and the contents of 'pvDestination' are undefined. Otherwise the
+ * copy is consistent (nothing can update the data while the ISR runs) and
+ * pdPASS is returned.
+ */
+BaseType_t xSeqLockReadFromISR( const SeqLock_t * pxLock, void * pvDestination, const void * pvData, size_t xSize )
+{
+    uint32_t ulSequence;
+
+    configASSERT( pxLock );
+
+    ulSequence = ulSeqLockReadBegin( pxLock );
+
+    if( 0UL != ( ulSequence & 1UL ) )
+    {
+        return pdFAIL;
+    }
+
+    memcpy( pvDestination, pvData, xSize );
+
+    return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Initializes a latch with two application provided copies of 'xSize' bytes
+ * each. Both are set to 'pvInitial' or zeroed if it equals NULL.
+ */
+void vSeqLatchInit( SeqLatch_t * pxLatch, void * pvCopy0, void * pvCopy1, size_t xSize, const void * pvInitial )
+{
+    configASSERT( pxLatch );
+    configASSERT( pvCopy0 && pvCopy1 );
+
+    vSeqLockInit( &pxLatch->xLock );
+    pxLatch->pvCopy[ 0 ] = pvCopy0;
+    pxLatch->pvCopy[ 1 ] = pvCopy1;
+    pxLatch->xSize = xSize;
+
+    if( NULL != pvInitial )
+    {
+        memcpy( pvCopy0, pvInitial, xSize );
+        memcpy( pvCopy1, pvInitial, xSize );
+    }
+    else
+    {
+        memset( pvCopy0, 0, xSize );
+        memset( pvCopy1, 0, xSize );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Updates both copies, one after another. While copy 0 is being updated,
+ * the sequence number is odd and readers use copy 1, afterwards it is even
+ * and readers use the already updated copy 0 while copy 1 is being updated.
+ */
+void vSeqLatchPublishFromISR( SeqLatch_t * pxLatch, const void * pvSource )
+{
+    configASSERT( pxLatch );
+
+    pxLatch->xLock.ulSequence++;
+    portSEQLOCK_BARRIER();
+    memcpy( pxLatch->pvCopy[ 0 ], pvSource, pxLatch->xSize );
+    portSEQLOCK_BARRIER();
+    pxLatch->xLock.ulSequence++;
+    portSEQLOCK_BARRIER();
+    memcpy( pxLatch->pvCopy[ 1 ], pvSource, pxLatch->xSize );
+}
+/*-----------------------------------------------------------*/
+
+void vSeqLatchPublish( SeqLatch_t * pxLatch, const void * pvSource )
+{
+    vTaskSuspendAll();
+    {
+        vSeqLatchPublishFromISR( pxLatch, pvSource );
+    }
+    ( void ) xTaskResumeAll();
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Copies a consistent snapshot of the data to 'pvDestination' without
+ * waiting for writers. May be called by tasks and ISRs. A task only
+ * repeats the copy if an ISR has published new data meanwhile.
+ */
+void vSeqLatchRead( const SeqLatch_t * pxLatch, void * pvDestination )
+{
+    uint32_t ulSequence;
+
+    configASSERT( pxLatch );
+
+    do
+    {
+        ulSequence = ulSeqLockReadBegin( &pxLatch->xLock );
+        memcpy( pvDestination, pxLatch->pvCopy[ ulSequence & 1UL ], pxLatch->xSize );
+        portSEQLOCK_BARRIER();
+    } while( pxLatch->xLock.ulSequence != ulSequence );
+}
+/*-----------------------------------------------------------*/
+
+#endif  /* configUSE_SEQLOCKS == 1 */
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+
+/**
+ * @file
+ *
+ * Sequence locks for data that is read much more often than written.
+ *
+ * Data shared by tasks and ISRs must otherwise be protected by critical
+ * sections, which delay all interrupts, or by mutexes, which may not be
+ * taken by ISRs. When configUSE_SEQLOCKS is set to 1 (in FreeRTOSConfig.h),
+ * this module provides locks that readers never take:
+ *
+ * - SeqLock_t: a writer increments the sequence number before and after
+ *   an update, so it is odd while the update is in progress. A reader
+ *   notes the sequence number, copies the data and retries if the number
+ *   was odd or has changed meanwhile. A reading task only retries if an
+ *   ISR has updated the data in the meantime. An ISR, however, cannot wait
+ *   for the task it has interrupted, so its read fails instead (see
+ *   xSeqLockReadFromISR()).
+ *
+ * - SeqLatch_t: the data is kept in two copies, updated one after another.
+ *   The sequence number's lowest bit selects the copy that is not being
+ *   updated, so a read always succeeds, even in an ISR that interrupted
+ *   a writer. This suits larger structures, e.g. configuration or state
+ *   snapshots, at the cost of twice the memory and two copies per update.
+ *
+ * Neither readers nor writers disable interrupts. A writing task suspends
+ * the scheduler, so no other task can interrupt its update. Only one kind of
+ * writer is allowed per lock: either tasks or ISRs (whose updates cannot be
+ * interrupted as IRQs are not nested).
+ *
+ * Locks are allocated by the application (e.g. statically) and must be
+ * initialized by vSeqLockInit() or vSeqLatchInit() before use.
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _SEQLOCK_H_
+#define _SEQLOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#ifndef configUSE_SEQLOCKS
+    #define configUSE_SEQLOCKS    0
+#endif
+
+
+#if ( configUSE_SEQLOCKS == 1 )
+
+    /*
+     * The ARM926EJ-S has a single core and executes memory accesses in
+     * program order, so it is sufficient to prevent the compiler from
+     * reordering accesses to the sequence number and the data.
+     */
+    #define portSEQLOCK_BARRIER()    __asm volatile ( "" : : : "memory" )
+
+    typedef struct xSEQLOCK
+    {
+        volatile uint32_t ulSequence;   /* Odd while an update is in progress. */
+    } SeqLock_t;
+
+    typedef struct xSEQLATCH
+    {
+        SeqLock_t xLock;
+        void * pvCopy[ 2 ];             /* Both copies of the data. */
+        size_t xSize;                   /* Size of each copy in bytes. */
+    } SeqLatch_t;
+
+    /*
+     * Returns the sequence number to be passed to xSeqLockReadRetry()
+     * after the data has been read.
+     */
+    static inline uint32_t ulSeqLockReadBegin( const SeqLock_t * pxLock )
+    {
+        uint32_t ulSequence = pxLock->ulSequence;
+
+        portSEQLOCK_BARRIER();
+
+        return ulSequence;
+    }
+
+    /*
+     * Returns pdTRUE if the data, read since ulSeqLockReadBegin() returned
+     * 'ulSequence', may be torn and must be read again, pdFALSE otherwise.
+     */
+    static inline BaseType_t xSeqLockReadRetry( const SeqLock_t * pxLock, uint32_t ulSequence )
+    {
+        portSEQLOCK_BARRIER();
+
+        return ( ( 0UL != ( ulSequence & 1UL ) || pxLock->ulSequence != ulSequence ) ? pdTRUE : pdFALSE );
+    }
+
+    void vSeqLockInit( SeqLock_t * pxLock );
+
+    void vSeqLockWriteBegin( SeqLock_t * pxLock );
+
+    void vSeqLockWriteEnd( SeqLock_t * pxLock );
+
+    void vSeqLockWriteBeginFromISR( SeqLock_t * pxLock );
+
+    void vSeqLockWriteEndFromISR( SeqLock_t * pxLock );
+
+    void vSeqLockWrite( SeqLock_t * pxLock, void * pvData, const void * pvSource, size_t xSize );
+
+    void vSeqLockWriteFromISR( SeqLock_t * pxLock, void * pvData, const void * pvSource, size_t xSize );
+
+    void vSeqLockRead( const SeqLock_t * pxLock, void * pvDestination, const void * pvData, size_t xSize );
+
+    BaseType_t xSeqLockReadFromISR( const SeqLock_t * pxLock, void * pvDestination, const void * pvData, size_t xSize );
+
+    void vSeqLatchInit( SeqLatch_t * pxLatch, void * pvCopy0, void * pvCopy1, size_t xSize, const void * pvInitial );
+
+    void vSeqLatchPublish( SeqLatch_t * pxLatch, const void * pvSource );
+
+    void vSeqLatchPublishFromISR( SeqLatch_t * pxLatch, const void * pvSource );
+
+    void vSeqLatchRead( const SeqLatch_t * pxLatch, void * pvDestination );
+
+#endif  /* configUSE_SEQLOCKS == 1 */
+
+#endif  /* _SEQLOCK_H_ */
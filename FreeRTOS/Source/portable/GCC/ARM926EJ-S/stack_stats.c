@@ -0,0 +1,101 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file
+ *
+ * Implementation of the measurement of operating modes' stack usage.
+ *
+ * See stack_stats.h for more details.
+ *
+ * @author Jernej Kovacic
+ */
+
+
+#include <stddef.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "stack_stats.h"
+
+
+#if ( configUSE_STACK_STATS == 1 )
+
+/* Pattern of unused stack words, also painted by startup.s */
+#define portSTACK_FILL_WORD             ( 0xA5A5A5A5UL )
+
+/* Boundaries of mode stacks, defined in the linker script */
+extern uint32_t svc_stack_bottom[];
+extern uint32_t svc_stack_top[];
+extern uint32_t irq_stack_bottom[];
+extern uint32_t irq_stack_top[];
+extern uint32_t stack_bottom[];
+extern uint32_t stack_top[];
+
+/* A mode's stack occupies [pulBottom, pulTop) and grows downwards */
+typedef struct
+{
+    const char * pcName;
+    const uint32_t * pulBottom;
+    const uint32_t * pulTop;
+} ModeStack_t;
+
+static const ModeStack_t xModeStacks[ eNumberOfModeStacks ] =
+{
+    { "SVC", svc_stack_bottom, svc_stack_top },
+    { "IRQ", irq_stack_bottom, irq_stack_top },
+    { "SYS", stack_bottom,     stack_top     }
+};
+
+/*-----------------------------------------------------------*/
+
+/**
+ * Obtains sizes and high water marks of all mode stacks.
+ *
+ * @param pxStats - array to be filled, indexed by eModeStack
+ */
+void vPortGetModeStackStats( ModeStackStats_t pxStats[ eNumberOfModeStacks ] )
+{
+    const uint32_t * pulWord;
+    UBaseType_t uxStack;
+
+    for( uxStack = 0; uxStack < eNumberOfModeStacks; uxStack++ )
+    {
+        /* The painted words at the bottom have never been overwritten */
+        pulWord = xModeStacks[ uxStack ].pulBottom;
+
+        while( pulWord < xModeStacks[ uxStack ].pulTop && portSTACK_FILL_WORD == *pulWord )
+        {
+            pulWord++;
+        }
+
+        pxStats[ uxStack ].pcName = xModeStacks[ uxStack ].pcName;
+        pxStats[ uxStack ].ulSize = ( uint32_t ) ( xModeStacks[ uxStack ].pulTop - xModeStacks[ uxStack ].pulBottom );
+        pxStats[ uxStack ].ulHighWaterMark = ( uint32_t ) ( pulWord - xModeStacks[ uxStack ].pulBottom );
+    }
+}
+/*-----------------------------------------------------------*/
+
+#endif  /* configUSE_STACK_STATS == 1 */
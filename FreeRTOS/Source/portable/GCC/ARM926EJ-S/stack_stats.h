@@ -0,0 +1,80 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file
+ *
+ * Optional measurement of stack usage of the processor's operating modes.
+ *
+ * When configUSE_STACK_STATS is set to 1 (in FreeRTOSConfig.h), the
+ * high water marks of the Supervisor (used by main() and by yields),
+ * IRQ (used by all ISRs) and System mode's stacks, reserved by the
+ * linker script, can be obtained by vPortGetModeStackStats().
+ *
+ * The startup code paints all mode stacks with the same pattern as the
+ * kernel paints stacks of tasks, hence high water marks of tasks are
+ * obtained by uxTaskGetStackHighWaterMark() as usual (this requires
+ * INCLUDE_uxTaskGetStackHighWaterMark).
+ *
+ * Both are measured at run time and only reflect the deepest paths that
+ * have been executed so far. The static worst case per task entry point
+ * may be estimated by 'make stack_usage' (see stack_usage.py).
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _STACK_STATS_H_
+#define _STACK_STATS_H_
+
+#include <stdint.h>
+
+
+#ifndef configUSE_STACK_STATS
+    #define configUSE_STACK_STATS    0
+#endif
+
+
+#if ( configUSE_STACK_STATS == 1 )
+
+    /* Stacks of operating modes */
+    typedef enum
+    {
+        eStackSupervisor = 0,
+        eStackIrq,
+        eStackSystem,
+        eNumberOfModeStacks
+    } eModeStack;
+
+    /* Usage of a mode's stack */
+    typedef struct xMODE_STACK_STATS
+    {
+        const char * pcName;            /* Name of the operating mode. */
+        uint32_t ulSize;                /* Size of the stack in words. */
+        uint32_t ulHighWaterMark;       /* Words that have never been used. */
+    } ModeStackStats_t;
+
+    void vPortGetModeStackStats( ModeStackStats_t pxStats[ eNumberOfModeStacks ] );
+
+#endif  /* configUSE_STACK_STATS == 1 */
+
+#endif  /* _STACK_STATS_H_ */
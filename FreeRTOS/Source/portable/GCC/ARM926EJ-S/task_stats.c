@@ -0,0 +1,358 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ *
+ * Implementation of the measurement of tasks' execution and response times.
+ *
+ * See task_stats.h for more details.
+ *
+ * @author Jernej Kovacic
+ */
+
+
+#include <stddef.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "timebase.h"
+#include "task_stats.h"
+
+
+#if ( configUSE_TASK_STATS == 1 )
+
+/* List of registered tasks' statistics */
+static TaskStats_t * pxRegistered = NULL;
+
+/* Nothing is recorded until the time base is started */
+static BaseType_t xStarted = pdFALSE;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Clears the accounting of a task, an activation in progress is discarded.
+ */
+static void prvReset( TaskStats_t * pxStats )
+{
+    pxStats->ulActivations = 0;
+    pxStats->ulPreemptions = 0;
+    pxStats->ulMaxPreemptions = 0;
+    pxStats->ulExecMin = UINT32_MAX;
+    pxStats->ulExecMax = 0;
+    pxStats->ullExecTotal = 0;
+    pxStats->ulResponseMin = UINT32_MAX;
+    pxStats->ulResponseMax = 0;
+    pxStats->ullResponseTotal = 0;
+    pxStats->xActive = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Starts a new activation of a task.
+ */
+static inline void prvStartActivation( TaskStats_t * pxStats, uint32_t ulNow )
+{
+    pxStats->ulRelease = ulNow;
+    pxStats->ulExec = 0;
+    pxStats->ulCurrentPreemptions = 0;
+    pxStats->xActive = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Records a completed activation.
+ */
+static void prvCompleteActivation( TaskStats_t * pxStats, uint32_t ulNow )
+{
+    const uint32_t ulResponse = ulNow - pxStats->ulRelease;
+
+    pxStats->ulActivations++;
+    pxStats->ulPreemptions += pxStats->ulCurrentPreemptions;
+
+    if( pxStats->ulCurrentPreemptions > pxStats->ulMaxPreemptions )
+    {
+        pxStats->ulMaxPreemptions = pxStats->ulCurrentPreemptions;
+    }
+
+    pxStats->ullExecTotal += pxStats->ulExec;
+    if( pxStats->ulExec < pxStats->ulExecMin )
+    {
+        pxStats->ulExecMin = pxStats->ulExec;
+    }
+    if( pxStats->ulExec > pxStats->ulExecMax )
+    {
+        pxStats->ulExecMax = pxStats->ulExec;
+    }
+
+    pxStats->ullResponseTotal += ulResponse;
+    if( ulResponse < pxStats->ulResponseMin )
+    {
+        pxStats->ulResponseMin = ulResponse;
+    }
+    if( ulResponse > pxStats->ulResponseMax )
+    {
+        pxStats->ulResponseMax = ulResponse;
+    }
+
+    pxStats->xActive = pdFALSE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Quotient of a 64-bit dividend and a 32-bit divisor, obtained by
+ * shifts and subtractions as the division is not supported natively.
+ * The quotient is assumed to fit into 32 bits.
+ */
+static uint32_t prvDivide( uint64_t ullDividend, uint32_t ulDivisor )
+{
+    uint64_t ullRemainder = 0;
+    uint32_t ulQuotient = 0;
+    uint8_t ucBit;
+
+    if( 0 == ulDivisor )
+    {
+        return 0;
+    }
+
+    /* Only constant shifts of 64-bit values, variable ones would require libgcc */
+    for( ucBit = 0; ucBit < 64; ucBit++ )
+    {
+        ullRemainder = ( ullRemainder << 1 ) | ( ullDividend >> 63 );
+        ullDividend <<= 1;
+        ulQuotient <<= 1;
+
+        if( ullRemainder >= ulDivisor )
+        {
+            ullRemainder -= ulDivisor;
+            ulQuotient |= 1U;
+        }
+    }
+
+    return ulQuotient;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Starts recording. Called when the scheduler is started,
+ * after the time base has been started by timebase_init().
+ */
+void vPortTaskStatsInit( void )
+{
+    xStarted = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by the kernel (traceMOVED_TASK_TO_READY_STATE) when a task
+ * is moved to the Ready state. It releases a new activation unless
+ * one is already in progress (e.g. when the task's priority is changed).
+ */
+void vPortTaskStatsReady( void * pvTag )
+{
+    TaskStats_t * const pxStats = ( TaskStats_t * ) pvTag;
+
+    if( NULL != pxStats && pdFALSE != xStarted && pdFALSE == pxStats->xActive )
+    {
+        prvStartActivation( pxStats, timebase_getCounter() );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by the kernel (traceTASK_SWITCHED_IN) when a task is switched in.
+ */
+void vPortTaskStatsSwitchedIn( void * pvTag )
+{
+    TaskStats_t * const pxStats = ( TaskStats_t * ) pvTag;
+    uint32_t ulNow;
+
+    if( NULL != pxStats && pdFALSE != xStarted )
+    {
+        ulNow = timebase_getCounter();
+
+        /* The task has been released before it was registered or recording started */
+        if( pdFALSE == pxStats->xActive )
+        {
+            prvStartActivation( pxStats, ulNow );
+        }
+
+        pxStats->ulSwitchedIn = ulNow;
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by the kernel (traceTASK_SWITCHED_OUT) when a task is switched out.
+ * If the task is still ready, it has been preempted (or it has yielded),
+ * otherwise its activation is completed.
+ */
+void vPortTaskStatsSwitchedOut( void * pvTag, BaseType_t xStillReady )
+{
+    TaskStats_t * const pxStats = ( TaskStats_t * ) pvTag;
+    uint32_t ulNow;
+
+    if( NULL == pxStats || pdFALSE == xStarted || pdFALSE == pxStats->xActive )
+    {
+        return;
+    }
+
+    ulNow = timebase_getCounter();
+    pxStats->ulExec += ulNow - pxStats->ulSwitchedIn;
+
+    if( pdFALSE != xStillReady )
+    {
+        pxStats->ulCurrentPreemptions++;
+    }
+    else
+    {
+        prvCompleteActivation( pxStats, ulNow );
+    }
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Called by the kernel (traceTASK_DELETE) when a task is deleted.
+ * Its statistics are removed from the list of registered tasks.
+ */
+void vPortTaskStatsDeleted( void * pvTag )
+{
+    TaskStats_t ** ppxStats;
+
+    if( NULL == pvTag )
+    {
+        return;
+    }
+
+    for( ppxStats = &pxRegistered; NULL != *ppxStats; ppxStats = &( ( *ppxStats )->pxNext ) )
+    {
+        if( *ppxStats == ( TaskStats_t * ) pvTag )
+        {
+            *ppxStats = ( *ppxStats )->pxNext;
+            break;
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Registers a task for measurement. Its application task tag is set to
+ * 'pxStats' that must remain valid as long as the task exists.
+ *
+ * May be called before the scheduler is started.
+ *
+ * @param xTask - handle of the task to be measured
+ * @param pxStats - storage for the task's accounting
+ */
+void vPortTaskStatsRegister( TaskHandle_t xTask, TaskStats_t * pxStats )
+{
+    configASSERT( NULL != xTask && NULL != pxStats );
+
+    taskENTER_CRITICAL();
+    {
+        prvReset( pxStats );
+        pxStats->xTask = xTask;
+        pxStats->pxNext = pxRegistered;
+        pxRegistered = pxStats;
+
+        vTaskSetApplicationTaskTag( xTask, ( TaskHookFunction_t ) pxStats );
+    }
+    taskEXIT_CRITICAL();
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Obtains summaries of all registered tasks' statistics.
+ *
+ * @param pxReport - array to be filled with summaries
+ * @param uxMaxTasks - number of elements of 'pxReport'
+ *
+ * @return number of filled summaries
+ */
+UBaseType_t uxPortGetTaskStats( TaskStatsReport_t * pxReport, UBaseType_t uxMaxTasks )
+{
+    const TaskStats_t * pxStats;
+    TaskStats_t xCopy;
+    UBaseType_t uxCount = 0;
+
+    vTaskSuspendAll();
+    {
+        for( pxStats = pxRegistered; NULL != pxStats && uxCount < uxMaxTasks; pxStats = pxStats->pxNext )
+        {
+            /* The kernel hooks may be called from ISRs as well */
+            taskENTER_CRITICAL();
+            {
+                xCopy = *pxStats;
+            }
+            taskEXIT_CRITICAL();
+
+            pxReport->xTask = xCopy.xTask;
+            pxReport->ulActivations = xCopy.ulActivations;
+            pxReport->ulPreemptions = xCopy.ulPreemptions;
+            pxReport->ulMaxPreemptions = xCopy.ulMaxPreemptions;
+
+            if( 0 == xCopy.ulActivations )
+            {
+                pxReport->ulExecMin = 0;
+                pxReport->ulResponseMin = 0;
+            }
+            else
+            {
+                pxReport->ulExecMin = xCopy.ulExecMin;
+                pxReport->ulResponseMin = xCopy.ulResponseMin;
+            }
+
+            pxReport->ulExecMean = prvDivide( xCopy.ullExecTotal, xCopy.ulActivations );
+            pxReport->ulExecMax = xCopy.ulExecMax;
+            pxReport->ulResponseMean = prvDivide( xCopy.ullResponseTotal, xCopy.ulActivations );
+            pxReport->ulResponseMax = xCopy.ulResponseMax;
+
+            pxReport++;
+            uxCount++;
+        }
+    }
+    ( void ) xTaskResumeAll();
+
+    return uxCount;
+}
+/*-----------------------------------------------------------*/
+
+/**
+ * Clears statistics of all registered tasks.
+ */
+void vPortResetTaskStats( void )
+{
+    TaskStats_t * pxStats;
+
+    taskENTER_CRITICAL();
+    {
+        for( pxStats = pxRegistered; NULL != pxStats; pxStats = pxStats->pxNext )
+        {
+            prvReset( pxStats );
+        }
+    }
+    taskEXIT_CRITICAL();
+}
+
+#endif  /* configUSE_TASK_STATS == 1 */
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ *
+ * Optional measurement of tasks' execution and response times.
+ *
+ * When configUSE_TASK_STATS is set to 1 (in FreeRTOSConfig.h), each task,
+ * registered by vPortTaskStatsRegister(), is accounted by its application
+ * task tag (see vTaskSetApplicationTaskTag()) that points to a TaskStats_t.
+ * Hence the tag of a registered task must not be used for anything else.
+ * The kernel hooks are defined in portmacro.h.
+ *
+ * An activation of a task starts when the task is moved to the Ready state
+ * (e.g. when vTaskDelayUntil() or a blocking call returns) and completes when
+ * the task stops running while not being ready anymore (i.e. when it blocks,
+ * suspends or deletes itself). For each completed activation the following
+ * is recorded:
+ * - execution time, i.e. the time the task was actually running,
+ * - response time, i.e. the time from its release until its completion,
+ * - number of preemptions, i.e. how many times the task was switched out
+ *   while it remained ready (this includes yields).
+ *
+ * Times are measured by the time base (see timebase.h) and expressed in
+ * microseconds. Time spent in ISRs is included in execution times of
+ * interrupted tasks.
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _TASK_STATS_H_
+#define _TASK_STATS_H_
+
+#include <stdint.h>
+
+
+#ifndef configUSE_TASK_STATS
+    #define configUSE_TASK_STATS    0
+#endif
+
+
+#if ( configUSE_TASK_STATS == 1 )
+
+    /* Accounting of a task, pointed to by its application task tag */
+    typedef struct xTASK_STATS
+    {
+        struct xTASK_STATS * pxNext;    /* Next registered task. */
+        TaskHandle_t xTask;             /* Handle of the task. */
+
+        uint32_t ulActivations;         /* Number of completed activations. */
+        uint32_t ulPreemptions;         /* Total number of preemptions. */
+        uint32_t ulMaxPreemptions;      /* Most preemptions within one activation. */
+        uint32_t ulExecMin;             /* Shortest execution time. */
+        uint32_t ulExecMax;             /* Longest execution time (WCET). */
+        uint64_t ullExecTotal;          /* Sum of all execution times. */
+        uint32_t ulResponseMin;         /* Shortest response time. */
+        uint32_t ulResponseMax;         /* Longest response time. */
+        uint64_t ullResponseTotal;      /* Sum of all response times. */
+
+        /* State of the current activation */
+        uint32_t ulRelease;             /* When the task was released. */
+        uint32_t ulSwitchedIn;          /* When the task was switched in last time. */
+        uint32_t ulExec;                /* Execution time so far. */
+        uint32_t ulCurrentPreemptions;  /* Preemptions so far. */
+        BaseType_t xActive;             /* pdTRUE while an activation is in progress. */
+    } TaskStats_t;
+
+    /* Summary of a task's statistics */
+    typedef struct xTASK_STATS_REPORT
+    {
+        TaskHandle_t xTask;             /* Handle of the task. */
+        uint32_t ulActivations;
+        uint32_t ulPreemptions;
+        uint32_t ulMaxPreemptions;
+        uint32_t ulExecMin;
+        uint32_t ulExecMean;
+        uint32_t ulExecMax;
+        uint32_t ulResponseMin;
+        uint32_t ulResponseMean;
+        uint32_t ulResponseMax;
+    } TaskStatsReport_t;
+
+    void vPortTaskStatsRegister( TaskHandle_t xTask, TaskStats_t * pxStats );
+
+    UBaseType_t uxPortGetTaskStats( TaskStatsReport_t * pxReport, UBaseType_t uxMaxTasks );
+
+    void vPortResetTaskStats( void );
+
+#endif  /* configUSE_TASK_STATS == 1 */
+
+#endif  /* _TASK_STATS_H_ */
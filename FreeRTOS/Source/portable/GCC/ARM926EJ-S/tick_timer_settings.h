@@ -24,7 +24,7 @@
  * @file
  *
  * Constants in this header define the timer and its counter,
- * used as a tick generator.
+ * used as a tick generator, and the free running counter.
  *
  * @author Jernej Kovacic
  */
@@ -37,5 +37,25 @@
 
 #define portTICK_TIMER_COUNTER       ( 0 )
 
+/*
+ * Timer and its counter, used as a free running counter
+ * that timestamps events (e.g. critical sections).
+ * Its interrupt triggering is never enabled.
+ */
+#define portFREE_RUNNING_TIMER       ( 0 )
+
+#define portFREE_RUNNING_COUNTER     ( 1 )
+
+/*
+ * Timer and its counter in one shot mode, used to time
+ * delays with a microsecond resolution (see hrtimer.h),
+ * and the priority of its IRQ.
+ */
+#define portHR_TIMER                 ( 1 )
+
+#define portHR_TIMER_COUNTER         ( 0 )
+
+#define portHR_TIMER_IRQ_PRIORITY    ( PIC_MAX_PRIORITY - 1 )
+
 
 #endif  /* _TICK_TIMER_SETTINGS_H_ */
@@ -213,6 +213,44 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
                                           size_t xTriggerLevelBytes,
                                           uint8_t ucFlags ) PRIVILEGED_FUNCTION;
 
+/*
+ * Returns xIndex advanced by xCount bytes, wrapped to the buffer's length.
+ */
+static size_t prvNextIndex( const StreamBuffer_t * const pxStreamBuffer,
+                            size_t xIndex,
+                            size_t xCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Describes xCount bytes of the buffer's storage, starting at xStart, as up
+ * to two contiguous regions (the second one if the bytes wrap around).
+ */
+static void prvGetWindow( const StreamBuffer_t * const pxStreamBuffer,
+                          size_t xStart,
+                          size_t xCount,
+                          StreamBufferWindow_t * const pxWindow ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copies the length of a message from or to the buffer at xIndex without
+ * moving the tail or head.  Returns the index of the message's first byte.
+ */
+static size_t prvPeekMessageLength( const StreamBuffer_t * const pxStreamBuffer,
+                                    size_t xIndex,
+                                    configMESSAGE_BUFFER_LENGTH_TYPE * pxLength ) PRIVILEGED_FUNCTION;
+static size_t prvPokeMessageLength( StreamBuffer_t * const pxStreamBuffer,
+                                    size_t xIndex,
+                                    configMESSAGE_BUFFER_LENGTH_TYPE xLength ) PRIVILEGED_FUNCTION;
+
+/*
+ * Moves the head past xCount bytes written into a write window (preceded
+ * by the message's length in case of a message buffer), or the tail past
+ * xCount bytes (or the next message) read from a read window.  Both return
+ * the number of committed or consumed bytes of data.
+ */
+static size_t prvCommitWindow( StreamBuffer_t * const pxStreamBuffer,
+                               size_t xCount ) PRIVILEGED_FUNCTION;
+static size_t prvConsumeWindow( StreamBuffer_t * const pxStreamBuffer,
+                                size_t xCount ) PRIVILEGED_FUNCTION;
+
 /*-----------------------------------------------------------*/
 
 #if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
@@ -1140,6 +1178,447 @@ BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuf
 }
 /*-----------------------------------------------------------*/
 
+size_t xStreamBufferGetWriteWindow( StreamBufferHandle_t xStreamBuffer,
+                                    StreamBufferWindow_t * const pxWindow,
+                                    size_t xBytesWanted,
+                                    TickType_t xTicksToWait )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn, xSpace, xRequiredSpace, xStart;
+    TimeOut_t xTimeOut;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( pxWindow );
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        /* The whole message, preceded by its length, must fit. */
+        xRequiredSpace = xBytesWanted + sbBYTES_TO_STORE_MESSAGE_LENGTH;
+        configASSERT( xRequiredSpace > xBytesWanted );
+    }
+    else
+    {
+        /* Any free space is returned, but the caller may wait for more. */
+        xRequiredSpace = configMIN( xBytesWanted, pxStreamBuffer->xLength - ( size_t ) 1 );
+    }
+
+    xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+    /* The same waiting logic as in xStreamBufferSend(), but only if the
+     * required space can ever become available. */
+    if( ( xTicksToWait != ( TickType_t ) 0 ) && ( xSpace < xRequiredSpace ) && ( xRequiredSpace < pxStreamBuffer->xLength ) )
+    {
+        vTaskSetTimeOutState( &xTimeOut );
+
+        do
+        {
+            taskENTER_CRITICAL();
+            {
+                xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+                if( xSpace < xRequiredSpace )
+                {
+                    /* Clear notification state as going to wait for space. */
+                    ( void ) xTaskNotifyStateClear( NULL );
+
+                    /* Should only be one writer. */
+                    configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+                    pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+                }
+                else
+                {
+                    taskEXIT_CRITICAL();
+                    break;
+                }
+            }
+            taskEXIT_CRITICAL();
+
+            traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer );
+            ( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+            pxStreamBuffer->xTaskWaitingToSend = NULL;
+        } while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
+
+        xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 )
+    {
+        /* The whole free space of a stream buffer starts at the head. */
+        xStart = pxStreamBuffer->xHead;
+        xReturn = xSpace;
+    }
+    else if( ( xBytesWanted > ( size_t ) 0 ) && ( xSpace >= xRequiredSpace ) )
+    {
+        /* The message's length will be written in front of its data. */
+        xStart = prvNextIndex( pxStreamBuffer, pxStreamBuffer->xHead, sbBYTES_TO_STORE_MESSAGE_LENGTH );
+        xReturn = xBytesWanted;
+    }
+    else
+    {
+        xStart = pxStreamBuffer->xHead;
+        xReturn = 0;
+    }
+
+    prvGetWindow( pxStreamBuffer, xStart, xReturn, pxWindow );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferCommit( StreamBufferHandle_t xStreamBuffer,
+                            size_t xBytesWritten )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn;
+
+    configASSERT( pxStreamBuffer );
+
+    xReturn = prvCommitWindow( pxStreamBuffer, xBytesWritten );
+
+    if( xReturn > ( size_t ) 0 )
+    {
+        traceSTREAM_BUFFER_SEND( xStreamBuffer, xReturn );
+
+        /* Was a task waiting for the data? */
+        if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+        {
+            sbSEND_COMPLETED( pxStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+        traceSTREAM_BUFFER_SEND_FAILED( xStreamBuffer );
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+                                   size_t xBytesWritten,
+                                   BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn;
+
+    configASSERT( pxStreamBuffer );
+
+    xReturn = prvCommitWindow( pxStreamBuffer, xBytesWritten );
+
+    if( xReturn > ( size_t ) 0 )
+    {
+        /* Was a task waiting for the data? */
+        if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+        {
+            sbSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    traceSTREAM_BUFFER_SEND_FROM_ISR( xStreamBuffer, xReturn );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferGetReadWindow( StreamBufferHandle_t xStreamBuffer,
+                                   StreamBufferWindow_t * const pxWindow,
+                                   TickType_t xTicksToWait )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn, xBytesAvailable, xBytesToStoreMessageLength, xStart;
+    configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+
+    configASSERT( pxStreamBuffer );
+    configASSERT( pxWindow );
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+    }
+    else
+    {
+        xBytesToStoreMessageLength = 0;
+    }
+
+    /* The same waiting logic as in xStreamBufferReceive(). */
+    if( xTicksToWait != ( TickType_t ) 0 )
+    {
+        taskENTER_CRITICAL();
+        {
+            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+            if( xBytesAvailable <= xBytesToStoreMessageLength )
+            {
+                /* Clear notification state as going to wait for data. */
+                ( void ) xTaskNotifyStateClear( NULL );
+
+                /* Should only be one reader. */
+                configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+                pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+
+        if( xBytesAvailable <= xBytesToStoreMessageLength )
+        {
+            traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
+            ( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+            pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+            /* Recheck the data available after blocking. */
+            xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+    else
+    {
+        xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+    }
+
+    xStart = pxStreamBuffer->xTail;
+
+    if( xBytesAvailable <= xBytesToStoreMessageLength )
+    {
+        xReturn = 0;
+    }
+    else if( xBytesToStoreMessageLength != ( size_t ) 0 )
+    {
+        /* The window only covers the data of the next message. */
+        xStart = prvPeekMessageLength( pxStreamBuffer, xStart, &xMessageLength );
+        xReturn = ( size_t ) xMessageLength;
+    }
+    else
+    {
+        xReturn = xBytesAvailable;
+    }
+
+    prvGetWindow( pxStreamBuffer, xStart, xReturn, pxWindow );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferConsume( StreamBufferHandle_t xStreamBuffer,
+                             size_t xBytesRead )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn;
+
+    configASSERT( pxStreamBuffer );
+
+    xReturn = prvConsumeWindow( pxStreamBuffer, xBytesRead );
+
+    /* Was a task waiting for space in the buffer? */
+    if( xReturn != ( size_t ) 0 )
+    {
+        traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xReturn );
+        sbRECEIVE_COMPLETED( pxStreamBuffer );
+    }
+    else
+    {
+        traceSTREAM_BUFFER_RECEIVE_FAILED( xStreamBuffer );
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferConsumeFromISR( StreamBufferHandle_t xStreamBuffer,
+                                    size_t xBytesRead,
+                                    BaseType_t * const pxHigherPriorityTaskWoken )
+{
+    StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+    size_t xReturn;
+
+    configASSERT( pxStreamBuffer );
+
+    xReturn = prvConsumeWindow( pxStreamBuffer, xBytesRead );
+
+    /* Was a task waiting for space in the buffer? */
+    if( xReturn != ( size_t ) 0 )
+    {
+        sbRECEIVE_COMPLETED_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    traceSTREAM_BUFFER_RECEIVE_FROM_ISR( xStreamBuffer, xReturn );
+
+    return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvCommitWindow( StreamBuffer_t * const pxStreamBuffer,
+                               size_t xCount )
+{
+    size_t xNextHead = pxStreamBuffer->xHead;
+
+    if( xCount > ( size_t ) 0 )
+    {
+        if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+        {
+            /* The data must fit into the window, see xStreamBufferGetWriteWindow(). */
+            configASSERT( ( xCount + sbBYTES_TO_STORE_MESSAGE_LENGTH ) <= xStreamBufferSpacesAvailable( pxStreamBuffer ) );
+            xNextHead = prvPokeMessageLength( pxStreamBuffer, xNextHead, ( configMESSAGE_BUFFER_LENGTH_TYPE ) xCount );
+        }
+        else
+        {
+            configASSERT( xCount <= xStreamBufferSpacesAvailable( pxStreamBuffer ) );
+        }
+
+        /* The reader only sees the length and the data once both are
+         * complete, so the head is only moved once. */
+        pxStreamBuffer->xHead = prvNextIndex( pxStreamBuffer, xNextHead, xCount );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvConsumeWindow( StreamBuffer_t * const pxStreamBuffer,
+                                size_t xCount )
+{
+    size_t xBytesAvailable, xNextTail;
+    configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+
+    xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+    xNextTail = pxStreamBuffer->xTail;
+
+    if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+    {
+        /* The whole next message is always consumed. */
+        if( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+        {
+            xNextTail = prvPeekMessageLength( pxStreamBuffer, xNextTail, &xMessageLength );
+            xCount = ( size_t ) xMessageLength;
+        }
+        else
+        {
+            xCount = 0;
+        }
+    }
+    else
+    {
+        xCount = configMIN( xCount, xBytesAvailable );
+    }
+
+    if( xCount > ( size_t ) 0 )
+    {
+        pxStreamBuffer->xTail = prvNextIndex( pxStreamBuffer, xNextTail, xCount );
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvNextIndex( const StreamBuffer_t * const pxStreamBuffer,
+                            size_t xIndex,
+                            size_t xCount )
+{
+    xIndex += xCount;
+
+    if( xIndex >= pxStreamBuffer->xLength )
+    {
+        xIndex -= pxStreamBuffer->xLength;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    return xIndex;
+}
+/*-----------------------------------------------------------*/
+
+static void prvGetWindow( const StreamBuffer_t * const pxStreamBuffer,
+                          size_t xStart,
+                          size_t xCount,
+                          StreamBufferWindow_t * const pxWindow )
+{
+    size_t xFirstLength;
+
+    /* The first region ends at the end of the storage area at the latest. */
+    xFirstLength = configMIN( pxStreamBuffer->xLength - xStart, xCount );
+
+    pxWindow->pucData[ 0 ] = ( xFirstLength > ( size_t ) 0 ) ? &( pxStreamBuffer->pucBuffer[ xStart ] ) : NULL;
+    pxWindow->xLength[ 0 ] = xFirstLength;
+
+    /* The remainder wraps around to the start of the storage area. */
+    pxWindow->pucData[ 1 ] = ( xCount > xFirstLength ) ? pxStreamBuffer->pucBuffer : NULL;
+    pxWindow->xLength[ 1 ] = xCount - xFirstLength;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvPeekMessageLength( const StreamBuffer_t * const pxStreamBuffer,
+                                    size_t xIndex,
+                                    configMESSAGE_BUFFER_LENGTH_TYPE * pxLength )
+{
+    uint8_t * pucLength = ( uint8_t * ) pxLength;
+    size_t x;
+
+    /* The length may wrap around, it is copied byte by byte. */
+    for( x = 0; x < sbBYTES_TO_STORE_MESSAGE_LENGTH; x++ )
+    {
+        pucLength[ x ] = pxStreamBuffer->pucBuffer[ xIndex ];
+        xIndex = prvNextIndex( pxStreamBuffer, xIndex, 1 );
+    }
+
+    return xIndex;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvPokeMessageLength( StreamBuffer_t * const pxStreamBuffer,
+                                    size_t xIndex,
+                                    configMESSAGE_BUFFER_LENGTH_TYPE xLength )
+{
+    const uint8_t * pucLength = ( const uint8_t * ) &xLength;
+    size_t x;
+
+    for( x = 0; x < sbBYTES_TO_STORE_MESSAGE_LENGTH; x++ )
+    {
+        pxStreamBuffer->pucBuffer[ xIndex ] = pucLength[ x ];
+        xIndex = prvNextIndex( pxStreamBuffer, xIndex, 1 );
+    }
+
+    return xIndex;
+}
+/*-----------------------------------------------------------*/
+
 static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer,
                                      const uint8_t * pucData,
                                      size_t xCount )
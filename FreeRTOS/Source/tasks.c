@@ -38,6 +38,13 @@
 #include "task.h"
 #include "timers.h"
 #include "stack_macros.h"
+#if ( configUSE_HR_TIMER == 1 )
+    #include "hrtimer.h"
+#endif
+
+#if ( configUSE_TIMING_WHEEL == 1 )
+    #include "timing_wheel.h"
+#endif
 
 /* Lint e9021, e961 and e750 are suppressed as a MISRA exception justified
  * because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
@@ -113,6 +120,31 @@
     #define configIDLE_TASK_NAME    "IDLE"
 #endif
 
+#if ( configUSE_EDF_SCHEDULER == 1 )
+
+/* The ready list of configEDF_PRIORITY is sorted by absolute deadlines, so
+ * the task at its head has the earliest deadline.  Tasks of other priorities
+ * share the processor in a round robin fashion. */
+    #define taskSELECT_FROM_READY_LIST( uxPriority )                                                   \
+    {                                                                                                  \
+        if( ( uxPriority ) == ( UBaseType_t ) configEDF_PRIORITY )                                     \
+        {                                                                                              \
+            pxCurrentTCB = listGET_OWNER_OF_HEAD_ENTRY( &( pxReadyTasksLists[ ( uxPriority ) ] ) );    \
+        }                                                                                              \
+        else                                                                                           \
+        {                                                                                              \
+            listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ ( uxPriority ) ] ) );     \
+        }                                                                                              \
+    }
+
+#else /* configUSE_EDF_SCHEDULER */
+
+    #define taskSELECT_FROM_READY_LIST( uxPriority )    listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ ( uxPriority ) ] ) )
+
+#endif /* configUSE_EDF_SCHEDULER */
+
+/*-----------------------------------------------------------*/
+
 #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION == 0 )
 
 /* If configUSE_PORT_OPTIMISED_TASK_SELECTION is 0 then task selection is
@@ -144,7 +176,7 @@
                                                                               \
         /* listGET_OWNER_OF_NEXT_ENTRY indexes through the list, so the tasks of \
          * the  same priority get an equal share of the processor time. */                    \
-        listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) ); \
+        taskSELECT_FROM_READY_LIST( uxTopPriority );                                          \
         uxTopReadyPriority = uxTopPriority;                                                   \
     } /* taskSELECT_HIGHEST_PRIORITY_TASK */
 
@@ -174,7 +206,7 @@
         /* Find the highest priority list that contains ready tasks. */                         \
         portGET_HIGHEST_PRIORITY( uxTopPriority, uxTopReadyPriority );                          \
         configASSERT( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ uxTopPriority ] ) ) > 0 ); \
-        listGET_OWNER_OF_NEXT_ENTRY( pxCurrentTCB, &( pxReadyTasksLists[ uxTopPriority ] ) );   \
+        taskSELECT_FROM_READY_LIST( uxTopPriority );                                            \
     } /* taskSELECT_HIGHEST_PRIORITY_TASK() */
 
 /*-----------------------------------------------------------*/
@@ -212,14 +244,111 @@
 
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_EDF_SCHEDULER == 1 )
+
+/* Absolute deadlines may wrap around with the tick count, so xDeadlineA is
+ * earlier than xDeadlineB when their difference, interpreted as a signed
+ * value, is negative, i.e. when the deadlines are less than half the range of
+ * TickType_t apart. */
+    #define taskDEADLINE_IS_EARLIER( xDeadlineA, xDeadlineB ) \
+    ( ( TickType_t ) ( ( xDeadlineA ) - ( xDeadlineB ) ) > ( ( TickType_t ) portMAX_DELAY >> 1 ) )
+
+/* Tasks of configEDF_PRIORITY are inserted in the order of their absolute
+ * deadlines (see prvInsertByDeadline()), tasks of other priorities are
+ * inserted at the end of the list. */
+    #define taskINSERT_INTO_READY_LIST( pxTCB )                                                              \
+    {                                                                                                        \
+        if( ( pxTCB )->uxPriority == ( UBaseType_t ) configEDF_PRIORITY )                                    \
+        {                                                                                                    \
+            prvInsertByDeadline( pxTCB );                                                                    \
+        }                                                                                                    \
+        else                                                                                                 \
+        {                                                                                                    \
+            vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
+        }                                                                                                    \
+    }
+
+/* Within configEDF_PRIORITY the task with the earlier deadline preempts the
+ * running task and the processor is not shared by time slicing. */
+    #define taskEDF_PREEMPTS_CURRENT( pxTCB )                                        \
+    ( ( ( pxTCB )->uxPriority == ( UBaseType_t ) configEDF_PRIORITY ) &&             \
+      ( pxCurrentTCB->uxPriority == ( UBaseType_t ) configEDF_PRIORITY ) &&          \
+      ( taskRUNNING_PRIORITY() == ( UBaseType_t ) configEDF_PRIORITY ) &&            \
+      ( taskDEADLINE_IS_EARLIER( ( pxTCB )->xAbsoluteDeadline, pxCurrentTCB->xAbsoluteDeadline ) ) )
+
+    #define taskIS_ROUND_ROBIN_PRIORITY( uxPriority )    ( ( uxPriority ) != ( UBaseType_t ) configEDF_PRIORITY )
+
+#else /* configUSE_EDF_SCHEDULER */
+
+    #define taskINSERT_INTO_READY_LIST( pxTCB )             vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) )
+    #define taskEDF_PREEMPTS_CURRENT( pxTCB )               ( pdFALSE )
+    #define taskIS_ROUND_ROBIN_PRIORITY( uxPriority )       ( pdTRUE )
+
+#endif /* configUSE_EDF_SCHEDULER */
+
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+/* While a task runs, its priority is effectively raised to its preemption
+ * threshold, so only tasks of priorities above the threshold can preempt it. */
+    #define taskHOLDS_THRESHOLD( pxTCB )    ( ( pxTCB )->uxPreemptionThreshold > ( pxTCB )->uxPriority )
+    #define taskRUNNING_PRIORITY()          ( taskHOLDS_THRESHOLD( pxCurrentTCB ) ? pxCurrentTCB->uxPreemptionThreshold : pxCurrentTCB->uxPriority )
+
+    #if ( configUSE_PORT_OPTIMISED_TASK_SELECTION != 0 )
+        #error configUSE_PREEMPTION_THRESHOLD requires the generic task selection
+    #endif
+
+#else /* configUSE_PREEMPTION_THRESHOLD */
+
+    #define taskHOLDS_THRESHOLD( pxTCB )    ( pdFALSE )
+    #define taskRUNNING_PRIORITY()          ( pxCurrentTCB->uxPriority )
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+
+#if ( configUSE_TASK_TIME_SLICES == 1 )
+
+/* The running task shares the processor with tasks of its priority only
+ * after it has used its whole time slice. */
+    #define taskTIME_SLICE_EXPIRED()    ( xTimeSliceLeft == ( TickType_t ) 0U )
+
+#else
+
+    #define taskTIME_SLICE_EXPIRED()    ( pdTRUE )
+
+#endif /* configUSE_TASK_TIME_SLICES */
+
+/* A task that has just been made ready preempts the running task if its
+ * priority is higher than the running priority (or if it has an earlier
+ * deadline, see above).  The tick interrupt and the resumption of the
+ * scheduler also switch to a task of the same priority (time slicing),
+ * unless the running task holds a preemption threshold or its time slice
+ * has not expired yet. */
+#define taskIS_TIME_SLICED( pxTCB )                                   \
+    ( ( taskIS_ROUND_ROBIN_PRIORITY( ( pxTCB )->uxPriority ) ) &&     \
+      ( !( taskHOLDS_THRESHOLD( pxTCB ) ) ) )
+
+#define taskPREEMPTS_CURRENT( pxTCB )                                 \
+    ( ( ( pxTCB )->uxPriority > taskRUNNING_PRIORITY() ) ||           \
+      ( taskEDF_PREEMPTS_CURRENT( pxTCB ) ) )
+
+#define taskSHARES_OR_PREEMPTS_CURRENT( pxTCB )                       \
+    ( ( taskPREEMPTS_CURRENT( pxTCB ) ) ||                            \
+      ( ( ( pxTCB )->uxPriority == pxCurrentTCB->uxPriority ) &&      \
+        ( taskIS_TIME_SLICED( pxCurrentTCB ) ) &&                     \
+        ( taskTIME_SLICE_EXPIRED() ) ) )
+
+/*-----------------------------------------------------------*/
+
 /*
  * Place the task represented by pxTCB into the appropriate ready list for
- * the task.  It is inserted at the end of the list.
+ * the task.  It is inserted at the end of the list (or by its deadline, see
+ * taskINSERT_INTO_READY_LIST()).
  */
-#define prvAddTaskToReadyList( pxTCB )                                                                 \
-    traceMOVED_TASK_TO_READY_STATE( pxTCB );                                                           \
-    taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );                                                \
-    vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
+#define prvAddTaskToReadyList( pxTCB )                      \
+    traceMOVED_TASK_TO_READY_STATE( pxTCB );                \
+    taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );     \
+    taskINSERT_INTO_READY_LIST( pxTCB );                    \
     tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB )
 /*-----------------------------------------------------------*/
 
@@ -327,6 +456,29 @@ typedef struct tskTaskControlBlock       /* The old naming convention is used to
     #if ( configUSE_POSIX_ERRNO == 1 )
         int iTaskErrno;
     #endif
+
+    #if ( configUSE_TASK_BUDGET == 1 )
+        struct tskTaskControlBlock * pxNextBudgeted; /*< Next task with a budget, see vTaskSetBudget(). */
+        TickType_t xBudget;                          /*< Ticks the task may run at uxServerPriority within each period.  Zero if the task has no budget. */
+        TickType_t xBudgetPeriod;                    /*< Replenishment period of the budget. */
+        TickType_t xBudgetLeft;                      /*< Remaining budget of the current period. */
+        TickType_t xNextReplenishment;               /*< Tick count of the next replenishment. */
+        UBaseType_t uxServerPriority;                /*< Priority of the task while it has some budget left. */
+        UBaseType_t uxBackgroundPriority;            /*< Priority of the task when its budget is exhausted. */
+    #endif
+
+    #if ( configUSE_TASK_TIME_SLICES == 1 )
+        TickType_t xTimeSliceLength; /*< Number of ticks the task may run before it has to share the processor with tasks of the same priority. */
+    #endif
+
+    #if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+        UBaseType_t uxPreemptionThreshold; /*< Only tasks of higher priorities may preempt the task while it is running.  Not effective when lower than uxPriority. */
+    #endif
+
+    #if ( configUSE_EDF_SCHEDULER == 1 )
+        TickType_t xRelativeDeadline; /*< The deadline of each release of the task, relative to the release time. */
+        TickType_t xAbsoluteDeadline; /*< The deadline of the current release, orders the ready list of configEDF_PRIORITY. */
+    #endif
 } tskTCB;
 
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
@@ -348,6 +500,13 @@ PRIVILEGED_DATA static List_t * volatile pxDelayedTaskList;              /*< Poi
 PRIVILEGED_DATA static List_t * volatile pxOverflowDelayedTaskList;      /*< Points to the delayed task list currently being used to hold tasks that have overflowed the current tick count. */
 PRIVILEGED_DATA static List_t xPendingReadyList;                         /*< Tasks that have been readied while the scheduler was suspended.  They will be moved to the ready list when the scheduler is resumed. */
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+/* Delayed tasks are kept in the timing wheel instead of the delayed lists
+ * that remain empty. The wheel is advanced along with xTickCount. */
+    PRIVILEGED_DATA static TimingWheel_t xDelayedTaskWheel;
+#endif
+
 #if ( INCLUDE_vTaskDelete == 1 )
 
     PRIVILEGED_DATA static List_t xTasksWaitingTermination; /*< Tasks that have been deleted - but their memory not yet freed. */
@@ -379,6 +538,31 @@ PRIVILEGED_DATA static UBaseType_t uxTaskNumber = ( UBaseType_t ) 0U;
 PRIVILEGED_DATA static volatile TickType_t xNextTaskUnblockTime = ( TickType_t ) 0U; /* Initialised to portMAX_DELAY before the scheduler starts. */
 PRIVILEGED_DATA static TaskHandle_t xIdleTaskHandle = NULL;                          /*< Holds the handle of the idle task.  The idle task is created automatically when the scheduler is started. */
 
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+/* Tasks that were preempted while holding their preemption thresholds.  Each
+ * task could only be preempted by a task of a priority above the threshold of
+ * the previous one, so the thresholds increase towards the top of the stack
+ * and there cannot be more than configMAX_PRIORITIES of them. */
+    PRIVILEGED_DATA static TCB_t * pxPreemptedHolders[ configMAX_PRIORITIES ];
+    PRIVILEGED_DATA static UBaseType_t uxPreemptedHolders = ( UBaseType_t ) 0U;
+
+#endif
+
+#if ( configUSE_TASK_TIME_SLICES == 1 )
+
+/* Ticks remaining in the time slice of the running task. */
+    PRIVILEGED_DATA static TickType_t xTimeSliceLeft = ( TickType_t ) 0U;
+
+#endif
+
+#if ( configUSE_TASK_BUDGET == 1 )
+
+/* Singly linked list of tasks with budgets, see vTaskSetBudget(). */
+    PRIVILEGED_DATA static TCB_t * pxBudgetedTasks = NULL;
+
+#endif
+
 /* Context switches are held pending while the scheduler is suspended.  Also,
  * interrupts must not manipulate the xStateListItem of a TCB, or any of the
  * lists the xStateListItem can be referenced from, if the scheduler is suspended.
@@ -550,6 +734,57 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
  */
 static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB ) PRIVILEGED_FUNCTION;
 
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+/*
+ * Selects the task to run next, taking preemption thresholds into account.
+ * The running task keeps running while no ready task has a priority above its
+ * threshold.  A task that was preempted while holding its threshold is
+ * resumed before ready tasks of priorities up to its threshold.
+ */
+    static void prvSelectTaskWithThresholds( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * Removes a task that is being deleted from pxPreemptedHolders.
+ */
+    static void prvForgetPreemptedHolder( const TCB_t * pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
+#if ( configUSE_TASK_BUDGET == 1 )
+
+/*
+ * Charges the running task for the elapsed tick and replenishes the budgets
+ * whose periods have expired.  A task that exhausts its budget drops to its
+ * background priority until the next replenishment.  Called from
+ * xTaskIncrementTick(), returns pdTRUE if a context switch is required.
+ */
+    static BaseType_t prvProcessBudgets( const TickType_t xConstTickCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Changes the priority of a task with a budget.  Must be called from a
+ * critical section or from xTaskIncrementTick().
+ */
+    static void prvSetBudgetPriority( TCB_t * pxTCB,
+                                      UBaseType_t uxNewPriority ) PRIVILEGED_FUNCTION;
+
+/*
+ * Removes a task from the list of tasks with budgets.
+ */
+    static void prvUnlinkBudgetedTask( const TCB_t * pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
+#if ( configUSE_EDF_SCHEDULER == 1 )
+
+/*
+ * Inserts a task into the ready list of configEDF_PRIORITY, after all tasks
+ * whose absolute deadlines are not later than its own.
+ */
+    static void prvInsertByDeadline( TCB_t * pxTCB ) PRIVILEGED_FUNCTION;
+
+#endif
+
 /*
  * freertos_tasks_c_additions_init() should only be called if the user definable
  * macro FREERTOS_TASKS_C_ADDITIONS_INIT() is defined, as that is the only macro
@@ -927,6 +1162,34 @@ static void prvInitialiseNewTask( TaskFunction_t pxTaskCode,
         }
     #endif /* configUSE_MUTEXES */
 
+    #if ( configUSE_TASK_BUDGET == 1 )
+        {
+            pxNewTCB->pxNextBudgeted = NULL;
+            pxNewTCB->xBudget = ( TickType_t ) 0U;
+        }
+    #endif /* configUSE_TASK_BUDGET */
+
+    #if ( configUSE_TASK_TIME_SLICES == 1 )
+        {
+            pxNewTCB->xTimeSliceLength = ( TickType_t ) 1U;
+        }
+    #endif /* configUSE_TASK_TIME_SLICES */
+
+    #if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+        {
+            pxNewTCB->uxPreemptionThreshold = tskIDLE_PRIORITY;
+        }
+    #endif /* configUSE_PREEMPTION_THRESHOLD */
+
+    #if ( configUSE_EDF_SCHEDULER == 1 )
+        {
+            /* Until a relative deadline is set, the deadline of a task
+             * equals its creation time or its last release time. */
+            pxNewTCB->xRelativeDeadline = ( TickType_t ) 0U;
+            pxNewTCB->xAbsoluteDeadline = xTickCount;
+        }
+    #endif /* configUSE_EDF_SCHEDULER */
+
     vListInitialiseItem( &( pxNewTCB->xStateListItem ) );
     vListInitialiseItem( &( pxNewTCB->xEventListItem ) );
 
@@ -1128,7 +1391,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
     {
         /* If the created task is of a higher priority than the current task
          * then it should run now. */
-        if( pxCurrentTCB->uxPriority < pxNewTCB->uxPriority )
+        if( taskPREEMPTS_CURRENT( pxNewTCB ) )
         {
             taskYIELD_IF_USING_PREEMPTION();
         }
@@ -1176,6 +1439,18 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                 mtCOVERAGE_TEST_MARKER();
             }
 
+            #if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+                {
+                    prvForgetPreemptedHolder( pxTCB );
+                }
+            #endif
+
+            #if ( configUSE_TASK_BUDGET == 1 )
+                {
+                    prvUnlinkBudgetedTask( pxTCB );
+                }
+            #endif
+
             /* Increment the uxTaskNumber also so kernel aware debuggers can
              * detect that the task lists need re-generating.  This is done before
              * portPRE_TASK_DELETE_HOOK() as in the Windows port that macro will
@@ -1294,6 +1569,14 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
             /* Update the wake time ready for the next call. */
             *pxPreviousWakeTime = xTimeToWake;
 
+            #if ( configUSE_EDF_SCHEDULER == 1 )
+                {
+                    /* The wake time is the next release of the task, which
+                     * also determines its next deadline. */
+                    pxCurrentTCB->xAbsoluteDeadline = xTimeToWake + pxCurrentTCB->xRelativeDeadline;
+                }
+            #endif
+
             if( xShouldDelay != pdFALSE )
             {
                 traceTASK_DELAY_UNTIL( xTimeToWake );
@@ -1304,6 +1587,18 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
             }
             else
             {
+                #if ( configUSE_EDF_SCHEDULER == 1 )
+                    {
+                        /* The release time has already passed, so the task
+                         * remains ready, but its position within the ready
+                         * list depends on the new deadline. */
+                        if( pxCurrentTCB->uxPriority == ( UBaseType_t ) configEDF_PRIORITY )
+                        {
+                            ( void ) uxListRemove( &( pxCurrentTCB->xStateListItem ) );
+                            prvAddTaskToReadyList( pxCurrentTCB );
+                        }
+                    }
+                #endif
                 mtCOVERAGE_TEST_MARKER();
             }
         }
@@ -1345,6 +1640,11 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                  *
                  * This task cannot be in an event list as it is the currently
                  * executing task. */
+                #if ( configUSE_EDF_SCHEDULER == 1 )
+                    {
+                        pxCurrentTCB->xAbsoluteDeadline = xTickCount + xTicksToDelay + pxCurrentTCB->xRelativeDeadline;
+                    }
+                #endif
                 prvAddCurrentTaskToDelayedList( xTicksToDelay, pdFALSE );
             }
             xAlreadyYielded = xTaskResumeAll();
@@ -1401,6 +1701,14 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                 eReturn = eBlocked;
             }
 
+            #if ( configUSE_TIMING_WHEEL == 1 )
+                else if( twheelIS_SLOT( &xDelayedTaskWheel, pxStateList ) )
+                {
+                    /* The task is delayed in the timing wheel. */
+                    eReturn = eBlocked;
+                }
+            #endif
+
             #if ( INCLUDE_vTaskSuspend == 1 )
                 else if( pxStateList == &xSuspendedTaskList )
                 {
@@ -1694,6 +2002,337 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
 #endif /* INCLUDE_vTaskPrioritySet */
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_EDF_SCHEDULER == 1 )
+
+    void vTaskSetDeadline( TaskHandle_t xTask,
+                           TickType_t xRelativeDeadline )
+    {
+        TCB_t * pxTCB;
+        BaseType_t xYieldRequired = pdFALSE;
+
+        taskENTER_CRITICAL();
+        {
+            /* If null is passed in here then it is the deadline of the
+             * calling task that is being set. */
+            pxTCB = prvGetTCBFromHandle( xTask );
+
+            traceTASK_SET_DEADLINE( pxTCB, xRelativeDeadline );
+
+            /* The current release of the task is assumed to start now. */
+            pxTCB->xRelativeDeadline = xRelativeDeadline;
+            pxTCB->xAbsoluteDeadline = xTickCount + xRelativeDeadline;
+
+            /* A ready task of configEDF_PRIORITY must be moved to its new
+             * position within the ready list. */
+            if( ( pxTCB->uxPriority == ( UBaseType_t ) configEDF_PRIORITY ) &&
+                ( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) ) != pdFALSE ) )
+            {
+                /* The list cannot become empty for long, so the top ready
+                 * priority does not need to be reset. */
+                ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+                prvAddTaskToReadyList( pxTCB );
+
+                /* Either the running task's deadline has been postponed or
+                 * the deadline of another task has become earlier. */
+                if( ( pxTCB == pxCurrentTCB ) || ( taskPREEMPTS_CURRENT( pxTCB ) ) )
+                {
+                    xYieldRequired = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            if( ( xYieldRequired != pdFALSE ) && ( xSchedulerRunning != pdFALSE ) )
+            {
+                taskYIELD_IF_USING_PREEMPTION();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+#endif /* configUSE_EDF_SCHEDULER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_EDF_SCHEDULER == 1 )
+
+    TickType_t xTaskGetDeadline( const TaskHandle_t xTask )
+    {
+        TCB_t const * pxTCB;
+        TickType_t xReturn;
+
+        taskENTER_CRITICAL();
+        {
+            pxTCB = prvGetTCBFromHandle( xTask );
+            xReturn = pxTCB->xAbsoluteDeadline;
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+
+#endif /* configUSE_EDF_SCHEDULER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_EDF_SCHEDULER == 1 )
+
+    static void prvInsertByDeadline( TCB_t * pxTCB )
+    {
+        List_t * const pxList = &( pxReadyTasksLists[ configEDF_PRIORITY ] );
+        ListItem_t * const pxNewListItem = &( pxTCB->xStateListItem );
+        ListItem_t * pxIterator;
+
+        listTEST_LIST_INTEGRITY( pxList );
+        listTEST_LIST_ITEM_INTEGRITY( pxNewListItem );
+
+        /* The ready list does not use the item value otherwise. */
+        listSET_LIST_ITEM_VALUE( pxNewListItem, pxTCB->xAbsoluteDeadline );
+
+        /* Unlike vListInsert(), which compares plain item values, the
+         * deadlines are compared relative to each other, so a deadline beyond
+         * an overflow of the tick count is still ordered after the ones before
+         * it.  A task is placed after tasks with the same deadline. */
+        for( pxIterator = ( ListItem_t * ) &( pxList->xListEnd );
+             ( pxIterator->pxNext != ( ListItem_t * ) &( pxList->xListEnd ) ) &&
+             ( taskDEADLINE_IS_EARLIER( pxTCB->xAbsoluteDeadline, listGET_LIST_ITEM_VALUE( pxIterator->pxNext ) ) == pdFALSE );
+             pxIterator = pxIterator->pxNext )
+        {
+            /* There is nothing to do here, just iterating to the wanted
+             * insertion position. */
+        }
+
+        pxNewListItem->pxNext = pxIterator->pxNext;
+        pxNewListItem->pxNext->pxPrevious = pxNewListItem;
+        pxNewListItem->pxPrevious = pxIterator;
+        pxIterator->pxNext = pxNewListItem;
+        pxNewListItem->pxContainer = pxList;
+
+        ( pxList->uxNumberOfItems )++;
+    }
+
+#endif /* configUSE_EDF_SCHEDULER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+    void vTaskSetPreemptionThreshold( TaskHandle_t xTask,
+                                      UBaseType_t uxThreshold )
+    {
+        TCB_t * pxTCB;
+
+        configASSERT( ( uxThreshold < configMAX_PRIORITIES ) );
+
+        /* Ensure the threshold is valid. */
+        if( uxThreshold >= ( UBaseType_t ) configMAX_PRIORITIES )
+        {
+            uxThreshold = ( UBaseType_t ) configMAX_PRIORITIES - ( UBaseType_t ) 1U;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        taskENTER_CRITICAL();
+        {
+            /* If null is passed in here then it is the threshold of the
+             * calling task that is being set. */
+            pxTCB = prvGetTCBFromHandle( xTask );
+
+            traceTASK_SET_PREEMPTION_THRESHOLD( pxTCB, uxThreshold );
+
+            pxTCB->uxPreemptionThreshold = uxThreshold;
+
+            /* A lower threshold of the running task may allow a ready task
+             * to preempt it, which is decided by vTaskSwitchContext(). */
+            if( ( pxTCB == pxCurrentTCB ) && ( xSchedulerRunning != pdFALSE ) )
+            {
+                taskYIELD_IF_USING_PREEMPTION();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+    UBaseType_t uxTaskGetPreemptionThreshold( const TaskHandle_t xTask )
+    {
+        TCB_t const * pxTCB;
+        UBaseType_t uxReturn;
+
+        taskENTER_CRITICAL();
+        {
+            pxTCB = prvGetTCBFromHandle( xTask );
+            uxReturn = ( taskHOLDS_THRESHOLD( pxTCB ) ? pxTCB->uxPreemptionThreshold : pxTCB->uxPriority );
+        }
+        taskEXIT_CRITICAL();
+
+        return uxReturn;
+    }
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGET == 1 )
+
+    void vTaskSetBudget( TaskHandle_t xTask,
+                         TickType_t xBudget,
+                         TickType_t xPeriod,
+                         UBaseType_t uxBackgroundPriority )
+    {
+        TCB_t * pxTCB;
+
+        configASSERT( ( xBudget <= xPeriod ) );
+        configASSERT( ( uxBackgroundPriority < configMAX_PRIORITIES ) );
+
+        taskENTER_CRITICAL();
+        {
+            /* If null is passed in here then it is the budget of the
+             * calling task that is being set. */
+            pxTCB = prvGetTCBFromHandle( xTask );
+
+            traceTASK_SET_BUDGET( pxTCB, xBudget, xPeriod );
+
+            /* A task with an exhausted budget returns to its priority. */
+            if( ( pxTCB->xBudget > ( TickType_t ) 0U ) && ( pxTCB->xBudgetLeft == ( TickType_t ) 0U ) )
+            {
+                prvSetBudgetPriority( pxTCB, pxTCB->uxServerPriority );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            prvUnlinkBudgetedTask( pxTCB );
+
+            if( ( xBudget > ( TickType_t ) 0U ) && ( xPeriod > ( TickType_t ) 0U ) )
+            {
+                #if ( configUSE_MUTEXES == 1 )
+                    pxTCB->uxServerPriority = pxTCB->uxBasePriority;
+                #else
+                    pxTCB->uxServerPriority = pxTCB->uxPriority;
+                #endif
+                pxTCB->uxBackgroundPriority = uxBackgroundPriority;
+                pxTCB->xBudget = xBudget;
+                pxTCB->xBudgetPeriod = xPeriod;
+                pxTCB->xBudgetLeft = xBudget;
+                pxTCB->xNextReplenishment = xTickCount + xPeriod;
+
+                pxTCB->pxNextBudgeted = pxBudgetedTasks;
+                pxBudgetedTasks = pxTCB;
+            }
+            else
+            {
+                pxTCB->xBudget = ( TickType_t ) 0U;
+            }
+
+            /* The running task may have returned to a higher priority. */
+            if( xSchedulerRunning != pdFALSE )
+            {
+                taskYIELD_IF_USING_PREEMPTION();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        taskEXIT_CRITICAL();
+    }
+
+#endif /* configUSE_TASK_BUDGET */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGET == 1 )
+
+    TickType_t xTaskGetBudgetLeft( const TaskHandle_t xTask )
+    {
+        TCB_t const * pxTCB;
+        TickType_t xReturn;
+
+        taskENTER_CRITICAL();
+        {
+            pxTCB = prvGetTCBFromHandle( xTask );
+            xReturn = ( pxTCB->xBudget > ( TickType_t ) 0U ? pxTCB->xBudgetLeft : portMAX_DELAY );
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+
+#endif /* configUSE_TASK_BUDGET */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_TIME_SLICES == 1 )
+
+    void vTaskSetTimeSlice( TaskHandle_t xTask,
+                            TickType_t xTicks )
+    {
+        TCB_t * pxTCB;
+
+        configASSERT( ( xTicks > ( TickType_t ) 0U ) );
+
+        /* A time slice is at least one tick long. */
+        if( xTicks == ( TickType_t ) 0U )
+        {
+            xTicks = ( TickType_t ) 1U;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        taskENTER_CRITICAL();
+        {
+            /* If null is passed in here then it is the time slice of the
+             * calling task that is being set. */
+            pxTCB = prvGetTCBFromHandle( xTask );
+
+            traceTASK_SET_TIME_SLICE( pxTCB, xTicks );
+
+            /* The current slice of the running task is not affected. */
+            pxTCB->xTimeSliceLength = xTicks;
+        }
+        taskEXIT_CRITICAL();
+    }
+
+#endif /* configUSE_TASK_TIME_SLICES */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_TIME_SLICES == 1 )
+
+    TickType_t xTaskGetTimeSlice( const TaskHandle_t xTask )
+    {
+        TCB_t const * pxTCB;
+        TickType_t xReturn;
+
+        taskENTER_CRITICAL();
+        {
+            pxTCB = prvGetTCBFromHandle( xTask );
+            xReturn = pxTCB->xTimeSliceLength;
+        }
+        taskEXIT_CRITICAL();
+
+        return xReturn;
+    }
+
+#endif /* configUSE_TASK_TIME_SLICES */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_vTaskSuspend == 1 )
 
     void vTaskSuspend( TaskHandle_t xTaskToSuspend )
@@ -1871,7 +2510,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                     prvAddTaskToReadyList( pxTCB );
 
                     /* A higher priority task may have just been resumed. */
-                    if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+                    if( taskSHARES_OR_PREEMPTS_CURRENT( pxTCB ) )
                     {
                         /* This yield may not cause the task just resumed to run,
                          * but will leave the lists in the correct state for the
@@ -1939,7 +2578,7 @@ static void prvAddNewTaskToReadyList( TCB_t * pxNewTCB )
                 {
                     /* Ready lists can be accessed so move the task from the
                      * suspended list to the ready list directly. */
-                    if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+                    if( taskSHARES_OR_PREEMPTS_CURRENT( pxTCB ) )
                     {
                         xYieldRequired = pdTRUE;
                     }
@@ -2028,6 +2667,19 @@ void vTaskStartScheduler( void )
         }
     #endif /* configUSE_TIMERS */
 
+    #if ( configUSE_HR_TIMER == 1 )
+        {
+            if( xReturn == pdPASS )
+            {
+                xReturn = xPortHrTimerCreateTask();
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    #endif /* configUSE_HR_TIMER */
+
     if( xReturn == pdPASS )
     {
         /* freertos_tasks_c_additions_init() should only be called if the user
@@ -2056,6 +2708,12 @@ void vTaskStartScheduler( void )
             }
         #endif /* configUSE_NEWLIB_REENTRANT */
 
+        #if ( configUSE_TASK_TIME_SLICES == 1 )
+            {
+                xTimeSliceLeft = pxCurrentTCB->xTimeSliceLength;
+            }
+        #endif
+
         xNextTaskUnblockTime = portMAX_DELAY;
         xSchedulerRunning = pdTRUE;
         xTickCount = ( TickType_t ) configINITIAL_TICK_COUNT;
@@ -2122,6 +2780,11 @@ void vTaskSuspendAll( void )
      * is used to allow calls to vTaskSuspendAll() to nest. */
     ++uxSchedulerSuspended;
 
+    if( uxSchedulerSuspended == ( UBaseType_t ) 1U )
+    {
+        traceSCHEDULER_SUSPENDED();
+    }
+
     /* Enforces ordering for ports and optimised compilers that may otherwise place
      * the above increment elsewhere. */
     portMEMORY_BARRIER();
@@ -2211,6 +2874,8 @@ BaseType_t xTaskResumeAll( void )
 
         if( uxSchedulerSuspended == ( UBaseType_t ) pdFALSE )
         {
+            traceSCHEDULER_RESUMED();
+
             if( uxCurrentNumberOfTasks > ( UBaseType_t ) 0U )
             {
                 /* Move any readied tasks from the pending list into the
@@ -2224,7 +2889,7 @@ BaseType_t xTaskResumeAll( void )
 
                     /* If the moved task has a priority higher than the current
                      * task then a yield must be performed. */
-                    if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+                    if( taskSHARES_OR_PREEMPTS_CURRENT( pxTCB ) )
                     {
                         xYieldPending = pdTRUE;
                     }
@@ -2473,6 +3138,17 @@ char * pcTaskGetName( TaskHandle_t xTaskToQuery ) /*lint !e971 Unqualified char
                 pxTCB = prvSearchForNameWithinSingleList( ( List_t * ) pxOverflowDelayedTaskList, pcNameToQuery );
             }
 
+            #if ( configUSE_TIMING_WHEEL == 1 )
+                {
+                    UBaseType_t uxSlot;
+
+                    for( uxSlot = 0U; ( pxTCB == NULL ) && ( uxSlot < ( UBaseType_t ) twheelNUM_LISTS ); uxSlot++ )
+                    {
+                        pxTCB = prvSearchForNameWithinSingleList( &( xDelayedTaskWheel.xSlots[ uxSlot ] ), pcNameToQuery );
+                    }
+                }
+            #endif
+
             #if ( INCLUDE_vTaskSuspend == 1 )
                 {
                     if( pxTCB == NULL )
@@ -2527,6 +3203,17 @@ char * pcTaskGetName( TaskHandle_t xTaskToQuery ) /*lint !e971 Unqualified char
                 uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxDelayedTaskList, eBlocked );
                 uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), ( List_t * ) pxOverflowDelayedTaskList, eBlocked );
 
+                #if ( configUSE_TIMING_WHEEL == 1 )
+                    {
+                        UBaseType_t uxSlot;
+
+                        for( uxSlot = 0U; uxSlot < ( UBaseType_t ) twheelNUM_LISTS; uxSlot++ )
+                        {
+                            uxTask += prvListTasksWithinSingleList( &( pxTaskStatusArray[ uxTask ] ), &( xDelayedTaskWheel.xSlots[ uxSlot ] ), eBlocked );
+                        }
+                    }
+                #endif
+
                 #if ( INCLUDE_vTaskDelete == 1 )
                     {
                         /* Fill in an TaskStatus_t structure with information on
@@ -2680,7 +3367,7 @@ BaseType_t xTaskCatchUpTicks( TickType_t xTicksToCatchUp )
                         /* Preemption is on, but a context switch should only be
                          *  performed if the unblocked task has a priority that is
                          *  equal to or higher than the currently executing task. */
-                        if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+                        if( taskPREEMPTS_CURRENT( pxTCB ) )
                         {
                             /* Pend the yield to be performed when the scheduler
                              * is unsuspended. */
@@ -2709,9 +3396,12 @@ BaseType_t xTaskCatchUpTicks( TickType_t xTicksToCatchUp )
 BaseType_t xTaskIncrementTick( void )
 {
     TCB_t * pxTCB;
-    TickType_t xItemValue;
     BaseType_t xSwitchRequired = pdFALSE;
 
+    #if ( configUSE_TIMING_WHEEL == 0 )
+        TickType_t xItemValue;
+    #endif
+
     /* Called by the portable layer each time a tick interrupt occurs.
      * Increments the tick then checks to see if the new tick value will cause any
      * tasks to be unblocked. */
@@ -2727,6 +3417,22 @@ BaseType_t xTaskIncrementTick( void )
          * delayed lists if it wraps to 0. */
         xTickCount = xConstTickCount;
 
+        #if ( configUSE_TASK_TIME_SLICES == 1 )
+            {
+                /* The running task has used another tick of its time slice.
+                 * This must be done before any task is unblocked as tasks of
+                 * the same priority only preempt it after the slice. */
+                if( xTimeSliceLeft > ( TickType_t ) 0U )
+                {
+                    xTimeSliceLeft--;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        #endif /* configUSE_TASK_TIME_SLICES */
+
         if( xConstTickCount == ( TickType_t ) 0U ) /*lint !e774 'if' does not always evaluate to false as it is looking for an overflow. */
         {
             taskSWITCH_DELAYED_LISTS();
@@ -2736,94 +3442,154 @@ BaseType_t xTaskIncrementTick( void )
             mtCOVERAGE_TEST_MARKER();
         }
 
-        /* See if this tick has made a timeout expire.  Tasks are stored in
-         * the  queue in the order of their wake time - meaning once one task
-         * has been found whose block time has not expired there is no need to
-         * look any further down the list. */
-        if( xConstTickCount >= xNextTaskUnblockTime )
-        {
-            for( ; ; )
+        #if ( configUSE_TIMING_WHEEL == 1 )
             {
-                if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )
-                {
-                    /* The delayed list is empty.  Set xNextTaskUnblockTime
-                     * to the maximum possible value so it is extremely
-                     * unlikely that the
-                     * if( xTickCount >= xNextTaskUnblockTime ) test will pass
-                     * next time through. */
-                    xNextTaskUnblockTime = portMAX_DELAY; /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
-                    break;
-                }
-                else
+                List_t * pxExpired;
+
+                /* Advance the wheel up to this tick.  It stops at each slot
+                 * with expired timeouts, all tasks in it must be unblocked
+                 * before the wheel can be advanced further. */
+                while( ( pxExpired = pxTimingWheelAdvance( &xDelayedTaskWheel, xConstTickCount ) ) != NULL )
                 {
-                    /* The delayed list is not empty, get the value of the
-                     * item at the head of the delayed list.  This is the time
-                     * at which the task at the head of the delayed list must
-                     * be removed from the Blocked state. */
-                    pxTCB = listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
-                    xItemValue = listGET_LIST_ITEM_VALUE( &( pxTCB->xStateListItem ) );
-
-                    if( xConstTickCount < xItemValue )
+                    while( listLIST_IS_EMPTY( pxExpired ) == pdFALSE )
                     {
-                        /* It is not time to unblock this item yet, but the
-                         * item value is the time at which the task at the head
-                         * of the blocked list must be removed from the Blocked
-                         * state -  so record the item value in
-                         * xNextTaskUnblockTime. */
-                        xNextTaskUnblockTime = xItemValue;
-                        break; /*lint !e9011 Code structure here is deedmed easier to understand with multiple breaks. */
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+                        pxTCB = listGET_OWNER_OF_HEAD_ENTRY( pxExpired ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 
-                    /* It is time to remove the item from the Blocked state. */
-                    ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+                        ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
 
-                    /* Is the task waiting on an event also?  If so remove
-                     * it from the event list. */
-                    if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
-                    {
-                        ( void ) uxListRemove( &( pxTCB->xEventListItem ) );
-                    }
-                    else
-                    {
-                        mtCOVERAGE_TEST_MARKER();
-                    }
+                        if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
+                        {
+                            ( void ) uxListRemove( &( pxTCB->xEventListItem ) );
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
 
-                    /* Place the unblocked task into the appropriate ready
-                     * list. */
-                    prvAddTaskToReadyList( pxTCB );
+                        prvAddTaskToReadyList( pxTCB );
 
-                    /* A task being unblocked cannot cause an immediate
-                     * context switch if preemption is turned off. */
-                    #if ( configUSE_PREEMPTION == 1 )
+                        #if ( configUSE_PREEMPTION == 1 )
+                            {
+                                if( taskSHARES_OR_PREEMPTS_CURRENT( pxTCB ) )
+                                {
+                                    xSwitchRequired = pdTRUE;
+                                }
+                                else
+                                {
+                                    mtCOVERAGE_TEST_MARKER();
+                                }
+                            }
+                        #endif /* configUSE_PREEMPTION */
+                    }
+                }
+            }
+        #else /* configUSE_TIMING_WHEEL */
+            {
+                /* See if this tick has made a timeout expire.  Tasks are stored in
+                 * the  queue in the order of their wake time - meaning once one task
+                 * has been found whose block time has not expired there is no need to
+                 * look any further down the list. */
+                if( xConstTickCount >= xNextTaskUnblockTime )
+                {
+                    for( ; ; )
+                    {
+                        if( listLIST_IS_EMPTY( pxDelayedTaskList ) != pdFALSE )
                         {
-                            /* Preemption is on, but a context switch should
-                             * only be performed if the unblocked task has a
-                             * priority that is equal to or higher than the
-                             * currently executing task. */
-                            if( pxTCB->uxPriority >= pxCurrentTCB->uxPriority )
+                            /* The delayed list is empty.  Set xNextTaskUnblockTime
+                             * to the maximum possible value so it is extremely
+                             * unlikely that the
+                             * if( xTickCount >= xNextTaskUnblockTime ) test will pass
+                             * next time through. */
+                            xNextTaskUnblockTime = portMAX_DELAY; /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+                            break;
+                        }
+                        else
+                        {
+                            /* The delayed list is not empty, get the value of the
+                             * item at the head of the delayed list.  This is the time
+                             * at which the task at the head of the delayed list must
+                             * be removed from the Blocked state. */
+                            pxTCB = listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList ); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+                            xItemValue = listGET_LIST_ITEM_VALUE( &( pxTCB->xStateListItem ) );
+
+                            if( xConstTickCount < xItemValue )
+                            {
+                                /* It is not time to unblock this item yet, but the
+                                 * item value is the time at which the task at the head
+                                 * of the blocked list must be removed from the Blocked
+                                 * state -  so record the item value in
+                                 * xNextTaskUnblockTime. */
+                                xNextTaskUnblockTime = xItemValue;
+                                break; /*lint !e9011 Code structure here is deedmed easier to understand with multiple breaks. */
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+
+                            /* It is time to remove the item from the Blocked state. */
+                            ( void ) uxListRemove( &( pxTCB->xStateListItem ) );
+
+                            /* Is the task waiting on an event also?  If so remove
+                             * it from the event list. */
+                            if( listLIST_ITEM_CONTAINER( &( pxTCB->xEventListItem ) ) != NULL )
                             {
-                                xSwitchRequired = pdTRUE;
+                                ( void ) uxListRemove( &( pxTCB->xEventListItem ) );
                             }
                             else
                             {
                                 mtCOVERAGE_TEST_MARKER();
                             }
+
+                            /* Place the unblocked task into the appropriate ready
+                             * list. */
+                            prvAddTaskToReadyList( pxTCB );
+
+                            /* A task being unblocked cannot cause an immediate
+                             * context switch if preemption is turned off. */
+                            #if ( configUSE_PREEMPTION == 1 )
+                                {
+                                    /* Preemption is on, but a context switch should
+                                     * only be performed if the unblocked task has a
+                                     * priority that is equal to or higher than the
+                                     * currently executing task. */
+                                    if( taskSHARES_OR_PREEMPTS_CURRENT( pxTCB ) )
+                                    {
+                                        xSwitchRequired = pdTRUE;
+                                    }
+                                    else
+                                    {
+                                        mtCOVERAGE_TEST_MARKER();
+                                    }
+                                }
+                            #endif /* configUSE_PREEMPTION */
                         }
-                    #endif /* configUSE_PREEMPTION */
+                    }
                 }
             }
-        }
+        #endif /* configUSE_TIMING_WHEEL */
+
+        #if ( configUSE_TASK_BUDGET == 1 )
+            {
+                if( prvProcessBudgets( xConstTickCount ) != pdFALSE )
+                {
+                    xSwitchRequired = pdTRUE;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+            }
+        #endif /* configUSE_TASK_BUDGET */
 
         /* Tasks of equal priority to the currently running task will share
          * processing time (time slice) if preemption is on, and the application
          * writer has not explicitly turned time slicing off. */
         #if ( ( configUSE_PREEMPTION == 1 ) && ( configUSE_TIME_SLICING == 1 ) )
             {
-                if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ) ) > ( UBaseType_t ) 1 )
+                if( ( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ) ) > ( UBaseType_t ) 1 ) &&
+                    ( taskIS_TIME_SLICED( pxCurrentTCB ) ) &&
+                    ( taskTIME_SLICE_EXPIRED() ) )
                 {
                     xSwitchRequired = pdTRUE;
                 }
@@ -3044,7 +3810,22 @@ void vTaskSwitchContext( void )
 
         /* Select a new task to run using either the generic C or port
          * optimised asm code. */
-        taskSELECT_HIGHEST_PRIORITY_TASK(); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+        #if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+            {
+                prvSelectTaskWithThresholds();
+            }
+        #else
+            {
+                taskSELECT_HIGHEST_PRIORITY_TASK(); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+            }
+        #endif
+
+        /* The selected task starts a new time slice. */
+        #if ( configUSE_TASK_TIME_SLICES == 1 )
+            {
+                xTimeSliceLeft = pxCurrentTCB->xTimeSliceLength;
+            }
+        #endif
         traceTASK_SWITCHED_IN();
 
         /* After the new task is switched in, update the global errno. */
@@ -3067,6 +3848,288 @@ void vTaskSwitchContext( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+    static void prvSelectTaskWithThresholds( void )
+    {
+        UBaseType_t uxTopPriority = uxTopReadyPriority;
+        BaseType_t xKeepCurrent = pdFALSE;
+        TCB_t * pxHolder;
+
+        /* Find the highest priority queue that contains ready tasks. */
+        while( listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxTopPriority ] ) ) )
+        {
+            configASSERT( uxTopPriority );
+            --uxTopPriority;
+        }
+
+        /* Is the running task still ready and holding its threshold? */
+        if( ( taskHOLDS_THRESHOLD( pxCurrentTCB ) ) &&
+            ( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxCurrentTCB->uxPriority ] ), &( pxCurrentTCB->xStateListItem ) ) != pdFALSE ) )
+        {
+            if( uxTopPriority <= pxCurrentTCB->uxPreemptionThreshold )
+            {
+                xKeepCurrent = pdTRUE;
+            }
+            else
+            {
+                /* The task is preempted, remember it, so it is resumed
+                 * before the tasks it is protected from. */
+                configASSERT( uxPreemptedHolders < ( UBaseType_t ) configMAX_PRIORITIES );
+                pxPreemptedHolders[ uxPreemptedHolders ] = pxCurrentTCB;
+                uxPreemptedHolders++;
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        if( xKeepCurrent == pdFALSE )
+        {
+            /* Preempted tasks that have blocked or have been suspended in the
+             * mean time do not hold their thresholds anymore. */
+            while( uxPreemptedHolders > ( UBaseType_t ) 0U )
+            {
+                pxHolder = pxPreemptedHolders[ uxPreemptedHolders - ( UBaseType_t ) 1U ];
+
+                if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxHolder->uxPriority ] ), &( pxHolder->xStateListItem ) ) != pdFALSE )
+                {
+                    break;
+                }
+
+                uxPreemptedHolders--;
+            }
+
+            if( ( uxPreemptedHolders > ( UBaseType_t ) 0U ) &&
+                ( uxTopPriority <= pxPreemptedHolders[ uxPreemptedHolders - ( UBaseType_t ) 1U ]->uxPreemptionThreshold ) )
+            {
+                uxPreemptedHolders--;
+                pxCurrentTCB = pxPreemptedHolders[ uxPreemptedHolders ];
+            }
+            else
+            {
+                taskSELECT_FROM_READY_LIST( uxTopPriority );
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        uxTopReadyPriority = uxTopPriority;
+    }
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_PREEMPTION_THRESHOLD == 1 )
+
+    static void prvForgetPreemptedHolder( const TCB_t * pxTCB )
+    {
+        UBaseType_t uxIndex;
+        BaseType_t xFound = pdFALSE;
+
+        /* Called from a critical section. */
+        for( uxIndex = ( UBaseType_t ) 0U; uxIndex < uxPreemptedHolders; uxIndex++ )
+        {
+            if( xFound != pdFALSE )
+            {
+                pxPreemptedHolders[ uxIndex - ( UBaseType_t ) 1U ] = pxPreemptedHolders[ uxIndex ];
+            }
+            else if( pxPreemptedHolders[ uxIndex ] == pxTCB )
+            {
+                xFound = pdTRUE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        if( xFound != pdFALSE )
+        {
+            uxPreemptedHolders--;
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+#endif /* configUSE_PREEMPTION_THRESHOLD */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGET == 1 )
+
+    static BaseType_t prvProcessBudgets( const TickType_t xConstTickCount )
+    {
+        TCB_t * pxTCB;
+        BaseType_t xSwitchRequired = pdFALSE;
+
+        /* The running task is charged for the whole tick. */
+        pxTCB = pxCurrentTCB;
+
+        if( ( pxTCB->xBudget > ( TickType_t ) 0U ) && ( pxTCB->xBudgetLeft > ( TickType_t ) 0U ) )
+        {
+            pxTCB->xBudgetLeft--;
+
+            if( pxTCB->xBudgetLeft == ( TickType_t ) 0U )
+            {
+                traceTASK_BUDGET_EXHAUSTED( pxTCB );
+                prvSetBudgetPriority( pxTCB, pxTCB->uxBackgroundPriority );
+                xSwitchRequired = pdTRUE;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+
+        /* The budgets are replenished at the end of each period, an unused
+         * budget is not carried over (deferrable server). */
+        for( pxTCB = pxBudgetedTasks; pxTCB != NULL; pxTCB = pxTCB->pxNextBudgeted )
+        {
+            if( xConstTickCount == pxTCB->xNextReplenishment )
+            {
+                pxTCB->xNextReplenishment += pxTCB->xBudgetPeriod;
+
+                if( pxTCB->xBudgetLeft == ( TickType_t ) 0U )
+                {
+                    traceTASK_BUDGET_REPLENISHED( pxTCB );
+                    prvSetBudgetPriority( pxTCB, pxTCB->uxServerPriority );
+
+                    #if ( configUSE_PREEMPTION == 1 )
+                        {
+                            if( ( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxTCB->uxPriority ] ), &( pxTCB->xStateListItem ) ) != pdFALSE ) &&
+                                ( taskPREEMPTS_CURRENT( pxTCB ) ) )
+                            {
+                                xSwitchRequired = pdTRUE;
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        }
+                    #endif /* configUSE_PREEMPTION */
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                pxTCB->xBudgetLeft = pxTCB->xBudget;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+
+        return xSwitchRequired;
+    }
+
+#endif /* configUSE_TASK_BUDGET */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGET == 1 )
+
+    static void prvSetBudgetPriority( TCB_t * pxTCB,
+                                      UBaseType_t uxNewPriority )
+    {
+        const UBaseType_t uxPriorityUsedOnEntry = pxTCB->uxPriority;
+
+        #if ( configUSE_MUTEXES == 1 )
+            {
+                /* A task that has inherited a priority keeps it until it
+                 * releases the mutex. */
+                if( pxTCB->uxBasePriority == pxTCB->uxPriority )
+                {
+                    pxTCB->uxPriority = uxNewPriority;
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                pxTCB->uxBasePriority = uxNewPriority;
+            }
+        #else /* if ( configUSE_MUTEXES == 1 ) */
+            {
+                pxTCB->uxPriority = uxNewPriority;
+            }
+        #endif /* if ( configUSE_MUTEXES == 1 ) */
+
+        if( pxTCB->uxPriority != uxPriorityUsedOnEntry )
+        {
+            /* Only reset the event list item value if the value is not being
+             * used for anything else. */
+            if( ( listGET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ) ) & taskEVENT_LIST_ITEM_VALUE_IN_USE ) == 0UL )
+            {
+                listSET_LIST_ITEM_VALUE( &( pxTCB->xEventListItem ), ( ( TickType_t ) configMAX_PRIORITIES - ( TickType_t ) pxTCB->uxPriority ) ); /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+
+            /* If the task is in a ready list, it is moved to the ready list
+             * of its new priority. */
+            if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ uxPriorityUsedOnEntry ] ), &( pxTCB->xStateListItem ) ) != pdFALSE )
+            {
+                if( uxListRemove( &( pxTCB->xStateListItem ) ) == ( UBaseType_t ) 0 )
+                {
+                    portRESET_READY_PRIORITY( uxPriorityUsedOnEntry, uxTopReadyPriority );
+                }
+                else
+                {
+                    mtCOVERAGE_TEST_MARKER();
+                }
+
+                prvAddTaskToReadyList( pxTCB );
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+        else
+        {
+            mtCOVERAGE_TEST_MARKER();
+        }
+    }
+
+#endif /* configUSE_TASK_BUDGET */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TASK_BUDGET == 1 )
+
+    static void prvUnlinkBudgetedTask( const TCB_t * pxTCB )
+    {
+        TCB_t ** ppxLink;
+
+        /* Called from a critical section. */
+        for( ppxLink = &pxBudgetedTasks; *ppxLink != NULL; ppxLink = &( ( *ppxLink )->pxNextBudgeted ) )
+        {
+            if( *ppxLink == pxTCB )
+            {
+                *ppxLink = pxTCB->pxNextBudgeted;
+                break;
+            }
+            else
+            {
+                mtCOVERAGE_TEST_MARKER();
+            }
+        }
+    }
+
+#endif /* configUSE_TASK_BUDGET */
+/*-----------------------------------------------------------*/
+
 void vTaskPlaceOnEventList( List_t * const pxEventList,
                             const TickType_t xTicksToWait )
 {
@@ -3194,7 +4257,7 @@ BaseType_t xTaskRemoveFromEventList( const List_t * const pxEventList )
         vListInsertEnd( &( xPendingReadyList ), &( pxUnblockedTCB->xEventListItem ) );
     }
 
-    if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
+    if( taskPREEMPTS_CURRENT( pxUnblockedTCB ) )
     {
         /* Return true if the task removed from the event list has a higher
          * priority than the calling task.  This allows the calling task to know if
@@ -3252,7 +4315,7 @@ void vTaskRemoveFromUnorderedEventList( ListItem_t * pxEventListItem,
     ( void ) uxListRemove( &( pxUnblockedTCB->xStateListItem ) );
     prvAddTaskToReadyList( pxUnblockedTCB );
 
-    if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
+    if( taskPREEMPTS_CURRENT( pxUnblockedTCB ) )
     {
         /* The unblocked task has a priority above that of the calling task, so
          * a context switch is required.  This function is called with the
@@ -3658,6 +4721,12 @@ static void prvInitialiseTaskLists( void )
      * using list2. */
     pxDelayedTaskList = &xDelayedTaskList1;
     pxOverflowDelayedTaskList = &xDelayedTaskList2;
+
+    #if ( configUSE_TIMING_WHEEL == 1 )
+        {
+            vTimingWheelInitialise( &xDelayedTaskWheel, xTickCount );
+        }
+    #endif
 }
 /*-----------------------------------------------------------*/
 
@@ -4920,7 +5989,7 @@ TickType_t uxTaskResetEventItemValue( void )
                     }
                 #endif
 
-                if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+                if( taskPREEMPTS_CURRENT( pxTCB ) )
                 {
                     /* The notified task has a priority above the currently
                      * executing task so a yield is required. */
@@ -5055,7 +6124,7 @@ TickType_t uxTaskResetEventItemValue( void )
                     vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
                 }
 
-                if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+                if( taskPREEMPTS_CURRENT( pxTCB ) )
                 {
                     /* The notified task has a priority above the currently
                      * executing task so a yield is required. */
@@ -5146,7 +6215,7 @@ TickType_t uxTaskResetEventItemValue( void )
                     vListInsertEnd( &( xPendingReadyList ), &( pxTCB->xEventListItem ) );
                 }
 
-                if( pxTCB->uxPriority > pxCurrentTCB->uxPriority )
+                if( taskPREEMPTS_CURRENT( pxTCB ) )
                 {
                     /* The notified task has a priority above the currently
                      * executing task so a yield is required. */
@@ -5291,30 +6360,39 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
                 /* The list item will be inserted in wake time order. */
                 listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xStateListItem ), xTimeToWake );
 
-                if( xTimeToWake < xConstTickCount )
-                {
-                    /* Wake time has overflowed.  Place this item in the overflow
-                     * list. */
-                    vListInsert( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
-                }
-                else
-                {
-                    /* The wake time has not overflowed, so the current block list
-                     * is used. */
-                    vListInsert( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
-
-                    /* If the task entering the blocked state was placed at the
-                     * head of the list of blocked tasks then xNextTaskUnblockTime
-                     * needs to be updated too. */
-                    if( xTimeToWake < xNextTaskUnblockTime )
+                #if ( configUSE_TIMING_WHEEL == 1 )
                     {
-                        xNextTaskUnblockTime = xTimeToWake;
+                        /* The wheel handles overflowed wake times as well. */
+                        vTimingWheelInsert( &xDelayedTaskWheel, &( pxCurrentTCB->xStateListItem ) );
                     }
-                    else
+                #else /* configUSE_TIMING_WHEEL */
                     {
-                        mtCOVERAGE_TEST_MARKER();
+                        if( xTimeToWake < xConstTickCount )
+                        {
+                            /* Wake time has overflowed.  Place this item in the overflow
+                             * list. */
+                            vListInsert( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+                        }
+                        else
+                        {
+                            /* The wake time has not overflowed, so the current block list
+                             * is used. */
+                            vListInsert( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+
+                            /* If the task entering the blocked state was placed at the
+                             * head of the list of blocked tasks then xNextTaskUnblockTime
+                             * needs to be updated too. */
+                            if( xTimeToWake < xNextTaskUnblockTime )
+                            {
+                                xNextTaskUnblockTime = xTimeToWake;
+                            }
+                            else
+                            {
+                                mtCOVERAGE_TEST_MARKER();
+                            }
+                        }
                     }
-                }
+                #endif /* configUSE_TIMING_WHEEL */
             }
         }
     #else /* INCLUDE_vTaskSuspend */
@@ -5327,28 +6405,37 @@ static void prvAddCurrentTaskToDelayedList( TickType_t xTicksToWait,
             /* The list item will be inserted in wake time order. */
             listSET_LIST_ITEM_VALUE( &( pxCurrentTCB->xStateListItem ), xTimeToWake );
 
-            if( xTimeToWake < xConstTickCount )
-            {
-                /* Wake time has overflowed.  Place this item in the overflow list. */
-                vListInsert( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
-            }
-            else
-            {
-                /* The wake time has not overflowed, so the current block list is used. */
-                vListInsert( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
-
-                /* If the task entering the blocked state was placed at the head of the
-                 * list of blocked tasks then xNextTaskUnblockTime needs to be updated
-                 * too. */
-                if( xTimeToWake < xNextTaskUnblockTime )
+            #if ( configUSE_TIMING_WHEEL == 1 )
                 {
-                    xNextTaskUnblockTime = xTimeToWake;
+                    /* The wheel handles overflowed wake times as well. */
+                    vTimingWheelInsert( &xDelayedTaskWheel, &( pxCurrentTCB->xStateListItem ) );
                 }
-                else
+            #else /* configUSE_TIMING_WHEEL */
                 {
-                    mtCOVERAGE_TEST_MARKER();
+                    if( xTimeToWake < xConstTickCount )
+                    {
+                        /* Wake time has overflowed.  Place this item in the overflow list. */
+                        vListInsert( pxOverflowDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+                    }
+                    else
+                    {
+                        /* The wake time has not overflowed, so the current block list is used. */
+                        vListInsert( pxDelayedTaskList, &( pxCurrentTCB->xStateListItem ) );
+
+                        /* If the task entering the blocked state was placed at the head of the
+                         * list of blocked tasks then xNextTaskUnblockTime needs to be updated
+                         * too. */
+                        if( xTimeToWake < xNextTaskUnblockTime )
+                        {
+                            xNextTaskUnblockTime = xTimeToWake;
+                        }
+                        else
+                        {
+                            mtCOVERAGE_TEST_MARKER();
+                        }
+                    }
                 }
-            }
+            #endif /* configUSE_TIMING_WHEEL */
 
             /* Avoid compiler warning when INCLUDE_vTaskSuspend is not 1. */
             ( void ) xCanBlockIndefinitely;
@@ -37,6 +37,10 @@
 #include "queue.h"
 #include "timers.h"
 
+#if ( configUSE_TIMING_WHEEL == 1 )
+    #include "timing_wheel.h"
+#endif
+
 #if ( INCLUDE_xTimerPendFunctionCall == 1 ) && ( configUSE_TIMERS == 0 )
     #error configUSE_TIMERS must be set to 1 to make the xTimerPendFunctionCall() function available.
 #endif
@@ -136,6 +140,12 @@
     PRIVILEGED_DATA static List_t * pxCurrentTimerList;
     PRIVILEGED_DATA static List_t * pxOverflowTimerList;
 
+/* Active timers are kept in the timing wheel instead of the lists above
+ * that remain empty.  The wheel is only accessed by the timer service task. */
+    #if ( configUSE_TIMING_WHEEL == 1 )
+        PRIVILEGED_DATA static TimingWheel_t xActiveTimerWheel;
+    #endif
+
 /* A queue that is used to send commands to the timer service task. */
     PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
     PRIVILEGED_DATA static TaskHandle_t xTimerTaskHandle = NULL;
@@ -173,10 +183,11 @@
                                                   const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
 
 /*
- * An active timer has reached its expire time.  Reload the timer if it is an
- * auto-reload timer, then call its callback.
+ * The active timer at the head of pxList has reached its expire time.  Reload
+ * the timer if it is an auto-reload timer, then call its callback.
  */
-    static void prvProcessExpiredTimer( const TickType_t xNextExpireTime,
+    static void prvProcessExpiredTimer( List_t * const pxList,
+                                        const TickType_t xNextExpireTime,
                                         const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
 
 /*
@@ -191,6 +202,8 @@
  */
     static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched ) PRIVILEGED_FUNCTION;
 
+    #if ( configUSE_TIMING_WHEEL == 0 )
+
 /*
  * If the timer list contains any active timers then return the expire time of
  * the timer that will expire first and set *pxListWasEmpty to false.  If the
@@ -206,6 +219,17 @@
     static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime,
                                             BaseType_t xListWasEmpty ) PRIVILEGED_FUNCTION;
 
+    #endif /* configUSE_TIMING_WHEEL */
+
+/*
+ * The same as prvProcessTimerOrBlockTask() when the active timers are kept
+ * in the timing wheel.  All timers that expire at the same tick are processed
+ * at once.
+ */
+    #if ( configUSE_TIMING_WHEEL == 1 )
+        static void prvProcessTimerWheelOrBlockTask( void ) PRIVILEGED_FUNCTION;
+    #endif
+
 /*
  * Called after a Timer_t structure has been allocated either statically or
  * dynamically to fill in the structure's members.
@@ -505,11 +529,12 @@
     }
 /*-----------------------------------------------------------*/
 
-    static void prvProcessExpiredTimer( const TickType_t xNextExpireTime,
+    static void prvProcessExpiredTimer( List_t * const pxList,
+                                        const TickType_t xNextExpireTime,
                                         const TickType_t xTimeNow )
     {
         BaseType_t xResult;
-        Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTimerList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+        Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 
         /* Remove the timer from the list of active timers.  A check has already
          * been performed to ensure the list is not empty. */
@@ -550,8 +575,10 @@
 
     static portTASK_FUNCTION( prvTimerTask, pvParameters )
     {
-        TickType_t xNextExpireTime;
-        BaseType_t xListWasEmpty;
+        #if ( configUSE_TIMING_WHEEL == 0 )
+            TickType_t xNextExpireTime;
+            BaseType_t xListWasEmpty;
+        #endif
 
         /* Just to avoid compiler warnings. */
         ( void ) pvParameters;
@@ -570,13 +597,24 @@
 
         for( ; ; )
         {
-            /* Query the timers list to see if it contains any timers, and if so,
-             * obtain the time at which the next timer will expire. */
-            xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
+            #if ( configUSE_TIMING_WHEEL == 1 )
+                {
+                    /* If timers have expired, process them.  Otherwise, block
+                     * this task until either a timer does expire, or a command
+                     * is received. */
+                    prvProcessTimerWheelOrBlockTask();
+                }
+            #else
+                {
+                    /* Query the timers list to see if it contains any timers, and if so,
+                     * obtain the time at which the next timer will expire. */
+                    xNextExpireTime = prvGetNextExpireTime( &xListWasEmpty );
 
-            /* If a timer has expired, process it.  Otherwise, block this task
-             * until either a timer does expire, or a command is received. */
-            prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+                    /* If a timer has expired, process it.  Otherwise, block this task
+                     * until either a timer does expire, or a command is received. */
+                    prvProcessTimerOrBlockTask( xNextExpireTime, xListWasEmpty );
+                }
+            #endif /* configUSE_TIMING_WHEEL */
 
             /* Empty the command queue. */
             prvProcessReceivedCommands();
@@ -584,6 +622,60 @@
     }
 /*-----------------------------------------------------------*/
 
+    #if ( configUSE_TIMING_WHEEL == 1 )
+
+        static void prvProcessTimerWheelOrBlockTask( void )
+        {
+            TickType_t xTimeNow;
+            TickType_t xNextEvent;
+            BaseType_t xWheelWasEmpty;
+            List_t * pxExpired;
+
+            vTaskSuspendAll();
+            {
+                /* Advance the wheel up to the current tick.  It stops at the
+                 * first tick with expired timers. */
+                xTimeNow = xTaskGetTickCount();
+                pxExpired = pxTimingWheelAdvance( &xActiveTimerWheel, xTimeNow );
+
+                if( pxExpired != NULL )
+                {
+                    ( void ) xTaskResumeAll();
+
+                    /* All timers must be removed from the slot before the wheel
+                     * is advanced again.  Reloaded timers are inserted into
+                     * other slots. */
+                    while( listLIST_IS_EMPTY( pxExpired ) == pdFALSE )
+                    {
+                        prvProcessExpiredTimer( pxExpired, listGET_ITEM_VALUE_OF_HEAD_ENTRY( pxExpired ), xTimeNow );
+                    }
+                }
+                else
+                {
+                    /* Nothing has expired up to now.  Block until the wheel must be
+                     * advanced again or a command is received.  The wheel handles
+                     * tick count overflows itself. */
+                    xWheelWasEmpty = ( xTimingWheelNextEvent( &xActiveTimerWheel, &xNextEvent ) == pdFALSE ) ? pdTRUE : pdFALSE;
+
+                    vQueueWaitForMessageRestricted( xTimerQueue, ( xNextEvent - xTimeNow ), xWheelWasEmpty );
+
+                    if( xTaskResumeAll() == pdFALSE )
+                    {
+                        portYIELD_WITHIN_API();
+                    }
+                    else
+                    {
+                        mtCOVERAGE_TEST_MARKER();
+                    }
+                }
+            }
+        }
+
+    #endif /* configUSE_TIMING_WHEEL */
+/*-----------------------------------------------------------*/
+
+    #if ( configUSE_TIMING_WHEEL == 0 )
+
     static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime,
                                             BaseType_t xListWasEmpty )
     {
@@ -605,7 +697,7 @@
                 if( ( xListWasEmpty == pdFALSE ) && ( xNextExpireTime <= xTimeNow ) )
                 {
                     ( void ) xTaskResumeAll();
-                    prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+                    prvProcessExpiredTimer( pxCurrentTimerList, xNextExpireTime, xTimeNow );
                 }
                 else
                 {
@@ -671,6 +763,8 @@
 
         return xNextExpireTime;
     }
+
+    #endif /* configUSE_TIMING_WHEEL */
 /*-----------------------------------------------------------*/
 
     static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
@@ -718,7 +812,11 @@
             }
             else
             {
-                vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+                #if ( configUSE_TIMING_WHEEL == 1 )
+                    vTimingWheelInsert( &xActiveTimerWheel, &( pxTimer->xTimerListItem ) );
+                #else
+                    vListInsert( pxOverflowTimerList, &( pxTimer->xTimerListItem ) );
+                #endif
             }
         }
         else
@@ -732,7 +830,11 @@
             }
             else
             {
-                vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+                #if ( configUSE_TIMING_WHEEL == 1 )
+                    vTimingWheelInsert( &xActiveTimerWheel, &( pxTimer->xTimerListItem ) );
+                #else
+                    vListInsert( pxCurrentTimerList, &( pxTimer->xTimerListItem ) );
+                #endif
             }
         }
 
@@ -964,6 +1066,12 @@
                 pxCurrentTimerList = &xActiveTimerList1;
                 pxOverflowTimerList = &xActiveTimerList2;
 
+                #if ( configUSE_TIMING_WHEEL == 1 )
+                    {
+                        vTimingWheelInitialise( &xActiveTimerWheel, xTaskGetTickCount() );
+                    }
+                #endif
+
                 #if ( configSUPPORT_STATIC_ALLOCATION == 1 )
                     {
                         /* The timer queue is allocated statically in case
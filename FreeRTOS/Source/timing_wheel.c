@@ -0,0 +1,277 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ *
+ * Implementation of the hierarchical timing wheel.
+ *
+ * See timing_wheel.h for more details.
+ *
+ * @author Jernej Kovacic
+ */
+
+
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+ * all the API functions to use the MPU wrappers.  That should only be done when
+ * task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "list.h"
+#include "timing_wheel.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE /*lint !e961 !e750 !e9021. */
+
+#if ( configUSE_TIMING_WHEEL == 1 )
+
+#if ( configUSE_16_BIT_TICKS == 1 )
+    #error The timing wheel requires 32-bit ticks
+#endif
+
+/* Position of the lowest tick bit that indexes slots of the level uxLevel. */
+#define twheelLEVEL_SHIFT( uxLevel )    ( ( uxLevel ) * twheelSLOT_BITS )
+
+/* Number of ticks covered by the wheel. */
+#define twheelRANGE                     ( ( TickType_t ) 1U << twheelLEVEL_SHIFT( configTIMING_WHEEL_LEVELS ) )
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Inserts the item into the slot that is reached xDelta ticks after the
+ * wheel's current time.
+ */
+static void prvInsert( TimingWheel_t * const pxWheel,
+                       ListItem_t * const pxItem,
+                       TickType_t xDelta ) PRIVILEGED_FUNCTION;
+
+/*
+ * Moves all items of the current slot of the level uxLevel to lower levels.
+ */
+static void prvCascade( TimingWheel_t * const pxWheel,
+                        UBaseType_t uxLevel ) PRIVILEGED_FUNCTION;
+
+/*
+ * Position of the lowest set bit of a nonzero value.
+ */
+static UBaseType_t prvLowestSetBit( uint32_t ulValue ) PRIVILEGED_FUNCTION;
+
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvLowestSetBit( uint32_t ulValue )
+{
+    /* The lowest set bit is isolated and multiplied by a de Bruijn sequence,
+     * its top 5 bits are unique for each position of the bit. */
+    static const uint8_t ucPositions[ 32 ] =
+    {
+        0U,  1U,  28U, 2U,  29U, 14U, 24U, 3U,  30U, 22U, 20U, 15U, 25U, 17U, 4U,  8U,
+        31U, 27U, 13U, 23U, 21U, 19U, 16U, 7U,  26U, 12U, 18U, 6U,  11U, 5U,  10U, 9U
+    };
+
+    const uint32_t ulLowest = ulValue & ( ~ulValue + 1UL );
+
+    return ( UBaseType_t ) ucPositions[ ( uint32_t ) ( ulLowest * 0x077CB531UL ) >> 27 ];
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsert( TimingWheel_t * const pxWheel,
+                       ListItem_t * const pxItem,
+                       TickType_t xDelta )
+{
+    UBaseType_t uxLevel = 0U;
+    UBaseType_t uxSlot;
+
+    /* Find the lowest level whose range covers the timeout. */
+    while( ( uxLevel < ( UBaseType_t ) ( configTIMING_WHEEL_LEVELS - 1 ) ) &&
+           ( xDelta >= ( ( TickType_t ) 1U << twheelLEVEL_SHIFT( uxLevel + 1U ) ) ) )
+    {
+        uxLevel++;
+    }
+
+    /* Timeouts beyond the wheel's range are parked at the furthest slot of
+     * the top level and cascaded again when the slot is reached. */
+    if( xDelta >= twheelRANGE )
+    {
+        xDelta = twheelRANGE - ( TickType_t ) 1U;
+    }
+
+    uxSlot = ( UBaseType_t ) ( ( ( pxWheel->xTime + xDelta ) >> twheelLEVEL_SHIFT( uxLevel ) ) & twheelSLOT_MASK );
+
+    vListInsertEnd( &( pxWheel->xSlots[ ( uxLevel * twheelSLOTS ) + uxSlot ] ), pxItem );
+    pxWheel->ulOccupied[ uxLevel ] |= ( 1UL << uxSlot );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCascade( TimingWheel_t * const pxWheel,
+                        UBaseType_t uxLevel )
+{
+    const UBaseType_t uxSlot = ( UBaseType_t ) ( ( pxWheel->xTime >> twheelLEVEL_SHIFT( uxLevel ) ) & twheelSLOT_MASK );
+    List_t * const pxSlot = &( pxWheel->xSlots[ ( uxLevel * twheelSLOTS ) + uxSlot ] );
+    ListItem_t * pxItem;
+
+    pxWheel->ulOccupied[ uxLevel ] &= ~( 1UL << uxSlot );
+
+    while( listLIST_IS_EMPTY( pxSlot ) == pdFALSE )
+    {
+        pxItem = listGET_HEAD_ENTRY( pxSlot );
+        ( void ) uxListRemove( pxItem );
+
+        /* All items of the slot expire within the slot's span, starting now,
+         * unless they have been parked. */
+        prvInsert( pxWheel, pxItem, listGET_LIST_ITEM_VALUE( pxItem ) - pxWheel->xTime );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTimingWheelInitialise( TimingWheel_t * const pxWheel,
+                             TickType_t xTime )
+{
+    UBaseType_t ux;
+
+    pxWheel->xTime = xTime;
+
+    for( ux = 0U; ux < ( UBaseType_t ) configTIMING_WHEEL_LEVELS; ux++ )
+    {
+        pxWheel->ulOccupied[ ux ] = 0UL;
+    }
+
+    for( ux = 0U; ux < ( UBaseType_t ) twheelNUM_LISTS; ux++ )
+    {
+        vListInitialise( &( pxWheel->xSlots[ ux ] ) );
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vTimingWheelInsert( TimingWheel_t * const pxWheel,
+                         ListItem_t * const pxItem )
+{
+    TickType_t xDelta = listGET_LIST_ITEM_VALUE( pxItem ) - pxWheel->xTime;
+
+    /* The current slot has already been processed. */
+    if( xDelta == ( TickType_t ) 0U )
+    {
+        xDelta = ( TickType_t ) 1U;
+    }
+    else
+    {
+        mtCOVERAGE_TEST_MARKER();
+    }
+
+    prvInsert( pxWheel, pxItem, xDelta );
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xTimingWheelNextEvent( const TimingWheel_t * const pxWheel,
+                                  TickType_t * const pxTime )
+{
+    BaseType_t xFound = pdFALSE;
+    TickType_t xMinDelta = ( TickType_t ) 0U;
+    TickType_t xDelta;
+    UBaseType_t uxLevel;
+    UBaseType_t uxFirst;
+    uint32_t ulRotated;
+
+    for( uxLevel = 0U; uxLevel < ( UBaseType_t ) configTIMING_WHEEL_LEVELS; uxLevel++ )
+    {
+        if( pxWheel->ulOccupied[ uxLevel ] == 0UL )
+        {
+            continue;
+        }
+
+        /* The current slot has already been processed, so slots are searched
+         * from the next one on, wrapping around to the current slot. */
+        uxFirst = ( UBaseType_t ) ( ( ( pxWheel->xTime >> twheelLEVEL_SHIFT( uxLevel ) ) + 1U ) & twheelSLOT_MASK );
+        ulRotated = pxWheel->ulOccupied[ uxLevel ];
+
+        if( uxFirst != 0U )
+        {
+            ulRotated = ( ulRotated >> uxFirst ) | ( ulRotated << ( twheelSLOTS - uxFirst ) );
+        }
+
+        /* The slot is reached at the start of its span. */
+        xDelta = ( ( ( pxWheel->xTime >> twheelLEVEL_SHIFT( uxLevel ) ) + 1U + prvLowestSetBit( ulRotated ) )
+                   << twheelLEVEL_SHIFT( uxLevel ) ) - pxWheel->xTime;
+
+        if( ( xFound == pdFALSE ) || ( xDelta < xMinDelta ) )
+        {
+            xMinDelta = xDelta;
+            xFound = pdTRUE;
+        }
+    }
+
+    *pxTime = pxWheel->xTime + xMinDelta;
+
+    return xFound;
+}
+/*-----------------------------------------------------------*/
+
+List_t * pxTimingWheelAdvance( TimingWheel_t * const pxWheel,
+                               TickType_t xTime )
+{
+    TickType_t xNext;
+    UBaseType_t uxLevel;
+    UBaseType_t uxSlot;
+
+    while( pxWheel->xTime != xTime )
+    {
+        /* Skip all ticks when nothing happens. */
+        if( ( xTimingWheelNextEvent( pxWheel, &xNext ) == pdFALSE ) ||
+            ( ( TickType_t ) ( xNext - pxWheel->xTime ) > ( TickType_t ) ( xTime - pxWheel->xTime ) ) )
+        {
+            pxWheel->xTime = xTime;
+            break;
+        }
+
+        pxWheel->xTime = xNext;
+
+        /* Cascade all higher levels whose slots start at this tick. */
+        for( uxLevel = 1U; uxLevel < ( UBaseType_t ) configTIMING_WHEEL_LEVELS; uxLevel++ )
+        {
+            if( ( xNext & ( ( ( TickType_t ) 1U << twheelLEVEL_SHIFT( uxLevel ) ) - ( TickType_t ) 1U ) ) != ( TickType_t ) 0U )
+            {
+                break;
+            }
+
+            prvCascade( pxWheel, uxLevel );
+        }
+
+        /* All items in the current slot of the lowest level have expired. */
+        uxSlot = ( UBaseType_t ) ( xNext & twheelSLOT_MASK );
+
+        if( ( pxWheel->ulOccupied[ 0 ] & ( 1UL << uxSlot ) ) != 0UL )
+        {
+            pxWheel->ulOccupied[ 0 ] &= ~( 1UL << uxSlot );
+
+            if( listLIST_IS_EMPTY( &( pxWheel->xSlots[ uxSlot ] ) ) == pdFALSE )
+            {
+                return &( pxWheel->xSlots[ uxSlot ] );
+            }
+        }
+    }
+
+    return NULL;
+}
+/*-----------------------------------------------------------*/
+
+#endif /* configUSE_TIMING_WHEEL == 1 */
@@ -103,6 +103,9 @@
 
 #define BSP_TIMER_IRQS      { ( 4 ), ( 5 ) }
 
+/* Frequency of the timers' reference clock (TIMCLK), see page 4-67 of DUI0225D */
+#define BSP_TIMER_CLOCK_HZ  ( 1000000 )
+
 
 
 /*
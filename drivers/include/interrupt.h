@@ -38,11 +38,49 @@
 
 #define PIC_MAX_PRIORITY     ( 127 )
 
+/*
+ * Set to a nonzero value to collect execution time and entry latency
+ * statistics of each IRQ. Statistics are only collected after a
+ * free running counter has been provided by pic_enableStats().
+ *
+ * The setting is normally passed by the Makefile to all source files,
+ * as the driver and its users must agree on it.
+ */
+#ifndef PIC_IRQ_STATS
+#define PIC_IRQ_STATS        ( 0 )
+#endif
+
 /**
  * Required prototype for vectored ISR servicing routines
  */
 typedef void (*pVectoredIsrPrototype)(void);
 
+/**
+ * Prototype of a handler, called when an IRQ exhausts its rate budget
+ */
+typedef void (*pPicThrottleHandler)(uint8_t irq);
+
+/**
+ * Rate budget of IRQs that are never throttled
+ */
+#define PIC_NO_BUDGET        ( 0 )
+
+#if PIC_IRQ_STATS != 0
+/**
+ * Statistics of an IRQ. All times are expressed in ticks
+ * of the free running counter, passed to pic_enableStats().
+ */
+typedef struct _picIrqStats
+{
+    uint32_t count;              /* number of ISR invocations */
+    uint32_t totalTime;          /* cumulative execution time of the ISR */
+    uint32_t maxTime;            /* the longest execution time of the ISR */
+    uint32_t latencyCount;       /* number of measured entry latencies */
+    uint32_t totalLatency;       /* sum of all measured entry latencies */
+    uint32_t maxLatency;         /* the longest measured entry latency */
+} picIrqStats;
+#endif
+
 void irq_enableIrqMode(void);
 
 void irq_disableIrqMode(void);
@@ -66,7 +104,8 @@ void pic_setDefaultVectorAddr(pVectoredIsrPrototype addr);
 int8_t pic_registerIrq(
                         uint8_t irq,
                         pVectoredIsrPrototype addr,
-                        uint8_t priority );
+                        uint8_t priority,
+                        uint16_t budget );
 
 void pic_unregisterIrq(uint8_t irq);
 
@@ -80,5 +119,27 @@ int8_t pic_setSoftwareInterrupt(void);
 
 int8_t pic_clearSoftwareInterrupt(void);
 
+void pic_setThrottleHandler(pPicThrottleHandler handler);
+
+void pic_newBudgetWindow(void);
+
+int8_t pic_pollIrq(uint8_t irq);
+
+int8_t pic_isrPolled(void);
+
+uint32_t pic_getThrottledIrqs(void);
+
+uint32_t pic_getThrottleCount(uint8_t irq);
+
+#if PIC_IRQ_STATS != 0
+void pic_enableStats(const volatile uint32_t* counter);
+
+void pic_markTrigger(uint8_t irq);
+
+int8_t pic_getIrqStats(uint8_t irq, picIrqStats* stats);
+
+void pic_resetStats(void);
+#endif
+
 
 #endif  /* _INTERRUPT_H_ */
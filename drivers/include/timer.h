@@ -39,6 +39,8 @@
 
 void timer_init(uint8_t timerNr, uint8_t counterNr);
 
+void timer_setOneShot(uint8_t timerNr, uint8_t counterNr, int8_t oneShot);
+
 void timer_start(uint8_t timerNr, uint8_t counterNr);
 
 void timer_stop(uint8_t timerNr, uint8_t counterNr);
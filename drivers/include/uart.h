@@ -62,5 +62,7 @@ void uart_clearRxInterrupt(uint8_t nr);
 
 char uart_readChar(uint8_t nr);
 
+int8_t uart_rxReady(uint8_t nr);
+
 
 #endif  /* _UART_H_ */
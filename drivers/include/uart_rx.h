@@ -0,0 +1,57 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ *
+ * Declaration of public functions of the UART receive driver
+ * that passes received data to tasks via stream buffers.
+ *
+ * @author Jernej Kovacic
+ */
+
+#ifndef _UART_RX_H_
+#define _UART_RX_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <FreeRTOS.h>
+#include <stream_buffer.h>
+
+
+int8_t uartrx_init(
+                    uint8_t nr,
+                    StreamBufferHandle_t buffer,
+                    char terminator,
+                    uint8_t irqPriority,
+                    uint16_t irqBudget );
+
+size_t uartrx_read(uint8_t nr, void* buf, size_t size, TickType_t ticksToWait);
+
+size_t uartrx_readLine(uint8_t nr, char* buf, size_t size, TickType_t ticksToWait);
+
+uint32_t uartrx_getOverruns(uint8_t nr);
+
+#endif  /* _UART_RX_H_ */
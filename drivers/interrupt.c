@@ -161,6 +161,181 @@ typedef struct _isrVectRecord
 static isrVectRecord __irqVect[NR_INTERRUPTS];
 
 
+/*
+ * Rate budgets of IRQs, indexed by IRQ numbers. An IRQ is budgeted when its
+ * bit in __budgetMask is set. Its invocations within the current window
+ * are counted in __budgetCount. When the count reaches the budget, the IRQ's
+ * line is disabled (throttled) and its bit in __throttled is set until
+ * a window, where the line does not exhaust its budget, is closed.
+ */
+static uint16_t __irqBudget[NR_INTERRUPTS];
+static uint16_t __budgetCount[NR_INTERRUPTS];
+static uint32_t __throttleCount[NR_INTERRUPTS];
+static volatile uint32_t __budgetMask = UL0;
+static volatile uint32_t __throttled = UL0;
+
+/* Called (from the IRQ context) whenever an IRQ is throttled */
+static pPicThrottleHandler __throttleHandler = NULL;
+
+/* Set while pic_pollIrq() executes an ISR in the context of the calling task */
+static volatile int8_t __isrPolled = 0;
+
+
+#if PIC_IRQ_STATS != 0
+/*
+ * Statistics of all IRQs, indexed by IRQ numbers (not by positions in
+ * __irqVect), so they are preserved when IRQs are (re)registered.
+ */
+static picIrqStats __irqStats[NR_INTERRUPTS];
+
+/* Timestamps of pending triggers, valid when the IRQ's bit in __triggerPending is set */
+static uint32_t __triggerTime[NR_INTERRUPTS];
+static volatile uint32_t __triggerPending = UL0;
+
+/* Timestamp of the currently serviced IRQ's entry into _pic_IrqHandler() */
+static uint32_t __irqEntryTime;
+
+/* Value Register of a down counting free running counter, NULL when statistics are disabled */
+static const volatile uint32_t* __statsCounter = NULL;
+
+
+/*
+ * The free running counter counts down, its complement is an
+ * increasing timestamp.
+ */
+static inline uint32_t __statsTimestamp(void)
+{
+    return ~(*__statsCounter);
+}
+
+
+/*
+ * Updates statistics of 'irq' with an execution of its ISR
+ * that was entered at __irqEntryTime and lasted 'execTime'.
+ */
+static void __statsRecord(uint8_t irq, uint32_t execTime)
+{
+    picIrqStats* const st = &__irqStats[irq];
+    const uint32_t bitmask = HWREG_SINGLE_BIT_MASK(irq);
+    uint32_t latency;
+
+    ++st->count;
+    st->totalTime += execTime;
+    if ( execTime > st->maxTime )
+    {
+        st->maxTime = execTime;
+    }
+
+    /* Entry latency is only known if the trigger has been timestamped */
+    if ( 0 != HWREG_READ_BITS(__triggerPending, bitmask) )
+    {
+        latency = __irqEntryTime - __triggerTime[irq];
+        HWREG_CLEAR_BITS(__triggerPending, bitmask);
+
+        ++st->latencyCount;
+        st->totalLatency += latency;
+        if ( latency > st->maxLatency )
+        {
+            st->maxLatency = latency;
+        }
+    }
+}
+#endif  /* PIC_IRQ_STATS != 0 */
+
+
+/*
+ * Disables IRQ and FIQ exceptions and returns the previous CPSR.
+ */
+static inline uint32_t __irqSave(void)
+{
+    uint32_t cpsr;
+    uint32_t tmp;
+
+    __asm volatile(
+        "MRS %0, cpsr         \n\t"   /* Read in the CPSR register. */
+        "ORR %1, %0, #0xC0    \n\t"   /* Disable IRQ and FIQ exceptions. */
+        "MSR cpsr_c, %1           "   /* Write it back to the CPSR register. */
+        : "=&r" (cpsr), "=r" (tmp) : : "memory" );
+
+    return cpsr;
+}
+
+
+/*
+ * Restores the CPSR's control bits, returned by __irqSave().
+ */
+static inline void __irqRestore(uint32_t cpsr)
+{
+    __asm volatile( "MSR cpsr_c, %0" : : "r" (cpsr) : "memory" );
+}
+
+
+/*
+ * Charges an invocation of a budgeted IRQ's ISR against the IRQ's budget.
+ * When the budget is exhausted, the IRQ's line is disabled and the IRQ
+ * is handed over to polling (see pic_pollIrq()).
+ *
+ * @return 0 if the budget has not been exhausted yet, 1 otherwise
+ */
+static int8_t __budgetCharge(uint8_t irq)
+{
+    if ( ++__budgetCount[irq] < __irqBudget[irq] )
+    {
+        return 0;
+    }
+
+    if ( 0 == HWREG_READ_SINGLE_BIT(__throttled, irq) )
+    {
+        pPicReg->VICINTENCLEAR = HWREG_SINGLE_BIT_MASK(irq);
+        HWREG_SET_SINGLE_BIT(__throttled, irq);
+        ++__throttleCount[irq];
+
+        if ( NULL != __throttleHandler )
+        {
+            ( *__throttleHandler )(irq);
+        }
+    }
+
+    return 1;
+}
+
+
+/*
+ * Does any serviced IRQ have to be accounted, i.e. are statistics enabled or
+ * is any IRQ budgeted?
+ */
+static inline int8_t __accountingEnabled(void)
+{
+#if PIC_IRQ_STATS != 0
+    if ( NULL != __statsCounter )
+    {
+        return 1;
+    }
+#endif
+
+    return ( UL0 != __budgetMask );
+}
+
+
+/*
+ * Accounts an invocation of the ISR of 'irq' that has just completed.
+ */
+static void __accountIrq(uint8_t irq)
+{
+#if PIC_IRQ_STATS != 0
+    if ( NULL != __statsCounter )
+    {
+        __statsRecord(irq, __statsTimestamp() - __irqEntryTime);
+    }
+#endif
+
+    if ( 0 != HWREG_READ_SINGLE_BIT(__budgetMask, irq) )
+    {
+        __budgetCharge(irq);
+    }
+}
+
+
 
 /**
  * Enable CPU's IRQ mode that handles IRQ interrupt requests.
@@ -170,12 +345,17 @@ void irq_enableIrqMode(void)
     /*
      * To enable IRQ mode, bit 7 of the Program Status Register (CSPR)
      * must be cleared to 0. See pp. 2-15 to 2-17 of the DDI0222 for more details.
-     * The CSPR can only be accessed using assembler.
+     * The CSPR can only be accessed using assembler. The scratch register
+     * is allocated by the compiler, hence no register is silently clobbered.
      */
 
-    __asm volatile("MRS r0, cpsr");        /* Read in the CPSR register. */
-    __asm volatile("BIC r0, r0, #0x80");   /* Clear bit 8, (0x80) -- Causes IRQs to be enabled. */
-    __asm volatile("MSR cpsr_c, r0");      /* Write it back to the CPSR register */
+    uint32_t cpsr;
+
+    __asm volatile(
+        "MRS %0, cpsr         \n\t"   /* Read in the CPSR register. */
+        "BIC %0, %0, #0x80    \n\t"   /* Clear bit 8, (0x80) -- Causes IRQs to be enabled. */
+        "MSR cpsr_c, %0           "   /* Write it back to the CPSR register */
+        : "=r" (cpsr) : : "memory" );
 }
 
 
@@ -187,12 +367,17 @@ void irq_disableIrqMode(void)
     /*
      * To disable IRQ mode, bit 7 of the Program Status Register (CSPR)
      * must be set t1 0. See pp. 2-15 to 2-17 of the DDI0222 for more details.
-     * The CSPR can only be accessed using assembler.
+     * The CSPR can only be accessed using assembler. The scratch register
+     * is allocated by the compiler, hence no register is silently clobbered.
      */
 
-    __asm volatile("MRS r0, cpsr");       /* Read in the CPSR register. */
-    __asm volatile("ORR r0, r0, #0xC0");  /* Disable IRQ and FIQ exceptions. */
-    __asm volatile("MSR cpsr_c, r0");     /* Write it back to the CPSR register. */
+    uint32_t cpsr;
+
+    __asm volatile(
+        "MRS %0, cpsr         \n\t"   /* Read in the CPSR register. */
+        "ORR %0, %0, #0xC0    \n\t"   /* Disable IRQ and FIQ exceptions. */
+        "MSR cpsr_c, %0           "   /* Write it back to the CPSR register. */
+        : "=r" (cpsr) : : "memory" );
 }
 
 
@@ -238,6 +423,12 @@ static void __defaultVectorIsr(void)
              0 != HWREG_READ_SINGLE_BIT(pPicReg->VICINTENABLE, __irqVect[cntr].irq ) )
         {
             ( *__irqVect[cntr].isr )();
+
+            if ( 0 != __accountingEnabled() )
+            {
+                __accountIrq(__irqVect[cntr].irq);
+            }
+
             break;  /* out of for cntr */
         }
     }  /* for cntr */
@@ -283,6 +474,44 @@ void _pic_IrqHandler(void)
      */
     isrAddr = (pVectoredIsrPrototype) pPicReg->VICVECTADDR;
 
+#if PIC_IRQ_STATS != 0
+    if ( NULL != __statsCounter )
+    {
+        __irqEntryTime = __statsTimestamp();
+    }
+#endif
+
+    /*
+     * Nonvectored IRQs are accounted by __defaultVectorIsr() that knows which
+     * IRQ is being serviced. For vectored IRQs, the IRQ is determined from
+     * the vector whose ISR matches isrAddr and whose IRQ is active.
+     */
+    if ( &__defaultVectorIsr != isrAddr && 0 != __accountingEnabled() )
+    {
+        uint8_t i;
+        const uint32_t active = pPicReg->VICIRQSTATUS;
+
+        for ( i=0; i<NR_VECTORS; ++i )
+        {
+            if ( isrAddr == __irqVect[i].isr &&
+                 __irqVect[i].irq >= 0 &&
+                 0 != HWREG_READ_SINGLE_BIT(active, __irqVect[i].irq) )
+            {
+                break;  /* out of for i */
+            }
+        }
+
+        (*isrAddr)();
+
+        if ( i < NR_VECTORS )
+        {
+            __accountIrq(__irqVect[i].irq);
+        }
+
+        pPicReg->VICVECTADDR = ULFF;
+        return;
+    }
+
     /* Execute the routine at the vector address */
     (*isrAddr)();
 
@@ -333,8 +562,16 @@ void pic_init(void)
             /* and clear its ISR address to a dummy function */
             pPicReg->VICVECTADDRn[i] = (uint32_t) &__irq_dummyISR;
         }
+
+        /* and remove its budget */
+        __irqBudget[i] = 0;
+        __budgetCount[i] = 0;
+        __throttleCount[i] = 0;
     }
 
+    __budgetMask = UL0;
+    __throttled = UL0;
+    __throttleHandler = NULL;
 }
 
 
@@ -502,19 +739,32 @@ void pic_setDefaultVectorAddr(pVectoredIsrPrototype addr)
  * The first 16 entries, sorted by priority, are automatically entered into appropriate vector
  * registers of the primary interrupt controller.
  *
+ * Optionally a rate budget may be assigned to the IRQ. At most 'budget' invocations
+ * of the ISR are serviced in the IRQ context within a budget window (see
+ * pic_newBudgetWindow()). When the budget is exhausted, the IRQ's line is disabled
+ * and its further servicing is handed over to pic_pollIrq() until a window, where
+ * the line does not exhaust its budget, is closed.
+ *
+ * Note that pic_pollIrq() executes the ISR of a budgeted IRQ in the context of
+ * the polling task. Such an ISR must not switch the context (e.g. by
+ * portYIELD_FROM_ISR()) while pic_isrPolled() returns 1, as the task's context
+ * has not been saved. The polling task should yield instead.
+ *
  * @note IRQ handling should be completely disabled prior to calling this function!
  *
  * @param irq - interrupt number (must be smaller than 32)
  * @param addr - address of the ISR that services the interrupt 'irq'
  * @param priority - priority of handling this IRQ (higher value means higher priority), the actual priority
  *                   will be silently truncated to 127 if this value is exceeded.
+ * @param budget - maximum number of ISR invocations per budget window, PIC_NO_BUDGET if unlimited
  *
  * @return position of the IRQ handling entry within an internal table, a negative value if registration was unsuccessful
  */
 int8_t pic_registerIrq(
                         uint8_t irq,
                         pVectoredIsrPrototype addr,
-                        uint8_t priority )
+                        uint8_t priority,
+                        uint16_t budget )
 {
     const uint8_t prior = priority & PIC_MAX_PRIORITY;
     int8_t irqPos = -1;
@@ -612,6 +862,19 @@ int8_t pic_registerIrq(
     __irqVect[prPos].isr = addr;
     __irqVect[prPos].priority = prior;
 
+    /* and (re)set the IRQ's budget */
+    __irqBudget[irq] = budget;
+    __budgetCount[irq] = 0;
+    HWREG_CLEAR_SINGLE_BIT(__throttled, irq);
+    if ( PIC_NO_BUDGET != budget )
+    {
+        HWREG_SET_SINGLE_BIT(__budgetMask, irq);
+    }
+    else
+    {
+        HWREG_CLEAR_SINGLE_BIT(__budgetMask, irq);
+    }
+
     /* if prPos<16 also update the appropriate vector registers */
     if ( prPos < NR_VECTORS )
     {
@@ -643,6 +906,11 @@ void pic_unregisterIrq(uint8_t irq)
         return;
     }
 
+    /* Remove the IRQ's budget */
+    HWREG_CLEAR_SINGLE_BIT(__budgetMask, irq);
+    HWREG_CLEAR_SINGLE_BIT(__throttled, irq);
+    __irqBudget[irq] = 0;
+
 
     /* Find the 'irq' in the priority table: */
     for ( pos=0; pos<NR_INTERRUPTS; ++pos )
@@ -713,6 +981,10 @@ void pic_unregisterAllIrqs(void)
             pPicReg->VICVECTADDRn[i] = (uint32_t) &__irq_dummyISR;
         }
     }
+
+    /* Remove budgets of all IRQs */
+    __budgetMask = UL0;
+    __throttled = UL0;
 }
 
 
@@ -743,6 +1015,11 @@ int8_t pic_setSwInterruptNr(uint8_t irq)
      * See description of the register on page 3-8 of DDI0181.
      */
 
+#if PIC_IRQ_STATS != 0
+    /* The trigger is timestamped, so the IRQ's entry latency will be measured */
+    pic_markTrigger(irq);
+#endif
+
     HWREG_SET_SINGLE_BIT( pPicReg->VICSOFTINT, irq );
 
     return irq;
@@ -819,3 +1096,249 @@ int8_t pic_clearSoftwareInterrupt(void)
 {
     return pic_clearSwInterruptNr(BSP_SOFTWARE_IRQ);
 }
+
+
+#if PIC_IRQ_STATS != 0
+
+/**
+ * Enables collection of IRQ statistics.
+ *
+ * All times are measured by a free running counter that counts down
+ * and wraps around at 0 to 0xFFFFFFFF. It must be started before calling
+ * this function. Statistics of all IRQs are cleared.
+ *
+ * Collection of statistics is disabled if 'counter' equals NULL.
+ *
+ * @param counter - address of the free running counter's value register (see timer_getValueAddr())
+ */
+void pic_enableStats(const volatile uint32_t* counter)
+{
+    const uint32_t cpsr = __irqSave();
+
+    __statsCounter = NULL;
+    pic_resetStats();
+    __statsCounter = counter;
+
+    __irqRestore(cpsr);
+}
+
+
+/**
+ * Timestamps a trigger of an IRQ. When the IRQ's ISR is executed next time,
+ * its entry latency will be measured relative to this moment.
+ *
+ * Software generated interrupts (see pic_setSwInterruptNr()) are timestamped
+ * automatically. Drivers may call this function when they know that an event
+ * will trigger the IRQ immediately.
+ *
+ * Nothing is done if 'irq' is invalid (equal or greater than 32) or
+ * statistics are disabled.
+ *
+ * @param irq - interrupt number (must be smaller than 32)
+ */
+void pic_markTrigger(uint8_t irq)
+{
+    uint32_t cpsr;
+
+    if ( irq < NR_INTERRUPTS && NULL != __statsCounter )
+    {
+        cpsr = __irqSave();
+        __triggerTime[irq] = __statsTimestamp();
+        HWREG_SET_SINGLE_BIT(__triggerPending, irq);
+        __irqRestore(cpsr);
+    }
+}
+
+
+/**
+ * Copies statistics of the requested IRQ.
+ *
+ * Nothing is done and -1 is returned if 'irq' is invalid
+ * (equal or greater than 32) or 'stats' equals NULL.
+ *
+ * @param irq - interrupt number (must be smaller than 32)
+ * @param stats - address where the statistics will be copied to
+ *
+ * @return 'irq' if statistics were successfully copied, a negative value (typically -1) otherwise
+ */
+int8_t pic_getIrqStats(uint8_t irq, picIrqStats* stats)
+{
+    uint32_t cpsr;
+
+    if ( irq >= NR_INTERRUPTS || NULL == stats )
+    {
+        return -1;
+    }
+
+    /* ISRs must not modify statistics while they are copied */
+    cpsr = __irqSave();
+    *stats = __irqStats[irq];
+    __irqRestore(cpsr);
+
+    return irq;
+}
+
+
+/**
+ * Clears statistics of all IRQs.
+ */
+void pic_resetStats(void)
+{
+    const uint32_t cpsr = __irqSave();
+    uint8_t i;
+
+    for ( i=0; i<NR_INTERRUPTS; ++i )
+    {
+        __irqStats[i].count = UL0;
+        __irqStats[i].totalTime = UL0;
+        __irqStats[i].maxTime = UL0;
+        __irqStats[i].latencyCount = UL0;
+        __irqStats[i].totalLatency = UL0;
+        __irqStats[i].maxLatency = UL0;
+    }
+
+    __triggerPending = UL0;
+
+    __irqRestore(cpsr);
+}
+
+#endif  /* PIC_IRQ_STATS != 0 */
+
+
+/**
+ * Sets a handler that is called whenever an IRQ exhausts its budget and
+ * its line is disabled. The handler is called from the IRQ context,
+ * typically it wakes up a task that services throttled IRQs by pic_pollIrq().
+ *
+ * @param handler - address of the handler, NULL to remove the handler
+ */
+void pic_setThrottleHandler(pPicThrottleHandler handler)
+{
+    __throttleHandler = handler;
+}
+
+
+/**
+ * Closes the current budget window of all budgeted IRQs and opens a new one.
+ * It is supposed to be called periodically, typically on each tick.
+ *
+ * Throttled IRQs that have not exhausted their budgets (by polling)
+ * during the closed window are reenabled.
+ *
+ * @note The function must be called from the IRQ context or with IRQs disabled.
+ */
+void pic_newBudgetWindow(void)
+{
+    uint32_t mask = __budgetMask;
+    uint8_t irq;
+
+    while ( UL0 != mask )
+    {
+        irq = (uint8_t) __builtin_ctz(mask);
+        HWREG_CLEAR_SINGLE_BIT(mask, irq);
+
+        if ( 0 != HWREG_READ_SINGLE_BIT(__throttled, irq) &&
+             __budgetCount[irq] < __irqBudget[irq] )
+        {
+            /* The rate has dropped, service the IRQ in the IRQ context again */
+            HWREG_CLEAR_SINGLE_BIT(__throttled, irq);
+            HWREG_SET_SINGLE_BIT(pPicReg->VICINTENABLE, irq);
+        }
+
+        __budgetCount[irq] = 0;
+    }
+}
+
+
+/**
+ * Services a throttled IRQ by polling. If the IRQ is pending, its ISR is
+ * executed (with IRQs disabled) and charged against the IRQ's budget.
+ *
+ * The ISR is executed in the context of the calling task, so it must not switch
+ * the context (see pic_isrPolled()). If the ISR wakes up a task, the caller
+ * should yield afterwards.
+ *
+ * Nothing is done and -1 is returned if 'irq' is invalid (equal or greater than 32),
+ * not throttled or its budget for the current window is already exhausted.
+ *
+ * @param irq - interrupt number (must be smaller than 32)
+ *
+ * @return 1 if the ISR was executed, 0 if the IRQ is not pending, -1 otherwise
+ */
+int8_t pic_pollIrq(uint8_t irq)
+{
+    uint8_t i;
+    int8_t retVal = -1;
+    uint32_t cpsr;
+
+    if ( irq>=NR_INTERRUPTS )
+    {
+        return -1;
+    }
+
+    cpsr = __irqSave();
+
+    if ( 0 != HWREG_READ_SINGLE_BIT(__throttled, irq) &&
+         __budgetCount[irq] < __irqBudget[irq] )
+    {
+        retVal = 0;
+
+        /* See description of VICRAWINTR, page 3-6 of DDI0181 */
+        if ( 0 != HWREG_READ_SINGLE_BIT(pPicReg->VICRAWINTR, irq) )
+        {
+            for ( i=0; i<NR_INTERRUPTS; ++i )
+            {
+                if ( __irqVect[i].irq == irq )
+                {
+                    __isrPolled = 1;
+                    ( *__irqVect[i].isr )();
+                    __isrPolled = 0;
+                    __budgetCharge(irq);
+                    retVal = 1;
+                    break;  /* out of for i */
+                }
+            }
+        }
+    }
+
+    __irqRestore(cpsr);
+
+    return retVal;
+}
+
+
+/**
+ * May be called by an ISR of a budgeted IRQ to check whether it is executed
+ * by pic_pollIrq(), i.e. in the context of a task, and must not switch the context.
+ *
+ * @return 1 if an ISR is being executed by pic_pollIrq(), 0 otherwise
+ */
+int8_t pic_isrPolled(void)
+{
+    return __isrPolled;
+}
+
+
+/**
+ * @return bitmask of all currently throttled IRQs
+ */
+uint32_t pic_getThrottledIrqs(void)
+{
+    return __throttled;
+}
+
+
+/**
+ * Returns how many times the IRQ's line has been disabled because of
+ * an exhausted budget.
+ *
+ * 0 is returned if 'irq' is invalid, i.e. equal or greater than 32.
+ *
+ * @param irq - interrupt number (must be smaller than 32)
+ *
+ * @return number of throttling events of 'irq'
+ */
+uint32_t pic_getThrottleCount(uint8_t irq)
+{
+    return ( irq<NR_INTERRUPTS ? __throttleCount[irq] : 0 );
+}
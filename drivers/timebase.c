@@ -0,0 +1,249 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file
+ *
+ * Implementation of a time base with a microsecond resolution.
+ *
+ * The time base is built on a free running counter of a SP804 timer.
+ * The counter counts down, so its complement is used as an increasing
+ * 32-bit count. Its wraparounds are counted in software, extending
+ * the count to 64 bits. As a wraparound can only be detected when the
+ * counter is read, it must be read (e.g. by timebase_update()) at least
+ * once per its period, i.e. approximately every 71 minutes.
+ *
+ * The timers' reference clock runs at 1 MHz, so one count equals one
+ * microsecond and no (64-bit) divisions are necessary.
+ *
+ * More info about the timer controller:
+ * - ARM Dual-Timer Module (SP804) Technical Reference Manual (DDI0271):
+ *   http://infocenter.arm.com/help/topic/com.arm.doc.ddi0271d/DDI0271.pdf
+ *
+ * @author Jernej Kovacic
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "bsp.h"
+#include "timer.h"
+
+/* For public definitions of types: */
+#include "timebase.h"
+
+
+#if BSP_TIMER_CLOCK_HZ != 1000000
+#error The time base assumes that one count of the timer equals one microsecond!
+#endif
+
+
+/* Number of calls of delay_us(0) that determine the overhead of delay_us() */
+#define NR_CALIBRATION_CALLS     ( 8 )
+#define LOG2_CALIBRATION_CALLS   ( 3 )
+
+
+/* Value Register of the free running counter, NULL until the time base is initialized */
+static const volatile uint32_t* __counter = NULL;
+
+static uint8_t __timerNr;
+static uint8_t __counterNr;
+
+/* Upper 32 bits of the extended count and the count at the most recent read */
+static uint32_t __high = 0;
+static uint32_t __lastLow = 0;
+
+/* Overhead (in microseconds) of a call of delay_us() */
+static uint32_t __delayOverhead = 0;
+
+
+/*
+ * Disables IRQ and FIQ exceptions and returns the previous CPSR.
+ */
+static inline uint32_t __irqSave(void)
+{
+    uint32_t cpsr;
+    uint32_t tmp;
+
+    __asm volatile(
+        "MRS %0, cpsr         \n\t"   /* Read in the CPSR register. */
+        "ORR %1, %0, #0xC0    \n\t"   /* Disable IRQ and FIQ exceptions. */
+        "MSR cpsr_c, %1           "   /* Write it back to the CPSR register. */
+        : "=&r" (cpsr), "=r" (tmp) : : "memory" );
+
+    return cpsr;
+}
+
+
+/*
+ * Restores the CPSR's control bits, returned by __irqSave().
+ */
+static inline void __irqRestore(uint32_t cpsr)
+{
+    __asm volatile( "MSR cpsr_c, %0" : : "r" (cpsr) : "memory" );
+}
+
+
+/**
+ * Initializes the time base on the specified timer's counter.
+ * The counter is started unless it is already running. In that case
+ * its settings are not modified, so the counter may be shared with other
+ * components that require a free running counter with a maximum load.
+ *
+ * Nothing is done and -1 is returned if either 'timerNr' or 'counterNr' is
+ * invalid or the time base has already been initialized on another counter.
+ *
+ * @note Interrupt triggering of the counter must remain disabled.
+ *
+ * @param timerNr - timer number (between 0 and 1)
+ * @param counterNr - counter number of the selected timer (between 0 and 1)
+ *
+ * @return 0 on success, a negative value (typically -1) otherwise
+ */
+int8_t timebase_init(uint8_t timerNr, uint8_t counterNr)
+{
+    uint32_t start;
+    uint8_t i;
+
+    /* sanity check: */
+    if ( timerNr >= BSP_NR_TIMERS || counterNr >= timer_countersPerTimer() )
+    {
+        return -1;
+    }
+
+    /* Already initialized? */
+    if ( NULL != __counter )
+    {
+        return ( timerNr==__timerNr && counterNr==__counterNr ? 0 : -1 );
+    }
+
+    if ( 0 == timer_isEnabled(timerNr, counterNr) )
+    {
+        timer_init(timerNr, counterNr);
+        timer_setLoad(timerNr, counterNr, (uint32_t) -1);
+        timer_start(timerNr, counterNr);
+    }
+
+    __timerNr = timerNr;
+    __counterNr = counterNr;
+    __counter = timer_getValueAddr(timerNr, counterNr);
+    __high = 0;
+    __lastLow = ~(*__counter);
+
+    /* Calibrate delay_us(): */
+    __delayOverhead = 0;
+    start = timebase_getCounter();
+    for ( i=0; i<NR_CALIBRATION_CALLS; ++i )
+    {
+        delay_us(0);
+    }
+    __delayOverhead = ( timebase_getCounter() - start ) >> LOG2_CALIBRATION_CALLS;
+
+    return 0;
+}
+
+
+/**
+ * Returns the current 32-bit count of the free running counter, i.e. the raw
+ * increasing count that wraps around approximately every 71 minutes.
+ * It is suitable for measurements of short intervals as differences of
+ * two counts (which are correct across a wraparound).
+ *
+ * Zero is returned if the time base has not been initialized yet.
+ *
+ * @return current 32-bit count, one count per microsecond
+ */
+uint32_t timebase_getCounter(void)
+{
+    return ( NULL != __counter ? ~(*__counter) : 0 );
+}
+
+
+/**
+ * Returns the number of microseconds since the time base was started,
+ * extended to 64 bits. The function may be called from any context.
+ *
+ * Zero is returned if the time base has not been initialized yet.
+ *
+ * @return current 64-bit timestamp in microseconds
+ */
+uint64_t timestamp_us(void)
+{
+    uint32_t cpsr;
+    uint32_t low;
+    uint32_t high;
+
+    if ( NULL == __counter )
+    {
+        return 0;
+    }
+
+    /* The count and the wraparound counter must be updated atomically */
+    cpsr = __irqSave();
+
+    low = ~(*__counter);
+    if ( low < __lastLow )
+    {
+        ++__high;
+    }
+    __lastLow = low;
+    high = __high;
+
+    __irqRestore(cpsr);
+
+    return ( ( (uint64_t) high ) << 32 ) | low;
+}
+
+
+/**
+ * Reads the time base, so its wraparounds are detected. It must be called
+ * at least once per period of the counter (approximately every 71 minutes),
+ * typically it is called on each tick.
+ */
+void timebase_update(void)
+{
+    ( void ) timestamp_us();
+}
+
+
+/**
+ * Busy waits for (at least) the specified number of microseconds.
+ * The overhead of the function's call, determined when the time base is
+ * initialized, is taken into account.
+ *
+ * The function returns immediately if the time base has not been initialized yet.
+ *
+ * @param us - number of microseconds to wait
+ */
+void delay_us(uint32_t us)
+{
+    const uint32_t start = timebase_getCounter();
+    const uint32_t target = ( us > __delayOverhead ? us - __delayOverhead : 0 );
+
+    if ( NULL == __counter )
+    {
+        return;
+    }
+
+    /* The difference is correct even if the counter wraps around */
+    while ( ( timebase_getCounter() - start ) < target );
+}
@@ -178,6 +178,37 @@ void timer_init(uint8_t timerNr, uint8_t counterNr)
 }
 
 
+/**
+ * Selects the specified counter's one shot mode. In one shot mode, the counter
+ * halts when it reaches 0, otherwise it is reloaded (see timer_init()).
+ *
+ * Nothing is done if either 'timerNr' or 'counterNr' is invalid.
+ *
+ * @param timerNr - timer number (between 0 and 1)
+ * @param counterNr - counter number of the selected timer (between 0 and 1)
+ * @param oneShot - if 0, the counter is wrapping, otherwise it runs in one shot mode
+ */
+void timer_setOneShot(uint8_t timerNr, uint8_t counterNr, int8_t oneShot)
+{
+
+    /* sanity check: */
+    if ( timerNr >= BSP_NR_TIMERS || counterNr >= NR_COUNTERS )
+    {
+        return;
+    }
+
+    /* Set bit 0 of the Control Register, do not modify other bits */
+    if ( 0 != oneShot )
+    {
+        HWREG_SET_BITS( pReg[timerNr]->CNTR[counterNr].CONTROL, CTL_ONESHOT );
+    }
+    else
+    {
+        HWREG_CLEAR_BITS( pReg[timerNr]->CNTR[counterNr].CONTROL, CTL_ONESHOT );
+    }
+}
+
+
 /**
  * Starts the specified timer's counter.
  *
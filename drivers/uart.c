@@ -589,3 +589,25 @@ char uart_readChar(uint8_t nr)
 
     return *( (char*) &(pReg[nr]->UARTDR) );
 }
+
+
+/**
+ * Checks whether the specified UART has received a character
+ * that has not been read yet.
+ *
+ * Zero is returned if 'nr' is invalid (equal or greater than 3).
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ *
+ * @return 1 if a character can be read by uart_readChar() without waiting, 0 otherwise
+ */
+int8_t uart_rxReady(uint8_t nr)
+{
+    /* Sanity check */
+    if ( nr >= BSP_NR_UARTS )
+    {
+        return 0;
+    }
+
+    return ( 0 == HWREG_READ_BITS( pReg[nr]->UARTFR, FR_RXFE ) ? 1 : 0 );
+}
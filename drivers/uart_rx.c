@@ -0,0 +1,325 @@
+/*
+ * Copyright 2020, Jernej Kovacic
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software. If you wish to use our Amazon
+ * FreeRTOS name, please do so in a fair use way that does not cause confusion.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file
+ *
+ * Implementation of the UART receive driver.
+ *
+ * The ISR drains all received characters directly into a stream buffer's
+ * write window and commits them at once, so the kernel is entered once per
+ * interrupt rather than once per character. The reader is only woken up when
+ * the stream buffer's trigger level is reached or a line terminator is
+ * received, and it obtains a whole line or block of characters per call.
+ *
+ * The stream buffer is provided by the caller, typically created statically
+ * with a trigger level, appropriate for the channel.
+ *
+ * @author Jernej Kovacic
+ */
+
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <stream_buffer.h>
+
+#include "bsp.h"
+#include "uart.h"
+#include "interrupt.h"
+#include "uart_rx.h"
+
+
+#if BSP_NR_UARTS != 3
+#error Update __rxIsrs to the number of UARTs
+#endif
+
+
+/* Receive state of a UART */
+typedef struct _UartRxState
+{
+    StreamBufferHandle_t buffer;    /* received characters, NULL if not initialized */
+    char terminator;                /* character that terminates a line */
+    volatile uint32_t overruns;     /* characters dropped because the buffer was full */
+} UartRxState;
+
+static UartRxState __rx[BSP_NR_UARTS];
+
+
+/*
+ * Moves all characters, received by the UART 'nr', into its stream buffer.
+ * Characters that do not fit are dropped and counted.
+ *
+ * Note that the function may also be executed by the IRQ guard's task
+ * (see pic_pollIrq()). Then it must not switch the context, the reader
+ * is switched to when the guard's task blocks.
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ */
+static void __serviceRx(uint8_t nr)
+{
+    UartRxState* const rx = &__rx[nr];
+    StreamBufferWindow_t win;
+    size_t space;
+    size_t n = 0;
+    BaseType_t eol = pdFALSE;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    char ch;
+
+    /* Without blocking, the write window may be obtained in the IRQ context */
+    space = xStreamBufferGetWriteWindow(rx->buffer, &win, 1, 0);
+
+    while ( 0 != uart_rxReady(nr) )
+    {
+        ch = uart_readChar(nr);
+
+        if ( n < space )
+        {
+            if ( n < win.xLength[0] )
+            {
+                win.pucData[0][n] = (uint8_t) ch;
+            }
+            else
+            {
+                win.pucData[1][n - win.xLength[0]] = (uint8_t) ch;
+            }
+
+            ++n;
+            eol |= ( ch == rx->terminator );
+        }
+        else
+        {
+            ++rx->overruns;
+        }
+    }
+
+    if ( n > 0 )
+    {
+        xStreamBufferCommitFromISR(rx->buffer, n, &higherPriorityTaskWoken);
+    }
+
+    /* A complete line is passed to the reader even below the trigger level */
+    if ( pdFALSE != eol )
+    {
+        xStreamBufferSendCompletedFromISR(rx->buffer, &higherPriorityTaskWoken);
+    }
+
+    uart_clearRxInterrupt(nr);
+
+    /* The whole context is only saved on IRQ entry, not when polled */
+    if ( pdFALSE != higherPriorityTaskWoken && 0 == pic_isrPolled() )
+    {
+        portYIELD_FROM_ISR();
+    }
+}
+
+
+/* ISR handlers of individual UARTs: */
+
+static void __rxIsr0(void)
+{
+    __serviceRx(0);
+}
+
+static void __rxIsr1(void)
+{
+    __serviceRx(1);
+}
+
+static void __rxIsr2(void)
+{
+    __serviceRx(2);
+}
+
+static const pVectoredIsrPrototype __rxIsrs[BSP_NR_UARTS] = { &__rxIsr0, &__rxIsr1, &__rxIsr2 };
+
+
+/**
+ * Initializes receiving by the specified UART. Received characters
+ * will be passed to 'buffer'. Its trigger level determines how many
+ * characters are accumulated before a blocked reader is woken up,
+ * unless 'terminator' is received earlier.
+ *
+ * The UART's IRQ is registered at the PIC driver and enabled.
+ *
+ * Nothing is done and -1 is returned if 'nr' is invalid (equal or
+ * greater than 3), 'buffer' is NULL or the IRQ could not be registered.
+ *
+ * @note The stream buffer must have a single reader and no other writers.
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ * @param buffer - stream buffer for received characters
+ * @param terminator - character that terminates a line, e.g. '\r'
+ * @param irqPriority - priority of the UART's IRQ (see pic_registerIrq())
+ * @param irqBudget - maximum number of the UART's IRQs per budget window
+ *
+ * @return 0 on success, a negative value (typically -1) otherwise
+ */
+int8_t uartrx_init(
+                    uint8_t nr,
+                    StreamBufferHandle_t buffer,
+                    char terminator,
+                    uint8_t irqPriority,
+                    uint16_t irqBudget )
+{
+    const uint8_t uartIrqs[BSP_NR_UARTS] = BSP_UART_IRQS;
+
+    /* Sanity check */
+    if ( nr >= BSP_NR_UARTS || NULL == buffer )
+    {
+        return -1;
+    }
+
+    __rx[nr].buffer = buffer;
+    __rx[nr].terminator = terminator;
+    __rx[nr].overruns = 0;
+
+    if ( pic_registerIrq(uartIrqs[nr], __rxIsrs[nr], irqPriority, irqBudget) < 0 )
+    {
+        __rx[nr].buffer = NULL;
+        return -1;
+    }
+
+    pic_enableInterrupt(uartIrqs[nr]);
+
+    /* Configure the UART to receive data and trigger interrupts on receive */
+    uart_enableRx(nr);
+    uart_enableRxInterrupt(nr);
+
+    return 0;
+}
+
+
+/**
+ * Reads a block of received characters. The calling task is blocked
+ * until at least the trigger level of characters has been received
+ * (or a line terminator), or 'ticksToWait' expires.
+ *
+ * Zero is returned immediately if 'nr' is invalid or not initialized.
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ * @param buf - buffer to copy the characters to
+ * @param size - size of 'buf' in bytes
+ * @param ticksToWait - maximum number of ticks to wait for characters
+ *
+ * @return number of characters copied to 'buf'
+ */
+size_t uartrx_read(uint8_t nr, void* buf, size_t size, TickType_t ticksToWait)
+{
+    if ( nr >= BSP_NR_UARTS || NULL == __rx[nr].buffer )
+    {
+        return 0;
+    }
+
+    return xStreamBufferReceive(__rx[nr].buffer, buf, size, ticksToWait);
+}
+
+
+/**
+ * Reads a line of received characters, including its terminator. The
+ * calling task is blocked until the terminator is received, 'buf' is full
+ * or 'ticksToWait' expires. In the latter two cases, the rest of the
+ * line is returned by the following call(s).
+ *
+ * The line is not terminated by '\0'. A complete line can be recognized
+ * by its last character that equals the terminator.
+ *
+ * Zero is returned immediately if 'nr' is invalid or not initialized.
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ * @param buf - buffer to copy the line to
+ * @param size - size of 'buf' in characters
+ * @param ticksToWait - maximum number of ticks to wait for the terminator
+ *
+ * @return number of characters copied to 'buf'
+ */
+size_t uartrx_readLine(uint8_t nr, char* buf, size_t size, TickType_t ticksToWait)
+{
+    StreamBufferWindow_t win;
+    TimeOut_t timeOut;
+    size_t len = 0;
+    size_t i;
+    size_t n;
+    uint8_t r;
+    char term;
+
+    if ( nr >= BSP_NR_UARTS || NULL == __rx[nr].buffer )
+    {
+        return 0;
+    }
+
+    term = __rx[nr].terminator;
+    vTaskSetTimeOutState(&timeOut);
+
+    for ( ; ; )
+    {
+        /* Characters are scanned in place, only the line itself is copied */
+        xStreamBufferGetReadWindow(__rx[nr].buffer, &win, ticksToWait);
+
+        n = 0;
+        for ( r=0; r<2 && len<size; ++r )
+        {
+            for ( i=0; i<win.xLength[r] && len<size; ++i )
+            {
+                buf[len] = (char) win.pucData[r][i];
+                ++n;
+
+                if ( term == buf[len++] )
+                {
+                    xStreamBufferConsume(__rx[nr].buffer, n);
+                    return len;
+                }
+            }
+        }
+
+        /* The line is incomplete, all scanned characters have been copied */
+        if ( n > 0 )
+        {
+            xStreamBufferConsume(__rx[nr].buffer, n);
+        }
+
+        if ( len >= size || pdFALSE != xTaskCheckForTimeOut(&timeOut, &ticksToWait) )
+        {
+            return len;
+        }
+    }
+}
+
+
+/**
+ * Returns the number of received characters, dropped by the specified
+ * UART because its stream buffer was full.
+ *
+ * Zero is returned if 'nr' is invalid (equal or greater than 3).
+ *
+ * @param nr - number of the UART (between 0 and 2)
+ *
+ * @return number of dropped characters
+ */
+uint32_t uartrx_getOverruns(uint8_t nr)
+{
+    return ( nr < BSP_NR_UARTS ? __rx[nr].overruns : 0 );
+}
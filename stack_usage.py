@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+#
+# Usage: stack_usage.py [-o objdump] [-c caller=callee[,callee...]]... elf_image su_dir entry[+bytes]...
+#
+# Estimates the worst case stack depth of each given entry point (e.g. a task's
+# function or an exception handler) from the static analysis of the ELF image.
+#
+# Frame sizes of all functions are read from the *.su files in su_dir, produced
+# by GCC when sources are compiled with the '-fstack-usage' flag. The call graph
+# is obtained by disassembling the image with objdump ('arm-none-eabi-objdump'
+# by default). The worst case depth of a function is its own frame plus the
+# deepest depth among all functions it calls.
+#
+# Calls via function pointers (e.g. ISRs, called by the PIC driver) cannot be
+# resolved from the disassembly. Known targets of such calls may be added to
+# the call graph by '-c caller=callee,...'. Functions with unresolved indirect
+# calls, unknown frame sizes (e.g. implemented in assembler) and recursion are
+# reported, as the estimate may be too low for such entry points.
+#
+# An optional number of bytes may be appended to each entry point, e.g.
+# 'vTaskFunction+72', that is added to its depth. This is typically the
+# size of a task's context, saved on its stack by the kernel.
+#
+# 'make stack_usage' rebuilds the image with '-fstack-usage' and runs this
+# script for all tasks and exception handlers of the demo application.
+
+import argparse
+import glob
+import os
+import re
+import subprocess
+import sys
+
+
+# A function's header in objdump's output, e.g. "00010480 <main>:"
+FUNC_RE = re.compile(r'^([0-9a-f]+) <([^>]+)>:$')
+
+# Direct calls and branches (incl. conditional ones) to a symbol, e.g. "bl 10480 <main>"
+CALL_RE = re.compile(r'^(bl|b)(eq|ne|cs|cc|hs|lo|mi|pl|vs|vc|hi|ls|ge|lt|gt|le|al)?$')
+TARGET_RE = re.compile(r'<([^>+]+)(\+0x[0-9a-f]+)?>')
+
+# Indirect calls, e.g. "blx r3"
+INDIRECT_RE = re.compile(r'^blx(eq|ne|cs|cc|hs|lo|mi|pl|vs|vc|hi|ls|ge|lt|gt|le|al)?$')
+
+
+def read_frames(su_dir):
+    """Returns a dictionary of frame sizes in bytes, read from all *.su files."""
+    frames = {}
+    for path in glob.glob(os.path.join(su_dir, '*.su')):
+        with open(path) as f:
+            for line in f:
+                fields = line.rstrip('\n').split('\t')
+                if len(fields) < 2:
+                    continue
+                name = fields[0].split(':')[-1]
+                # Static functions of different files may share a name
+                frames[name] = max(frames.get(name, 0), int(fields[1]))
+    return frames
+
+
+def read_call_graph(objdump, elf):
+    """Returns the call graph and the set of functions with indirect calls."""
+    out = subprocess.run([objdump, '-d', elf], stdout=subprocess.PIPE,
+                         universal_newlines=True, check=True).stdout
+    graph = {}
+    indirect = set()
+    func = None
+    for line in out.splitlines():
+        m = FUNC_RE.match(line)
+        if m:
+            func = m.group(2)
+            graph.setdefault(func, set())
+            continue
+        fields = line.split('\t')
+        if func is None or len(fields) < 3:
+            continue
+        mnemonic = fields[2].strip()
+        operands = fields[3] if len(fields) > 3 else ''
+        if INDIRECT_RE.match(mnemonic):
+            indirect.add(func)
+        elif CALL_RE.match(mnemonic):
+            t = TARGET_RE.search(operands)
+            # Branches within a function are not calls, but recursive calls are
+            if t and t.group(2) is None and (t.group(1) != func or mnemonic.startswith('bl')):
+                graph[func].add(t.group(1))
+    return graph, indirect
+
+
+def worst_case(func, graph, frames, memo, path, recursive):
+    """Returns the worst case depth of 'func' and the deepest call chain."""
+    if func in memo:
+        return memo[func]
+    if func in path:
+        recursive.add(func)
+        return (0, [])
+    path.add(func)
+    deepest = (0, [])
+    for callee in sorted(graph.get(func, ())):
+        d = worst_case(callee, graph, frames, memo, path, recursive)
+        if d[0] > deepest[0]:
+            deepest = d
+    path.remove(func)
+    result = (frames.get(func, 0) + deepest[0], [func] + deepest[1])
+    memo[func] = result
+    return result
+
+
+def reachable(func, graph):
+    """Returns the set of all functions reachable from 'func' (incl. itself)."""
+    reached = set()
+    stack = [func]
+    while stack:
+        f = stack.pop()
+        if f not in reached:
+            reached.add(f)
+            stack.extend(graph.get(f, ()))
+    return reached
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Worst case stack depth per entry point')
+    parser.add_argument('-o', '--objdump', default='arm-none-eabi-objdump')
+    parser.add_argument('-c', '--call', action='append', default=[],
+                        help='known targets of indirect calls: caller=callee[,callee...]')
+    parser.add_argument('elf')
+    parser.add_argument('su_dir')
+    parser.add_argument('entries', nargs='+')
+    args = parser.parse_args()
+
+    frames = read_frames(args.su_dir)
+    if not frames:
+        sys.exit('No *.su files found in %s, compile with -fstack-usage' % args.su_dir)
+
+    graph, indirect = read_call_graph(args.objdump, args.elf)
+    for c in args.call:
+        caller, callees = c.split('=', 1)
+        # Functions that are not linked into the image are ignored
+        graph.setdefault(caller, set()).update(f for f in callees.split(',') if f in graph)
+        indirect.discard(caller)
+
+    memo = {}
+    recursive = set()
+    print('Entry point: worst case stack depth [bytes (words)], deepest call chain')
+    for entry in args.entries:
+        name, _, extra = entry.partition('+')
+        if name not in graph:
+            print('%s: not found in %s' % (name, args.elf))
+            continue
+        depth, chain = worst_case(name, graph, frames, memo, set(), recursive)
+        depth += int(extra or 0)
+        print('%s: %d (%d)' % (name, depth, (depth + 3) // 4))
+        print('  ' + ' > '.join(chain))
+        reached = reachable(name, graph)
+        for title, funcs in (('indirect calls in', reached & indirect),
+                             ('unknown frames of', reached - set(frames)),
+                             ('recursion via', reached & recursive)):
+            if funcs:
+                print('  %s: %s' % (title, ', '.join(sorted(funcs))))
+
+
+if __name__ == '__main__':
+    main()